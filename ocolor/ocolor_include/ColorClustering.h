@@ -0,0 +1,153 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include "Parallel.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Space in which colors are clustered.
+ */
+enum ClusterSpace { CLUSTER_RGB, CLUSTER_LAB, CLUSTER_OKLAB };
+
+/**
+ * One cluster centre and the share of the input it represents.
+ */
+struct ColorCluster {
+	OColor color;
+	float weight;	// 0..1, all weights add up to 1
+};
+
+/**
+ * Parameters of KMeans. The defaults give 8 OKLab clusters.
+ */
+struct KMeansOptions {
+	int k;
+	ClusterSpace space;
+	int maxIterations;
+
+	/**
+	 * Stop when no centre moves further than this, in units of the space.
+	 * 0 picks 1/1000 of the space's lightness range.
+	 */
+	float tolerance;
+
+	unsigned threads;	// 0 for one per core
+	unsigned seed;		// seed of the k-means++ sampling
+
+	KMeansOptions();
+};
+
+/**
+ * Weighted k-means with k-means++ seeding.
+ * 
+ * dominantColors() first reduces the image to a histogram of 32768 RGB
+ * cells (5 bits per channel, each cell keeping the mean of its pixels), so
+ * clustering cost depends on the number of distinct colors, not on the
+ * image size. The histogram is built in parallel with one partial per
+ * thread.
+ * 
+ * Assignment processes points in blocks: for each centre a branch free
+ * loop updates the best distance and label of every point in the block,
+ * which the compiler vectorizes. Centre sums are accumulated per chunk and
+ * merged after each pass.
+ * 
+ * <pre>
+ * KMeansOptions options;
+ * options.k = 6;
+ * vector<ColorCluster> palette = KMeans::dominantColors<BGRA8>(pixels, width * height, options);
+ * </pre>
+ */
+class KMeans {
+public:
+	static const int HISTOGRAM_BITS = 5;
+	static const int HISTOGRAM_SIZE = 1 << (3 * HISTOGRAM_BITS);
+
+	static vector<ColorCluster> cluster(const float* rgb, const float* weights, size_t count, const KMeansOptions& options);
+	static void seed(const float* x, const float* y, const float* z, const float* w, size_t n, int k, unsigned seed, float* centres);
+	static int iterate(const float* x, const float* y, const float* z, const float* w, size_t n, int k, float* centres, double* weights, const KMeansOptions& options);
+	static void toSpace(ClusterSpace space, const float* rgb, float* point);
+	static OColor fromSpace(ClusterSpace space, const float* point);
+
+	/**
+	 * Finds the dominant colors of an image.
+	 * 
+	 * @param pixels
+	 *            interleaved pixels of the given PixelFormat
+	 * @param count
+	 *            number of pixels
+	 * @param options
+	 * @return clusters sorted by descending weight; fewer than k if the
+	 *         image has fewer distinct colors
+	 */
+	template<typename Fmt>
+	static vector<ColorCluster> dominantColors(const typename Fmt::Scalar* pixels, size_t count, const KMeansOptions& options)
+	{
+		static_assert(!Fmt::PLANAR, "KMeans needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		const int shift = 8 - HISTOGRAM_BITS;
+		size_t chunk = count / Parallel::getThreadCount(options.threads) + 1;
+		vector<vector<double> > partials((count + chunk - 1) / chunk);
+
+		// per cell: pixel count and channel sums
+		Parallel::forChunks(count, chunk, options.threads, [&](size_t begin, size_t end) {
+			vector<double>& cells = partials[begin / chunk];
+			cells.assign(HISTOGRAM_SIZE * 4, 0);
+			for (size_t i = begin; i < end; i++) {
+				const S* p = pixels + i * Fmt::CHANNELS;
+				float r = ChannelTraits<S>::toFloat(p[Fmt::RED]);
+				float g = ChannelTraits<S>::toFloat(p[Fmt::GREEN]);
+				float b = ChannelTraits<S>::toFloat(p[Fmt::BLUE]);
+				int cell = (quantize(r) >> shift << (2 * HISTOGRAM_BITS)) | (quantize(g) >> shift << HISTOGRAM_BITS) | (quantize(b) >> shift);
+				double* c = &cells[cell * 4];
+				c[0] += 1;
+				c[1] += r;
+				c[2] += g;
+				c[3] += b;
+			}
+		});
+		return clusterHistogram(partials, options);
+	}
+
+private:
+	static int quantize(float v) {
+		int q = (int) (v * 255 + 0.5f);
+		return q < 0 ? 0 : (q > 255 ? 255 : q);
+	}
+
+	static vector<ColorCluster> clusterHistogram(vector<vector<double> >& partials, const KMeansOptions& options);
+};
\ No newline at end of file
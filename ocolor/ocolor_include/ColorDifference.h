@@ -0,0 +1,61 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * CIE color difference formulas on Lab triplets (L 0..100, as produced by
+ * OColor::rgbToLab() or XYZ::toLab()).
+ * 
+ * The single pair functions use the exact formulas. The batch functions
+ * hoist all terms of the reference color out of the loop and evaluate
+ * CIEDE2000 with the polynomial MathUtils::fastAtan2()/fastCos(), which
+ * keeps the inner loop free of library calls except exp(); the results
+ * differ from the exact formula by less than 1E-3.
+ * 
+ * CIE94 uses the graphic arts weights and is not symmetric: the first color
+ * is the reference.
+ */
+class DeltaE {
+public:
+	static float cie76(const float* lab1, const float* lab2);
+	static float cie94(const float* lab1, const float* lab2);
+	static float ciede2000(const float* lab1, const float* lab2);
+	static float distance(DeltaEMetric metric, const float* lab1, const float* lab2);
+	static bool isWithin(DeltaEMetric metric, const float* lab1, const float* lab2, float threshold);
+	static void oneToMany(DeltaEMetric metric, const float* ref, const float* lab, float* dist, size_t count);
+	static void manyToMany(DeltaEMetric metric, const float* lab1, size_t count1, const float* lab2, size_t count2, float* dist);
+};
\ No newline at end of file
@@ -0,0 +1,98 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * The per color metrics of OColor that batch distance kernels support.
+ */
+enum DistanceMetric {
+	DISTANCE_RGB,	// OColor::distanceToRGB()
+	DISTANCE_HSV,	// OColor::distanceToHSV()
+	DISTANCE_CMYK	// OColor::distanceToCMYK()
+};
+
+/**
+ * A palette stored as structure of arrays, ready for distance kernels.
+ * Every supported metric is a Euclidean distance once each color is mapped
+ * to its point: r,g,b for RGB, the HSV cone point (cos(h) * s, sin(h) * s, v)
+ * for HSV and c,m,y,k for CMYK. The mapping, including the HSV sin/cos, is
+ * done once in add().
+ */
+class ColorSet {
+public:
+	ColorSet(DistanceMetric metric);
+	void add(const OColor& color);
+	void add(const vector<OColor>& colors);
+	void clear();
+	void reserve(size_t count);
+	DistanceMetric getMetric() const;
+	int getDimensions() const;
+	size_t size() const;
+	const float* getChannel(int i) const;
+	void toPoint(const OColor& color, float* point) const;
+
+private:
+	DistanceMetric metric;
+	vector<float> channels[4];
+};
+
+/**
+ * One-to-many and all-pairs distance kernels over a ColorSet. Inner loops
+ * run over contiguous channel arrays and vectorize; matrices are computed
+ * in cache sized column blocks and rows are spread over threads.
+ * 
+ * Bit matrices store one row per color, getBitRowWords() 64 bit words per
+ * row; bit j of row i is set if colors i and j are within the threshold.
+ * A 50000 color palette needs about 300 MB as a bit matrix instead of
+ * 10 GB as floats.
+ */
+class ColorDistance {
+public:
+	static const size_t BLOCK = 1024;
+
+	static void row(const ColorSet& set, const OColor& ref, float* dist);
+	static void row(const ColorSet& set, size_t index, float* dist);
+	static void rowWithin(const ColorSet& set, size_t index, float threshold, unsigned long long* bits);
+	static void matrix(const ColorSet& set, float* dist, unsigned threads = 0);
+	static void matrixWithin(const ColorSet& set, float threshold, unsigned long long* bits, unsigned threads = 0);
+	static size_t getBitRowWords(size_t count);
+
+private:
+	static void rowRange(const ColorSet& set, const float* point, size_t begin, size_t end, float* dist);
+	static void rowRangeWithin(const ColorSet& set, const float* point, size_t begin, size_t end, float threshold, unsigned long long* bits);
+};
\ No newline at end of file
@@ -0,0 +1,146 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+enum GradientSpace {
+	GRADIENT_RGB, GRADIENT_LINEAR_RGB, GRADIENT_HSV, GRADIENT_LAB, GRADIENT_OKLAB, GRADIENT_OKLCH
+};
+
+/**
+ * Easing of the interpolation factor within one gradient segment.
+ * GRADIENT_EASE_STEP holds the color of the segment start up to the next stop.
+ */
+enum GradientEasing {
+	GRADIENT_EASE_LINEAR, GRADIENT_EASE_IN, GRADIENT_EASE_OUT, GRADIENT_EASE_IN_OUT, GRADIENT_EASE_STEP
+};
+
+/**
+ * Multi-stop color gradient. Stops are converted into the interpolation
+ * space once when they are added; hues (HSV, OKLCh) take the shorter way
+ * around the wheel, and the hue of an achromatic stop follows its
+ * neighbour so fades to grey do not sweep through other colors.
+ * 
+ * getColor() evaluates the gradient exactly. For bulk work bake() it into
+ * a ramp of N RGBA entries once and sample() parameter buffers through
+ * that ramp, which costs two table reads per channel and no color space
+ * math. With AVX2 enabled 8 parameters are sampled at a time.
+ * 
+ * <pre>
+ * ColorGradient gradient(GRADIENT_OKLAB);
+ * gradient.addStop(0, OColor::newRGB(0, 0, 0.5f));
+ * gradient.addStop(1, OColor::newRGB(1, 1, 0), GRADIENT_EASE_IN_OUT);
+ * gradient.bake(1024);
+ * gradient.sample(values, rgba, count);
+ * </pre>
+ */
+class ColorGradient {
+public:
+	ColorGradient(GradientSpace space = GRADIENT_OKLAB);
+
+	ColorGradient* addStop(float position, const OColor& color, GradientEasing easing = GRADIENT_EASE_LINEAR);
+	ColorGradient* clear();
+	ColorGradient* setSpace(GradientSpace space);
+	GradientSpace getSpace() const;
+	size_t getStopCount() const;
+	float getStopPosition(size_t index) const;
+	OColor getStopColor(size_t index) const;
+
+	OColor getColor(float t) const;
+	void getColor(float t, float* rgba) const;
+
+	bool bake(int size);
+	int getRampSize() const;
+	const float* getRamp(int channel) const;
+	bool sample(const float* t, float* rgba, size_t count) const;
+
+	/**
+	 * Samples the baked ramp into pixels of any PixelFormat.
+	 * 
+	 * @param t
+	 *            gradient parameters, clamped to 0..1
+	 * @param pixels
+	 *            result pixels
+	 * @param count
+	 *            number of parameters
+	 * @return false if the gradient has not been baked
+	 */
+	template<typename Fmt>
+	bool sample(const float* t, typename Fmt::Scalar* pixels, size_t count) const
+	{
+		static_assert(!Fmt::PLANAR, "ColorGradient needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		static const size_t BLOCK = 256;
+		float rgba[BLOCK * 4];
+		for (size_t begin = 0; begin < count; begin += BLOCK) {
+			size_t n = count - begin < BLOCK ? count - begin : BLOCK;
+			if (!sample(t + begin, rgba, n)) {
+				return false;
+			}
+			for (size_t i = 0; i < n; i++) {
+				S* p = pixels + (begin + i) * Fmt::CHANNELS;
+				p[Fmt::RED] = ChannelTraits<S>::fromFloat(rgba[i * 4]);
+				p[Fmt::GREEN] = ChannelTraits<S>::fromFloat(rgba[i * 4 + 1]);
+				p[Fmt::BLUE] = ChannelTraits<S>::fromFloat(rgba[i * 4 + 2]);
+				if (Fmt::HAS_ALPHA) {
+					p[Fmt::ALPHA] = ChannelTraits<S>::fromFloat(rgba[i * 4 + 3]);
+				}
+			}
+		}
+		return true;
+	}
+
+	static float ease(GradientEasing easing, float t);
+	static void toSpace(GradientSpace space, const OColor& color, float* coords);
+	static void fromSpace(GradientSpace space, const float* coords, float* rgb);
+
+private:
+	void convertStops();
+
+	struct Stop {
+		float position;
+		OColor color;
+		GradientEasing easing;
+		float coords[4];	// color in the interpolation space, then alpha
+	};
+
+	GradientSpace space;
+	vector<Stop> stops;
+	int rampSize;
+	vector<float> ramp;		// 4 planes of rampSize + 1 entries, last entry repeated
+};
\ No newline at end of file
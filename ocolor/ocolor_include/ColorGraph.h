@@ -0,0 +1,179 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "ColorSpace.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Color spaces known to the conversion graph. All spaces are float triplets
+ * except SPACE_CMYK which has 4 channels. Hues (HSV, OKLCh) are normalized
+ * to 0..1 and YCbCr is full range like OColor::rgbToYCbCr().
+ */
+enum ColorSpaceId {
+	SPACE_RGB,
+	SPACE_LINEAR_RGB,
+	SPACE_XYZ_D65,
+	SPACE_XYZ_D50,
+	SPACE_LAB,
+	SPACE_OKLAB,
+	SPACE_OKLCH,
+	SPACE_HSV,
+	SPACE_CMYK,
+	SPACE_YCBCR_601,
+	SPACE_YCBCR_709,
+	SPACE_DISPLAY_P3,
+	SPACE_LINEAR_P3,
+	SPACE_REC2020,
+	SPACE_LINEAR_REC2020,
+	SPACE_ADOBE_RGB,
+	SPACE_LINEAR_ADOBE_RGB,
+	SPACE_COUNT
+};
+
+/**
+ * Converts count interleaved colors between two adjacent spaces. src and
+ * dst never overlap.
+ */
+typedef void (*ConversionFunction)(const float* src, float* dst, size_t count);
+
+/**
+ * One hop of a conversion plan: either a function, or an affine transform
+ * (3x3 matrix plus offset) which can be fused with its neighbours.
+ */
+struct ConversionStep {
+	ConversionFunction function;
+	bool affine;
+	Matrix3 matrix;
+	Vector3 offset;
+	int inputChannels;
+	int outputChannels;
+};
+
+/**
+ * A registered conversion between two spaces with its estimated cost per
+ * pixel (roughly, in multiply-adds).
+ */
+struct ConversionEdge {
+	ColorSpaceId from;
+	ColorSpaceId to;
+	float cost;
+	ConversionStep step;
+};
+
+/**
+ * A resolved path between two spaces, with adjacent affine hops already
+ * fused. Plans are immutable and can be shared between threads.
+ */
+class ConversionPlan {
+public:
+	/**
+	 * Number of pixels converted per tile. Intermediate results of a tile
+	 * stay in two stack buffers, so the whole chain runs while the tile is
+	 * in L1 cache.
+	 */
+	static const size_t TILE = 256;
+
+	ConversionPlan();
+	bool isValid() const;
+	float getCost() const;
+	size_t getStepCount() const;
+	int getInputChannels() const;
+	int getOutputChannels() const;
+	void run(const float* src, float* dst, size_t count) const;
+
+private:
+	friend class ColorGraph;
+
+	vector<ConversionStep> steps;
+	float cost;
+	bool valid;
+	int inputChannels;
+	int outputChannels;
+};
+
+/**
+ * Registry of color spaces and the conversions between them. plan() finds
+ * the cheapest chain of registered edges (Dijkstra over the per-pixel cost
+ * estimates) and fuses consecutive affine edges into one matrix, e.g.
+ * linear sRGB -> XYZ D65 -> XYZ D50 becomes one 3x3 multiply.
+ * 
+ * The registry is thread-safe: the built-in edges are set up once, and
+ * addEdge() and plan() share a lock. Custom edges should still be
+ * registered before concurrent use, since convert() caches its plan on the
+ * first call and never sees edges added later.
+ * 
+ * <pre>
+ * ColorGraph::convert<SPACE_CMYK, SPACE_HSV>(cmyk, hsv, count);
+ * </pre>
+ */
+class ColorGraph {
+public:
+	static int getChannels(ColorSpaceId space);
+	static void addEdge(ColorSpaceId from, ColorSpaceId to, float cost, ConversionFunction function);
+	static void addAffineEdge(ColorSpaceId from, ColorSpaceId to, float cost, const Matrix3& matrix, const Vector3& offset);
+	static ConversionPlan plan(ColorSpaceId from, ColorSpaceId to);
+
+	/**
+	 * Converts a buffer between two spaces. The plan is built on the first
+	 * call and reused, so edges added later are not seen by an already used
+	 * From/To pair.
+	 * 
+	 * @param src
+	 *            count interleaved colors of From
+	 * @param dst
+	 *            count interleaved colors of To, may be the same as src if
+	 *            both spaces have the same channel count
+	 * @param count
+	 *            number of colors
+	 * @return false if there is no path between the spaces
+	 */
+	template<ColorSpaceId From, ColorSpaceId To>
+	static bool convert(const float* src, float* dst, size_t count)
+	{
+		static const ConversionPlan cached = plan(From, To);
+		if (!cached.isValid()) {
+			return false;
+		}
+		cached.run(src, dst, count);
+		return true;
+	}
+
+private:
+	static vector<ConversionEdge>& edges();
+	static void addEdge(vector<ConversionEdge>& list, ColorSpaceId from, ColorSpaceId to, float cost, ConversionFunction function);
+	static void addAffineEdge(vector<ConversionEdge>& list, ColorSpaceId from, ColorSpaceId to, float cost, const Matrix3& matrix, const Vector3& offset);
+	static void addBuiltinEdges(vector<ConversionEdge>& list);
+};
\ No newline at end of file
@@ -0,0 +1,148 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * 4x5 affine color transform on RGBA in 0..1:
+ * 
+ * <pre>
+ * R' = m[0]  * R + m[1]  * G + m[2]  * B + m[3]  * A + m[4]
+ * G' = m[5]  * R + m[6]  * G + m[7]  * B + m[8]  * A + m[9]
+ * B' = m[10] * R + m[11] * G + m[12] * B + m[13] * A + m[14]
+ * A' = m[15] * R + m[16] * G + m[17] * B + m[18] * A + m[19]
+ * </pre>
+ * 
+ * Linear adjustments compose by multiplication, so a chain of them is
+ * applied as one matrix per pixel instead of one OColor::setRGB() round
+ * trip per step. Results are clipped to 0..1 once, after the whole chain.
+ * 
+ * <pre>
+ * ColorMatrix m = ColorMatrix::newContrast(1.2f)
+ *     .then(ColorMatrix::newSaturation(0.8f))
+ *     .then(ColorMatrix::newSepia());
+ * m.apply<BGRA8>(pixels, pixels, count);
+ * </pre>
+ */
+class ColorMatrix {
+public:
+	float m[20];
+
+	ColorMatrix();
+	ColorMatrix(const float* values);
+
+	static ColorMatrix newScale(float r, float g, float b, float a = 1);
+	static ColorMatrix newOffset(float r, float g, float b, float a = 0);
+	static ColorMatrix newInvert();
+	static ColorMatrix newSaturation(float s);
+	static ColorMatrix newGrayscale();
+	static ColorMatrix newContrast(float c);
+	static ColorMatrix newBrightness(float amount);
+	static ColorMatrix newSepia(float amount = 1);
+	static ColorMatrix newHueRotation(float theta);
+	static ColorMatrix newChannelMix(const float* mix);
+
+	ColorMatrix then(const ColorMatrix& next) const;
+	ColorMatrix operator*(const ColorMatrix& other) const;
+	bool isIdentity() const;
+
+	void apply(const float* rgba, float* result) const;
+	OColor apply(const OColor& color) const;
+	void apply(const float* src, float* dst, size_t count) const;
+	void apply(const unsigned char* src, unsigned char* dst, size_t count, int red, int green, int blue, int alpha) const;
+
+	/**
+	 * Transforms pixels of any interleaved PixelFormat; src and dst may be
+	 * the same buffer. Formats without alpha are read as opaque. 8 bit RGBA
+	 * layouts and RGBAF use SSE kernels.
+	 * 
+	 * @param src
+	 *            source pixels
+	 * @param dst
+	 *            result pixels
+	 * @param count
+	 *            number of pixels
+	 */
+	template<typename Fmt>
+	void apply(const typename Fmt::Scalar* src, typename Fmt::Scalar* dst, size_t count) const
+	{
+		static_assert(!Fmt::PLANAR, "ColorMatrix needs interleaved pixels");
+		applyPixels<Fmt>(src, dst, count, (typename Fmt::Scalar*) 0);
+	}
+
+private:
+	template<typename Fmt, typename S>
+	void applyPixels(const S* src, S* dst, size_t count, S*) const
+	{
+		for (size_t i = 0; i < count; i++) {
+			const S* p = src + i * Fmt::CHANNELS;
+			float in[4] = { ChannelTraits<S>::toFloat(p[Fmt::RED]), ChannelTraits<S>::toFloat(p[Fmt::GREEN]),
+							ChannelTraits<S>::toFloat(p[Fmt::BLUE]), Fmt::HAS_ALPHA ? ChannelTraits<S>::toFloat(p[Fmt::ALPHA < 0 ? 0 : Fmt::ALPHA]) : 1 };
+			float out[4];
+			apply(in, out);
+			S* q = dst + i * Fmt::CHANNELS;
+			q[Fmt::RED] = ChannelTraits<S>::fromFloat(out[0]);
+			q[Fmt::GREEN] = ChannelTraits<S>::fromFloat(out[1]);
+			q[Fmt::BLUE] = ChannelTraits<S>::fromFloat(out[2]);
+			if (Fmt::HAS_ALPHA) {
+				q[Fmt::ALPHA < 0 ? 0 : Fmt::ALPHA] = ChannelTraits<S>::fromFloat(out[3]);
+			}
+		}
+	}
+
+	template<typename Fmt>
+	void applyPixels(const unsigned char* src, unsigned char* dst, size_t count, unsigned char*) const
+	{
+		if (Fmt::CHANNELS == 4) {
+			apply(src, dst, count, Fmt::RED, Fmt::GREEN, Fmt::BLUE, Fmt::ALPHA);
+		}
+		else {
+			applyPixels<Fmt, unsigned char>(src, dst, count, (unsigned char*) 0);
+		}
+	}
+
+	template<typename Fmt>
+	void applyPixels(const float* src, float* dst, size_t count, float*) const
+	{
+		if (Fmt::CHANNELS == 4 && Fmt::RED == 0 && Fmt::GREEN == 1 && Fmt::BLUE == 2) {
+			apply(src, dst, count);
+		}
+		else {
+			applyPixels<Fmt, float>(src, dst, count, (float*) 0);
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,388 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include "Parallel.h"
+#include "MathUtils.h"
+#include <math.h>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Color space an operation of a ColorOps chain works in. OPS_ANY
+ * operations (alpha) work in whichever space the chain is in.
+ */
+enum OpsSpace { OPS_ANY, OPS_RGB, OPS_HSV };
+
+/**
+ * Working value of a chain: RGB or HSV, depending on where in the chain
+ * it is, plus alpha.
+ */
+struct OpsPixel {
+	float c[3];
+	float alpha;
+
+	static float clip(float v) {
+		return v < 0 ? 0 : (v > 1 ? 1 : v);
+	}
+
+	/**
+	 * Hue wrap of OColor::setHSV().
+	 */
+	static float wrap(float h) {
+		h = fmodf(h, 1);
+		h = h < 0 ? h + 1 : h;
+		// tiny negative hues round up to exactly 1
+		return h >= 1 ? 0 : h;
+	}
+};
+
+template<int From, int To>
+struct OpsConversion {
+	static void run(OpsPixel&) {
+	}
+};
+
+template<>
+struct OpsConversion<OPS_RGB, OPS_HSV> {
+	static void run(OpsPixel& p) {
+		OColor::rgbToHSV(p.c[0], p.c[1], p.c[2], p.c);
+	}
+};
+
+template<>
+struct OpsConversion<OPS_HSV, OPS_RGB> {
+	static void run(OpsPixel& p) {
+		OColor::hsvToRGB(p.c[0], p.c[1], p.c[2], p.c);
+	}
+};
+
+// Operations, each with the clipping and hue wrapping of its OColor method.
+
+struct OpsDarken {
+	static const int SPACE = OPS_HSV;
+	float step;
+	void apply(OpsPixel& p) const { p.c[2] = OpsPixel::clip(p.c[2] - step); }
+};
+
+struct OpsLighten {
+	static const int SPACE = OPS_HSV;
+	float step;
+	void apply(OpsPixel& p) const { p.c[2] = OpsPixel::clip(p.c[2] + step); }
+};
+
+struct OpsSaturate {
+	static const int SPACE = OPS_HSV;
+	float step;
+	void apply(OpsPixel& p) const { p.c[1] = OpsPixel::clip(p.c[1] + step); }
+};
+
+struct OpsDesaturate {
+	static const int SPACE = OPS_HSV;
+	float step;
+	void apply(OpsPixel& p) const { p.c[1] = OpsPixel::clip(p.c[1] - step); }
+};
+
+struct OpsSetHue {
+	static const int SPACE = OPS_HSV;
+	float hue;
+	void apply(OpsPixel& p) const { p.c[0] = OpsPixel::wrap(hue); }
+};
+
+struct OpsSetSaturation {
+	static const int SPACE = OPS_HSV;
+	float saturation;
+	void apply(OpsPixel& p) const { p.c[1] = OpsPixel::clip(saturation); }
+};
+
+struct OpsSetBrightness {
+	static const int SPACE = OPS_HSV;
+	float brightness;
+	void apply(OpsPixel& p) const { p.c[2] = OpsPixel::clip(brightness); }
+};
+
+struct OpsAdjustHSV {
+	static const int SPACE = OPS_HSV;
+	float h, s, v;
+	void apply(OpsPixel& p) const {
+		p.c[0] = OpsPixel::wrap(p.c[0] + h);
+		p.c[1] = OpsPixel::clip(p.c[1] + s);
+		p.c[2] = OpsPixel::clip(p.c[2] + v);
+	}
+};
+
+struct OpsAdjustContrast {
+	static const int SPACE = OPS_HSV;
+	float amount;
+	void apply(OpsPixel& p) const { p.c[2] = OpsPixel::clip(p.c[2] + (p.c[2] < 0.5f ? -amount : amount)); }
+};
+
+struct OpsRotateRYB {
+	static const int SPACE = OPS_HSV;
+	int theta;
+	void apply(OpsPixel& p) const { p.c[0] = OpsPixel::wrap(OColor::rotateHueRYB(p.c[0], theta)); }
+};
+
+struct OpsInvertRGB {
+	static const int SPACE = OPS_RGB;
+	void apply(OpsPixel& p) const {
+		for (int i = 0; i < 3; i++) {
+			p.c[i] = OpsPixel::clip(1 - p.c[i]);
+		}
+	}
+};
+
+struct OpsAdjustRGB {
+	static const int SPACE = OPS_RGB;
+	float r, g, b;
+	void apply(OpsPixel& p) const {
+		p.c[0] = OpsPixel::clip(p.c[0] + r);
+		p.c[1] = OpsPixel::clip(p.c[1] + g);
+		p.c[2] = OpsPixel::clip(p.c[2] + b);
+	}
+};
+
+struct OpsSetAlpha {
+	static const int SPACE = OPS_ANY;
+	float alpha;
+	void apply(OpsPixel& p) const { p.alpha = alpha; }
+};
+
+/**
+ * Fluent builder methods shared by every chain. Each call returns a new,
+ * longer chain type; nothing is evaluated until apply().
+ */
+template<typename Self>
+class ColorOpsBuilder {
+public:
+	ColorOps<Self, OpsDarken> darken(float step) const { return chain(OpsDarken { step }); }
+	ColorOps<Self, OpsLighten> lighten(float step) const { return chain(OpsLighten { step }); }
+	ColorOps<Self, OpsSaturate> saturate(float step) const { return chain(OpsSaturate { step }); }
+	ColorOps<Self, OpsDesaturate> desaturate(float step) const { return chain(OpsDesaturate { step }); }
+	ColorOps<Self, OpsSetHue> setHue(float hue) const { return chain(OpsSetHue { hue }); }
+	ColorOps<Self, OpsSetSaturation> setSaturation(float saturation) const { return chain(OpsSetSaturation { saturation }); }
+	ColorOps<Self, OpsSetBrightness> setBrightness(float brightness) const { return chain(OpsSetBrightness { brightness }); }
+	ColorOps<Self, OpsAdjustHSV> adjustHSV(float h, float s, float v) const { return chain(OpsAdjustHSV { h, s, v }); }
+	ColorOps<Self, OpsAdjustContrast> adjustContrast(float amount) const { return chain(OpsAdjustContrast { amount }); }
+	ColorOps<Self, OpsRotateRYB> rotateRYB(int theta) const { return chain(OpsRotateRYB { theta }); }
+	ColorOps<Self, OpsRotateRYB> rotateRYB(float theta) const { return chain(OpsRotateRYB { (int) MathUtils::degrees(theta) }); }
+	ColorOps<Self, OpsRotateRYB> complement() const { return chain(OpsRotateRYB { 180 }); }
+	ColorOps<Self, OpsInvertRGB> invertRGB() const { return chain(OpsInvertRGB()); }
+	ColorOps<Self, OpsAdjustRGB> adjustRGB(float r, float g, float b) const { return chain(OpsAdjustRGB { r, g, b }); }
+	ColorOps<Self, OpsSetAlpha> setAlpha(float alpha) const { return chain(OpsSetAlpha { alpha }); }
+
+	/**
+	 * Evaluates the chain on a color: the color's cached RGB or HSV values
+	 * are used as the starting point, whichever the first operation needs,
+	 * and the color is updated with one setRGB() or setHSV() call.
+	 * 
+	 * @param color
+	 * @return the color
+	 */
+	OColor* apply(OColor& color) const
+	{
+		static const int start = Self::START == OPS_ANY ? OPS_RGB : Self::START;
+		static const int end = Self::template Out<start>::value;
+		OpsPixel p;
+		if (start == OPS_HSV) {
+			p.c[0] = color.getHue();
+			p.c[1] = color.getSaturation();
+			p.c[2] = color.getBrightness();
+		}
+		else {
+			p.c[0] = color.getRed_RGB();
+			p.c[1] = color.getGreen_RGB();
+			p.c[2] = color.getBlue_RGB();
+		}
+		p.alpha = color.getAlpha();
+		self().template eval<start>(p);
+		if (Self::START != OPS_ANY) {
+			if (end == OPS_HSV) {
+				color.setHSV(p.c);
+			}
+			else {
+				color.setRGB(p.c);
+			}
+		}
+		return color.setAlpha(p.alpha);
+	}
+
+	/**
+	 * @param color
+	 * @return a copy of the color with the chain applied
+	 */
+	OColor getApplied(const OColor& color) const
+	{
+		OColor result = color;
+		apply(result);
+		return result;
+	}
+
+	/**
+	 * Evaluates the chain on every pixel of an interleaved PixelFormat
+	 * buffer; src and dst may be the same buffer. Formats without alpha are
+	 * read as opaque.
+	 * 
+	 * @param src
+	 *            source pixels
+	 * @param dst
+	 *            result pixels
+	 * @param count
+	 *            number of pixels
+	 * @param threads
+	 *            0 for one thread per core
+	 */
+	template<typename Fmt>
+	void apply(const typename Fmt::Scalar* src, typename Fmt::Scalar* dst, size_t count, unsigned threads = 0) const
+	{
+		static_assert(!Fmt::PLANAR, "ColorOps needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		static const int end = Self::template Out<OPS_RGB>::value;
+		const Self& ops = self();
+		Parallel::forChunks(count, 16384, threads, [&](size_t begin, size_t last) {
+			for (size_t i = begin; i < last; i++) {
+				const S* s = src + i * Fmt::CHANNELS;
+				OpsPixel p;
+				p.c[0] = ChannelTraits<S>::toFloat(s[Fmt::RED]);
+				p.c[1] = ChannelTraits<S>::toFloat(s[Fmt::GREEN]);
+				p.c[2] = ChannelTraits<S>::toFloat(s[Fmt::BLUE]);
+				p.alpha = Fmt::HAS_ALPHA ? ChannelTraits<S>::toFloat(s[Fmt::ALPHA < 0 ? 0 : Fmt::ALPHA]) : 1;
+				ops.template eval<OPS_RGB>(p);
+				OpsConversion<end, OPS_RGB>::run(p);
+				S* d = dst + i * Fmt::CHANNELS;
+				d[Fmt::RED] = ChannelTraits<S>::fromFloat(p.c[0]);
+				d[Fmt::GREEN] = ChannelTraits<S>::fromFloat(p.c[1]);
+				d[Fmt::BLUE] = ChannelTraits<S>::fromFloat(p.c[2]);
+				if (Fmt::HAS_ALPHA) {
+					d[Fmt::ALPHA < 0 ? 0 : Fmt::ALPHA] = ChannelTraits<S>::fromFloat(p.alpha);
+				}
+			}
+		});
+	}
+
+private:
+	const Self& self() const {
+		return static_cast<const Self&>(*this);
+	}
+
+	template<typename Op>
+	ColorOps<Self, Op> chain(const Op& op) const {
+		return ColorOps<Self, Op>(self(), op);
+	}
+};
+
+/**
+ * Empty chain, as returned by OColor::ops().
+ */
+template<>
+class ColorOps<void, void> : public ColorOpsBuilder<ColorOps<void, void> > {
+public:
+	static const int START = OPS_ANY;
+	static const int LENGTH = 0;
+
+	template<int In>
+	struct Out {
+		static const int value = In;
+	};
+
+	template<int In>
+	struct Conversions {
+		static const int value = 0;
+	};
+
+	template<int In>
+	void eval(OpsPixel&) const {
+	}
+};
+
+/**
+ * Deferred chain of OColor adjustments, built with OColor::ops() and the
+ * fluent methods of ColorOpsBuilder. The chain is a type: which space each
+ * operation runs in is known at compile time, so runs of HSV operations
+ * share one HSV value and a conversion is only compiled in where the chain
+ * switches between RGB and HSV operations. Alpha operations never cause a
+ * conversion. Conversions<In>::value gives the count for a starting space.
+ * 
+ * The same chain object applies to a single OColor or a whole buffer and
+ * gives the same results as calling the OColor methods one after another.
+ * 
+ * <pre>
+ * auto grade = OColor::ops().darken(0.1f).saturate(0.2f).rotateRYB(30).setAlpha(0.5f);
+ * grade.apply(color);
+ * grade.apply<BGRA8>(pixels, pixels, count);
+ * </pre>
+ */
+template<typename Prev, typename Op>
+class ColorOps : public ColorOpsBuilder<ColorOps<Prev, Op> > {
+public:
+	static const int START = Prev::START != OPS_ANY ? Prev::START : Op::SPACE;
+	static const int LENGTH = Prev::LENGTH + 1;
+
+	/**
+	 * Space the working value is in after this operation, for a chain
+	 * entered in space In.
+	 */
+	template<int In>
+	struct Out {
+		static const int value = Op::SPACE == OPS_ANY ? Prev::template Out<In>::value : Op::SPACE;
+	};
+
+	template<int In>
+	struct Conversions {
+		static const int value = Prev::template Conversions<In>::value +
+				(Op::SPACE != OPS_ANY && Op::SPACE != Prev::template Out<In>::value ? 1 : 0);
+	};
+
+	ColorOps(const Prev& prev, const Op& op) :
+		prev(prev), op(op) {
+	}
+
+	template<int In>
+	void eval(OpsPixel& p) const {
+		static const int current = Prev::template Out<In>::value;
+		prev.template eval<In>(p);
+		OpsConversion<current, Out<In>::value>::run(p);
+		op.apply(p);
+	}
+
+private:
+	Prev prev;
+	Op op;
+};
+
+inline ColorOps<> OColor::ops()
+{
+	return ColorOps<>();
+}
\ No newline at end of file
@@ -0,0 +1,425 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include <cstddef>
+#include <cstring>
+
+using namespace std;
+
+/**
+ * IEEE 754 binary16 (half precision) color channel storage. Arithmetic is
+ * never done on Half directly; values are widened to float, processed and
+ * narrowed again, so the type only exists to halve the memory footprint of
+ * large color sets.
+ * 
+ * @see ColorPrecision
+ */
+struct Half {
+	Half() : bits(0) {}
+
+	unsigned short bits;
+};
+
+/**
+ * Conversions between the channel scalar types supported by OColorT
+ * (Half, float and double), for single values and for whole buffers.
+ * The buffer kernels use the F16C instructions for Half <-> float when the
+ * library is compiled with them enabled (e.g. -mf16c), and a portable
+ * round-to-nearest-even path otherwise.
+ */
+class ColorPrecision {
+public:
+	/**
+	 * Widens a half precision value to float. Denormals, infinities and
+	 * NaNs are preserved.
+	 * 
+	 * @param h
+	 * @return float value
+	 */
+	static float halfToFloat(Half h) {
+		const unsigned int shiftedExp = 0x7c00 << 13;
+		unsigned int u = (h.bits & 0x7fff) << 13;
+		unsigned int exp = shiftedExp & u;
+		u += (127 - 15) << 23;
+		float f;
+		if (exp == shiftedExp) {
+			// Inf/NaN
+			u += (128 - 16) << 23;
+			memcpy(&f, &u, sizeof(f));
+		} else if (exp == 0) {
+			// zero/denormal, renormalize
+			const unsigned int magicBits = 113 << 23;
+			float magic;
+			memcpy(&magic, &magicBits, sizeof(magic));
+			u += 1 << 23;
+			memcpy(&f, &u, sizeof(f));
+			f -= magic;
+			memcpy(&u, &f, sizeof(u));
+		}
+		u |= (h.bits & 0x8000) << 16;
+		memcpy(&f, &u, sizeof(f));
+		return f;
+	}
+
+	/**
+	 * Narrows a float to half precision using round-to-nearest-even.
+	 * Values beyond the half range become infinity.
+	 * 
+	 * @param f
+	 * @return half value
+	 */
+	static Half floatToHalf(float f) {
+		const unsigned int f32Inf = 255 << 23;
+		const unsigned int f16Max = (127 + 16) << 23;
+		const unsigned int denormMagicBits = ((127 - 15) + (23 - 10) + 1) << 23;
+		unsigned int u;
+		memcpy(&u, &f, sizeof(u));
+		unsigned int sign = u & 0x80000000u;
+		u ^= sign;
+
+		Half h;
+		if (u >= f16Max) {
+			h.bits = (u > f32Inf) ? 0x7e00 : 0x7c00;
+		} else if (u < (113 << 23)) {
+			float denormMagic, v;
+			memcpy(&denormMagic, &denormMagicBits, sizeof(denormMagic));
+			memcpy(&v, &u, sizeof(v));
+			v += denormMagic;
+			memcpy(&u, &v, sizeof(u));
+			h.bits = (unsigned short) (u - denormMagicBits);
+		} else {
+			unsigned int mantOdd = (u >> 13) & 1;
+			u += ((unsigned int) (15 - 127) << 23) + 0xfff;
+			u += mantOdd;
+			h.bits = (unsigned short) (u >> 13);
+		}
+		h.bits |= (unsigned short) (sign >> 16);
+		return h;
+	}
+
+	static void halfToFloat(const Half* src, float* dst, size_t count);
+	static void floatToHalf(const float* src, Half* dst, size_t count);
+	static void floatToDouble(const float* src, double* dst, size_t count);
+	static void doubleToFloat(const double* src, float* dst, size_t count);
+	static void halfToDouble(const Half* src, double* dst, size_t count);
+	static void doubleToHalf(const double* src, Half* dst, size_t count);
+};
+
+/**
+ * Describes how a channel scalar type is widened for arithmetic and
+ * narrowed back for storage. Half computes in float, float and double
+ * compute in their own precision.
+ */
+template<typename T> struct ScalarTraits;
+
+template<> struct ScalarTraits<float> {
+	typedef float Compute;
+	static float widen(float v) { return v; }
+	static float narrow(float v) { return v; }
+	static void convert(const float* src, float* dst, size_t count) { memcpy(dst, src, count * sizeof(float)); }
+	static void convert(const float* src, double* dst, size_t count) { ColorPrecision::floatToDouble(src, dst, count); }
+	static void convert(const float* src, Half* dst, size_t count) { ColorPrecision::floatToHalf(src, dst, count); }
+};
+
+template<> struct ScalarTraits<double> {
+	typedef double Compute;
+	static double widen(double v) { return v; }
+	static double narrow(double v) { return v; }
+	static void convert(const double* src, float* dst, size_t count) { ColorPrecision::doubleToFloat(src, dst, count); }
+	static void convert(const double* src, double* dst, size_t count) { memcpy(dst, src, count * sizeof(double)); }
+	static void convert(const double* src, Half* dst, size_t count) { ColorPrecision::doubleToHalf(src, dst, count); }
+};
+
+template<> struct ScalarTraits<Half> {
+	typedef float Compute;
+	static float widen(Half v) { return ColorPrecision::halfToFloat(v); }
+	static Half narrow(float v) { return ColorPrecision::floatToHalf(v); }
+	static void convert(const Half* src, float* dst, size_t count) { ColorPrecision::halfToFloat(src, dst, count); }
+	static void convert(const Half* src, double* dst, size_t count) { ColorPrecision::halfToDouble(src, dst, count); }
+	static void convert(const Half* src, Half* dst, size_t count) { memcpy(dst, src, count * sizeof(Half)); }
+};
+
+/**
+ * Converts a buffer of channel values between scalar types.
+ * 
+ * @param src
+ * @param dst
+ * @param count
+ *            number of scalars (not colors)
+ */
+template<typename S, typename D>
+void convertScalars(const S* src, D* dst, size_t count)
+{
+	ScalarTraits<S>::convert(src, dst, count);
+}
+
+/**
+ * Precision-templated conversion functions. These mirror the static
+ * converters of OColor, but read and write channels of any supported
+ * scalar type and do the math in ScalarTraits<T>::Compute.
+ */
+template<typename T>
+class ColorMath {
+public:
+	typedef typename ScalarTraits<T>::Compute C;
+
+	/**
+	 * Converts HSV values into an RGB array.
+	 * 
+	 * @param h
+	 * @param s
+	 * @param v
+	 * @param rgb
+	 *            result array of 3 values
+	 */
+	static void hsvToRGB(T h, T s, T v, T* rgb)
+	{
+		C hc = ScalarTraits<T>::widen(h);
+		C sc = ScalarTraits<T>::widen(s);
+		C vc = ScalarTraits<T>::widen(v);
+		C r, g, b;
+		if (fabs(sc) < 0.0000001) {
+			r = g = b = vc;
+		} else {
+			hc *= 6;
+			int i = (int) hc;
+			C f = hc - i;
+			C p = vc * (1 - sc);
+			C q = vc * (1 - sc * f);
+			C t = vc * (1 - sc * (1 - f));
+			switch (i) {
+				case 0:  r = vc; g = t;  b = p;  break;
+				case 1:  r = q;  g = vc; b = p;  break;
+				case 2:  r = p;  g = vc; b = t;  break;
+				case 3:  r = p;  g = q;  b = vc; break;
+				case 4:  r = t;  g = p;  b = vc; break;
+				default: r = vc; g = p;  b = q;  break;
+			}
+		}
+		rgb[0] = ScalarTraits<T>::narrow(r);
+		rgb[1] = ScalarTraits<T>::narrow(g);
+		rgb[2] = ScalarTraits<T>::narrow(b);
+	}
+
+	/**
+	 * Converts RGB values into an HSV array.
+	 * 
+	 * @param r
+	 * @param g
+	 * @param b
+	 * @param hsv
+	 *            result array of 3 values
+	 */
+	static void rgbToHSV(T r, T g, T b, T* hsv)
+	{
+		C rc = ScalarTraits<T>::widen(r);
+		C gc = ScalarTraits<T>::widen(g);
+		C bc = ScalarTraits<T>::widen(b);
+		C v = (rc > gc) ? ((rc > bc) ? rc : bc) : ((gc > bc) ? gc : bc);
+		C d = v - ((rc < gc) ? ((rc < bc) ? rc : bc) : ((gc < bc) ? gc : bc));
+		C h = 0, s = 0;
+		if (v != 0) {
+			s = d / v;
+		}
+		if (s != 0) {
+			if (rc == v) {
+				h = (gc - bc) / d;
+			} else if (gc == v) {
+				h = 2 + (bc - rc) / d;
+			} else {
+				h = 4 + (rc - gc) / d;
+			}
+		}
+		h /= 6;
+		if (h < 0) {
+			h += 1;
+		}
+		hsv[0] = ScalarTraits<T>::narrow(h);
+		hsv[1] = ScalarTraits<T>::narrow(s);
+		hsv[2] = ScalarTraits<T>::narrow(v);
+	}
+
+	/**
+	 * Converts RGB values into a CMYK array.
+	 * 
+	 * @param r
+	 * @param g
+	 * @param b
+	 * @param cmyk
+	 *            result array of 4 values
+	 */
+	static void rgbToCMYK(T r, T g, T b, T* cmyk)
+	{
+		C c = 1 - ScalarTraits<T>::widen(r);
+		C m = 1 - ScalarTraits<T>::widen(g);
+		C y = 1 - ScalarTraits<T>::widen(b);
+		C k = (c < m) ? ((c < y) ? c : y) : ((m < y) ? m : y);
+		cmyk[0] = ScalarTraits<T>::narrow(clip(c - k));
+		cmyk[1] = ScalarTraits<T>::narrow(clip(m - k));
+		cmyk[2] = ScalarTraits<T>::narrow(clip(y - k));
+		cmyk[3] = ScalarTraits<T>::narrow(clip(k));
+	}
+
+	/**
+	 * Converts CMYK values into an RGB array.
+	 * 
+	 * @param c
+	 * @param m
+	 * @param y
+	 * @param k
+	 * @param rgb
+	 *            result array of 3 values
+	 */
+	static void cmykToRGB(T c, T m, T y, T k, T* rgb)
+	{
+		C kc = ScalarTraits<T>::widen(k);
+		rgb[0] = ScalarTraits<T>::narrow(clip(1 - (ScalarTraits<T>::widen(c) + kc)));
+		rgb[1] = ScalarTraits<T>::narrow(clip(1 - (ScalarTraits<T>::widen(m) + kc)));
+		rgb[2] = ScalarTraits<T>::narrow(clip(1 - (ScalarTraits<T>::widen(y) + kc)));
+	}
+
+private:
+	static C clip(C a) {
+		return a < 0 ? 0 : (a > 1 ? 1 : a);
+	}
+};
+
+/**
+ * Compact RGBA color stored at a chosen channel precision. Unlike OColor,
+ * which keeps every color space in sync, OColorT only stores RGBA, so a
+ * Half color takes 8 bytes and a float color 16 bytes. Use it for large
+ * color sets and convert to OColor when the full API is needed.
+ * 
+ * @see OColorH
+ * @see OColorF
+ * @see OColorD
+ */
+template<typename T>
+class OColorT {
+public:
+	typedef T Scalar;
+
+	OColorT() {
+		rgba[0] = rgba[1] = rgba[2] = rgba[3] = T();
+	}
+
+	OColorT(T r, T g, T b, T a) {
+		rgba[0] = r;
+		rgba[1] = g;
+		rgba[2] = b;
+		rgba[3] = a;
+	}
+
+	/**
+	 * Factory method. Creates a new color from RGBA values given in the
+	 * compute precision of T.
+	 * 
+	 * @param r
+	 * @param g
+	 * @param b
+	 * @param a
+	 * @return new color
+	 */
+	static OColorT newRGBA(typename ScalarTraits<T>::Compute r, typename ScalarTraits<T>::Compute g,
+						   typename ScalarTraits<T>::Compute b, typename ScalarTraits<T>::Compute a)
+	{
+		return OColorT(ScalarTraits<T>::narrow(r), ScalarTraits<T>::narrow(g),
+					   ScalarTraits<T>::narrow(b), ScalarTraits<T>::narrow(a));
+	}
+
+	/**
+	 * Factory method. Creates a new color from the RGBA values of an OColor.
+	 * 
+	 * @param c
+	 * @return new color
+	 */
+	static OColorT fromOColor(const OColor& c)
+	{
+		return newRGBA(c.getRed_RGB(), c.getGreen_RGB(), c.getBlue_RGB(), c.getAlpha());
+	}
+
+	/**
+	 * @return an OColor with this color's RGBA values
+	 */
+	OColor toOColor() const
+	{
+		return OColor::newRGBA((float) red(), (float) green(), (float) blue(), (float) alpha());
+	}
+
+	/**
+	 * Converts this color to another channel precision.
+	 * 
+	 * @return converted color
+	 */
+	template<typename U>
+	OColorT<U> convert() const
+	{
+		OColorT<U> c;
+		convertScalars(rgba, c.rgba, 4);
+		return c;
+	}
+
+	/**
+	 * Copies the HSV values of this color into the given array.
+	 * 
+	 * @param hsv
+	 *            result array of 3 values
+	 */
+	void toHSV(T* hsv) const
+	{
+		ColorMath<T>::rgbToHSV(rgba[0], rgba[1], rgba[2], hsv);
+	}
+
+	/**
+	 * Copies the CMYK values of this color into the given array.
+	 * 
+	 * @param cmyk
+	 *            result array of 4 values
+	 */
+	void toCMYK(T* cmyk) const
+	{
+		ColorMath<T>::rgbToCMYK(rgba[0], rgba[1], rgba[2], cmyk);
+	}
+
+	typename ScalarTraits<T>::Compute red() const { return ScalarTraits<T>::widen(rgba[0]); }
+	typename ScalarTraits<T>::Compute green() const { return ScalarTraits<T>::widen(rgba[1]); }
+	typename ScalarTraits<T>::Compute blue() const { return ScalarTraits<T>::widen(rgba[2]); }
+	typename ScalarTraits<T>::Compute alpha() const { return ScalarTraits<T>::widen(rgba[3]); }
+
+	T rgba[4];
+};
+
+typedef OColorT<Half> OColorH;
+typedef OColorT<float> OColorF;
+typedef OColorT<double> OColorD;
\ No newline at end of file
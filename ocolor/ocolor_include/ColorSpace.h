@@ -0,0 +1,343 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Row major 3x3 matrix. All operations in Mat3 are constexpr, so matrices
+ * derived from primaries, white points and adaptation transforms are
+ * computed and multiplied together by the compiler.
+ */
+struct Matrix3 {
+	double m[9];
+};
+
+/**
+ * 3 component column vector, e.g. an XYZ white point.
+ */
+struct Vector3 {
+	double v[3];
+};
+
+/**
+ * Compile-time 3x3 matrix arithmetic.
+ */
+struct Mat3 {
+	static constexpr Matrix3 identity() {
+		return Matrix3{{ 1, 0, 0, 0, 1, 0, 0, 0, 1 }};
+	}
+
+	static constexpr double dot(const Matrix3& a, int row, const Matrix3& b, int col) {
+		return a.m[row * 3] * b.m[col] + a.m[row * 3 + 1] * b.m[3 + col] + a.m[row * 3 + 2] * b.m[6 + col];
+	}
+
+	static constexpr Matrix3 multiply(const Matrix3& a, const Matrix3& b) {
+		return Matrix3{{
+			dot(a, 0, b, 0), dot(a, 0, b, 1), dot(a, 0, b, 2),
+			dot(a, 1, b, 0), dot(a, 1, b, 1), dot(a, 1, b, 2),
+			dot(a, 2, b, 0), dot(a, 2, b, 1), dot(a, 2, b, 2)
+		}};
+	}
+
+	static constexpr Vector3 multiply(const Matrix3& a, const Vector3& v) {
+		return Vector3{{
+			a.m[0] * v.v[0] + a.m[1] * v.v[1] + a.m[2] * v.v[2],
+			a.m[3] * v.v[0] + a.m[4] * v.v[1] + a.m[5] * v.v[2],
+			a.m[6] * v.v[0] + a.m[7] * v.v[1] + a.m[8] * v.v[2]
+		}};
+	}
+
+	static constexpr double determinant(const Matrix3& a) {
+		return a.m[0] * (a.m[4] * a.m[8] - a.m[5] * a.m[7])
+			 - a.m[1] * (a.m[3] * a.m[8] - a.m[5] * a.m[6])
+			 + a.m[2] * (a.m[3] * a.m[7] - a.m[4] * a.m[6]);
+	}
+
+	static constexpr Matrix3 inverse(const Matrix3& a) {
+		return inverse(a, 1 / determinant(a));
+	}
+
+	static constexpr Matrix3 inverse(const Matrix3& a, double d) {
+		return Matrix3{{
+			(a.m[4] * a.m[8] - a.m[5] * a.m[7]) * d, (a.m[2] * a.m[7] - a.m[1] * a.m[8]) * d, (a.m[1] * a.m[5] - a.m[2] * a.m[4]) * d,
+			(a.m[5] * a.m[6] - a.m[3] * a.m[8]) * d, (a.m[0] * a.m[8] - a.m[2] * a.m[6]) * d, (a.m[2] * a.m[3] - a.m[0] * a.m[5]) * d,
+			(a.m[3] * a.m[7] - a.m[4] * a.m[6]) * d, (a.m[1] * a.m[6] - a.m[0] * a.m[7]) * d, (a.m[0] * a.m[4] - a.m[1] * a.m[3]) * d
+		}};
+	}
+
+	/**
+	 * @return a with column i scaled by s[i]
+	 */
+	static constexpr Matrix3 scaleColumns(const Matrix3& a, const Vector3& s) {
+		return Matrix3{{
+			a.m[0] * s.v[0], a.m[1] * s.v[1], a.m[2] * s.v[2],
+			a.m[3] * s.v[0], a.m[4] * s.v[1], a.m[5] * s.v[2],
+			a.m[6] * s.v[0], a.m[7] * s.v[1], a.m[8] * s.v[2]
+		}};
+	}
+
+	static constexpr Matrix3 diagonal(const Vector3& d) {
+		return Matrix3{{ d.v[0], 0, 0, 0, d.v[1], 0, 0, 0, d.v[2] }};
+	}
+
+	/**
+	 * @return XYZ (Y = 1) of an xy chromaticity
+	 */
+	static constexpr Vector3 xyToXYZ(double x, double y) {
+		return Vector3{{ x / y, 1, (1 - x - y) / y }};
+	}
+
+	/**
+	 * Builds the linear RGB to XYZ matrix of a working space from the xy
+	 * chromaticities of its primaries and its white point.
+	 */
+	static constexpr Matrix3 rgbToXYZ(double rx, double ry, double gx, double gy, double bx, double by, const Vector3& white) {
+		return rgbToXYZ(Matrix3{{
+			rx / ry, gx / gy, bx / by,
+			1, 1, 1,
+			(1 - rx - ry) / ry, (1 - gx - gy) / gy, (1 - bx - by) / by
+		}}, white);
+	}
+
+	static constexpr Matrix3 rgbToXYZ(const Matrix3& primaries, const Vector3& white) {
+		return scaleColumns(primaries, multiply(inverse(primaries), white));
+	}
+
+	static void apply(const Matrix3& m, const float* src, float* dst, size_t count);
+	static void applyPlanar(const Matrix3& m, const float* const* src, float* const* dst, size_t count);
+};
+
+/**
+ * Standard illuminants as XYZ with Y = 1.
+ */
+struct WhitePoint {
+	static constexpr Vector3 D50() { return Mat3::xyToXYZ(0.3457, 0.3585); }
+	static constexpr Vector3 D65() { return Mat3::xyToXYZ(0.3127, 0.3290); }
+};
+
+/**
+ * Chromatic adaptation transforms. adapt() returns the XYZ to XYZ matrix
+ * mapping colors seen under one white point to the corresponding colors
+ * under another (von Kries scaling in the transform's cone space).
+ */
+template<typename Cat>
+struct ChromaticAdaptation {
+	static constexpr Matrix3 adapt(const Vector3& from, const Vector3& to) {
+		return scale(Mat3::multiply(Cat::cone(), from), Mat3::multiply(Cat::cone(), to));
+	}
+
+private:
+	static constexpr Matrix3 scale(const Vector3& src, const Vector3& dst) {
+		return Mat3::multiply(Mat3::inverse(Cat::cone()),
+				Mat3::multiply(Mat3::diagonal(Vector3{{ dst.v[0] / src.v[0], dst.v[1] / src.v[1], dst.v[2] / src.v[2] }}), Cat::cone()));
+	}
+};
+
+/**
+ * Bradford cone response, the usual choice for ICC workflows.
+ */
+struct Bradford : ChromaticAdaptation<Bradford> {
+	static constexpr Matrix3 cone() {
+		return Matrix3{{
+			 0.8951,  0.2664, -0.1614,
+			-0.7502,  1.7135,  0.0367,
+			 0.0389, -0.0685,  1.0296
+		}};
+	}
+};
+
+/**
+ * CIECAM02 cone response.
+ */
+struct CAT02 : ChromaticAdaptation<CAT02> {
+	static constexpr Matrix3 cone() {
+		return Matrix3{{
+			 0.7328, 0.4296, -0.1624,
+			-0.7036, 1.6975,  0.0061,
+			 0.0030, 0.0136,  0.9834
+		}};
+	}
+};
+
+/*
+ * Color spaces. Each space provides its white point, the matrix to XYZ of
+ * its linear form, and its transfer curve (decode: encoded -> linear,
+ * encode: linear -> encoded). LINEAR is true when the transfer curve is the
+ * identity, which lets conversions skip it entirely.
+ */
+
+/**
+ * sRGB (IEC 61966-2-1), D65.
+ */
+struct SRGBSpace {
+	static const bool LINEAR = false;
+	static constexpr Vector3 white() { return WhitePoint::D65(); }
+	static constexpr Matrix3 toXYZ() { return Mat3::rgbToXYZ(0.64, 0.33, 0.30, 0.60, 0.15, 0.06, white()); }
+	static float decode(float v) { return OColor::srgbToLinear(v); }
+	static float encode(float v) { return OColor::linearToSRGB(v); }
+};
+
+/**
+ * sRGB primaries without the transfer curve.
+ */
+struct LinearSRGBSpace {
+	static const bool LINEAR = true;
+	static constexpr Vector3 white() { return WhitePoint::D65(); }
+	static constexpr Matrix3 toXYZ() { return SRGBSpace::toXYZ(); }
+	static float decode(float v) { return v; }
+	static float encode(float v) { return v; }
+};
+
+/**
+ * Display P3: DCI-P3 primaries, D65 white, sRGB transfer curve.
+ */
+struct DisplayP3Space {
+	static const bool LINEAR = false;
+	static constexpr Vector3 white() { return WhitePoint::D65(); }
+	static constexpr Matrix3 toXYZ() { return Mat3::rgbToXYZ(0.680, 0.320, 0.265, 0.690, 0.150, 0.060, white()); }
+	static float decode(float v) { return OColor::srgbToLinear(v); }
+	static float encode(float v) { return OColor::linearToSRGB(v); }
+};
+
+/**
+ * ITU-R BT.2020, D65, with the BT.2020 (BT.709 form) transfer curve.
+ */
+struct Rec2020Space {
+	static const bool LINEAR = false;
+	static constexpr Vector3 white() { return WhitePoint::D65(); }
+	static constexpr Matrix3 toXYZ() { return Mat3::rgbToXYZ(0.708, 0.292, 0.170, 0.797, 0.131, 0.046, white()); }
+	static float decode(float v);
+	static float encode(float v);
+};
+
+/**
+ * Adobe RGB (1998), D65, gamma 563/256.
+ */
+struct AdobeRGBSpace {
+	static const bool LINEAR = false;
+	static constexpr Vector3 white() { return WhitePoint::D65(); }
+	static constexpr Matrix3 toXYZ() { return Mat3::rgbToXYZ(0.64, 0.33, 0.21, 0.71, 0.15, 0.06, white()); }
+	static float decode(float v);
+	static float encode(float v);
+};
+
+/**
+ * CIE XYZ relative to D65.
+ */
+struct XYZD65Space {
+	static const bool LINEAR = true;
+	static constexpr Vector3 white() { return WhitePoint::D65(); }
+	static constexpr Matrix3 toXYZ() { return Mat3::identity(); }
+	static float decode(float v) { return v; }
+	static float encode(float v) { return v; }
+};
+
+/**
+ * CIE XYZ relative to D50, the ICC profile connection space.
+ */
+struct XYZD50Space {
+	static const bool LINEAR = true;
+	static constexpr Vector3 white() { return WhitePoint::D50(); }
+	static constexpr Matrix3 toXYZ() { return Mat3::identity(); }
+	static float decode(float v) { return v; }
+	static float encode(float v) { return v; }
+};
+
+/**
+ * Conversion between two of the color spaces above, going through XYZ.
+ * The linear part of the chain (From to XYZ, white point adaptation, XYZ to
+ * To) is fused into one matrix by the compiler, so a buffer is converted in
+ * a single pass: decode, one 3x3 multiply, encode. When both spaces are
+ * linear the pass is a plain matrix multiply.
+ * 
+ * <pre>
+ * ColorSpaceConversion<SRGBSpace, DisplayP3Space>::convert(rgb, p3, count);
+ * </pre>
+ * 
+ * @param From
+ *            source space
+ * @param To
+ *            destination space
+ * @param Cat
+ *            chromatic adaptation used when the white points differ
+ */
+template<typename From, typename To, typename Cat = Bradford>
+struct ColorSpaceConversion {
+	static constexpr Matrix3 matrix() {
+		return Mat3::multiply(Mat3::inverse(To::toXYZ()), Mat3::multiply(Cat::adapt(From::white(), To::white()), From::toXYZ()));
+	}
+
+	/**
+	 * Converts interleaved triplets.
+	 * 
+	 * @param src
+	 *            buffer of count * 3 floats
+	 * @param dst
+	 *            result buffer of count * 3 floats, may be the same as src
+	 * @param count
+	 *            number of colors
+	 */
+	static void convert(const float* src, float* dst, size_t count)
+	{
+		static constexpr Matrix3 M = matrix();
+		if (From::LINEAR && To::LINEAR) {
+			Mat3::apply(M, src, dst, count);
+			return;
+		}
+		const float m0 = (float) M.m[0], m1 = (float) M.m[1], m2 = (float) M.m[2];
+		const float m3 = (float) M.m[3], m4 = (float) M.m[4], m5 = (float) M.m[5];
+		const float m6 = (float) M.m[6], m7 = (float) M.m[7], m8 = (float) M.m[8];
+		for (size_t i = 0; i < count * 3; i += 3) {
+			float a = From::decode(src[i]);
+			float b = From::decode(src[i + 1]);
+			float c = From::decode(src[i + 2]);
+			dst[i] = To::encode(m0 * a + m1 * b + m2 * c);
+			dst[i + 1] = To::encode(m3 * a + m4 * b + m5 * c);
+			dst[i + 2] = To::encode(m6 * a + m7 * b + m8 * c);
+		}
+	}
+};
+
+/**
+ * CIE Lab and XYZ with an explicit reference white.
+ */
+class XYZ {
+public:
+	static void toLab(float x, float y, float z, const Vector3& white, float* lab);
+	static void fromLab(float l, float a, float b, const Vector3& white, float* xyz);
+	static void toLab(const float* xyz, float* lab, size_t count, const Vector3& white);
+	static void fromLab(const float* lab, float* xyz, size_t count, const Vector3& white);
+};
\ No newline at end of file
@@ -0,0 +1,94 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "ColorGradient.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+enum ColormapPreset {
+	COLORMAP_VIRIDIS, COLORMAP_MAGMA, COLORMAP_INFERNO, COLORMAP_PLASMA, COLORMAP_TURBO, COLORMAP_GREY
+};
+
+/**
+ * Maps scalar fields to colors through a fixed table of SIZE entries.
+ * Values are scaled from [min, max] onto the table; values outside the
+ * range take the end colors and NaN takes a separate NaN color, all
+ * without branches. With interpolation enabled neighbouring entries are
+ * blended, otherwise the nearest entry is used.
+ * 
+ * Results are packed 8 bit colors: ARGB ints (the byte order of BGRA8 on
+ * little-endian machines, as OColor::toARGB()) or, with rgba set, ABGR
+ * ints (RGBA8 bytes). With AVX2 enabled 8 values are mapped at a time
+ * using table gathers.
+ * 
+ * <pre>
+ * Colormap map = Colormap::newPreset(COLORMAP_VIRIDIS);
+ * map.setRange(-1, 1);
+ * map.map(values, (unsigned int*) pixels, count);
+ * </pre>
+ */
+class Colormap {
+public:
+	static const int SIZE = 256;
+
+	Colormap();
+	static Colormap newPreset(ColormapPreset preset);
+	static Colormap newGradient(const ColorGradient& gradient);
+	static Colormap newColors(const vector<OColor>& colors, GradientSpace space = GRADIENT_OKLAB);
+
+	Colormap* setRange(float min, float max);
+	Colormap* setInterpolation(bool interpolate);
+	Colormap* setNaNColor(const OColor& color);
+	float getMin() const;
+	float getMax() const;
+	bool isInterpolating() const;
+	OColor getColor(float value) const;
+
+	void map(const float* values, unsigned int* packed, size_t count, bool rgba = false) const;
+	void map(const unsigned short* values, unsigned int* packed, size_t count, bool rgba = false) const;
+
+private:
+	void setEntry(int index, const float* rgba);
+	void packEntry(int index);
+
+	float minValue;
+	float maxValue;
+	float scale;
+	bool interpolate;
+	float planes[4][SIZE + 1];		// RGBA entries as 0..1 floats, last entry repeated
+	unsigned int argb[SIZE + 1];	// packed entries, NaN color last
+	unsigned int abgr[SIZE + 1];
+};
\ No newline at end of file
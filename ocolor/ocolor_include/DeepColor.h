@@ -0,0 +1,185 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * Fixed point (32 fraction bits) coefficients for decoding 8 to 16 bit
+ * YCbCr straight to RGB samples of another depth, built with
+ * DeepColor::coefficients(). The depth rescale is folded into the
+ * coefficients, so the kernels never go through 8 bit or float. Sums are
+ * taken in 64 bits, so results are within one step of the exact conversion
+ * at the destination depth, 16 bit to 16 bit included.
+ */
+struct DeepYUVCoefficients {
+	int srcBits;
+	int dstBits;
+	int yOffset;
+	int chromaOffset;
+	int shift;
+	int max;
+
+	long long yScale;
+	long long crToR;
+	long long cbToG;
+	long long crToG;
+	long long cbToB;
+};
+
+/**
+ * High bit depth (10, 12 and 16 bit) sample handling for broadcast and
+ * HDR frames. Samples are kept in unsigned shorts, either LSB aligned (the
+ * value in the low bits, as in v210 or yuv420p10 planes) or MSB aligned
+ * (the value in the high bits, as in P010/P012/P016).
+ * 
+ * Depth changes are integer only and correctly rounded: rescale() gives
+ * round(v * (2^dstBits - 1) / (2^srcBits - 1)) for every value, so a
+ * 10 bit value taken to 16 bits and back is unchanged. Reducing to 8 bits
+ * is just one of the depths, never a required step. The rescale and
+ * alignment kernels work on eight uint16 lanes at a time with SSE2.
+ * 
+ * <pre>
+ * DeepYUVCoefficients k = DeepColor::coefficients(YCBCR_BT2020, false, 10, 16);
+ * DeepColor::p010ToRGB<RGBA16>(y, yStride, uv, uvStride, rgba, width * 8, width, height, k);
+ * </pre>
+ */
+class DeepColor {
+public:
+	static void rescale(const unsigned short* src, int srcBits, unsigned short* dst, int dstBits, size_t count);
+	static void rescale(const unsigned short* src, int srcBits, unsigned char* dst, size_t count);
+	static void rescale(const unsigned char* src, unsigned short* dst, int dstBits, size_t count);
+	static void fromMSB(const unsigned short* src, int bits, unsigned short* dst, size_t count);
+	static void toMSB(const unsigned short* src, int bits, unsigned short* dst, size_t count);
+
+	static size_t getV210Stride(int width);
+	static void unpackV210(const void* src, unsigned short* y, unsigned short* cb, unsigned short* cr, int width);
+	static void packV210(const unsigned short* y, const unsigned short* cb, const unsigned short* cr, void* dst, int width);
+
+	static DeepYUVCoefficients coefficients(YCbCrStandard standard, bool fullRange, int srcBits, int dstBits);
+
+	/**
+	 * Converts a P010 style frame (MSB aligned 4:2:0: a Y plane followed by
+	 * one interleaved CbCr plane) to an interleaved 8 or 16 bit format. The
+	 * sample depth is k.srcBits (10 for P010, 12 for P012, 16 for P016) and
+	 * the output depth k.dstBits, which may be below 16 for 16 bit formats
+	 * (LSB aligned 10 or 12 bit RGB).
+	 * 
+	 * @param yPlane
+	 * @param yStride
+	 *            bytes per Y row
+	 * @param uvPlane
+	 * @param uvStride
+	 *            bytes per CbCr row
+	 * @param dst
+	 * @param dstStride
+	 *            bytes per destination row
+	 * @param width
+	 * @param height
+	 * @param k
+	 */
+	template<typename Fmt>
+	static void p010ToRGB(const unsigned short* yPlane, size_t yStride, const unsigned short* uvPlane, size_t uvStride,
+						  typename Fmt::Scalar* dst, size_t dstStride, int width, int height, const DeepYUVCoefficients& k)
+	{
+		const unsigned char* y = (const unsigned char*) yPlane;
+		const unsigned char* uv = (const unsigned char*) uvPlane;
+		unsigned char* out = (unsigned char*) dst;
+		for (int row = 0; row < height; row++) {
+			const unsigned short* c = (const unsigned short*) (uv + (row >> 1) * uvStride);
+			decodeRow<Fmt>((const unsigned short*) (y + row * yStride), c, c + 1, 2, 16 - k.srcBits,
+						   (typename Fmt::Scalar*) (out + row * dstStride), width, k);
+		}
+	}
+
+	/**
+	 * Converts a v210 frame (10 bit 4:2:2, six pixels in every 16 bytes)
+	 * to an interleaved 8 or 16 bit format. k.srcBits must be 10.
+	 * 
+	 * @param src
+	 * @param srcStride
+	 *            bytes per v210 row, usually getV210Stride(width)
+	 * @param dst
+	 * @param dstStride
+	 *            bytes per destination row
+	 * @param width
+	 * @param height
+	 * @param k
+	 */
+	template<typename Fmt>
+	static void v210ToRGB(const void* src, size_t srcStride, typename Fmt::Scalar* dst, size_t dstStride,
+						  int width, int height, const DeepYUVCoefficients& k)
+	{
+		int chroma = (width + 1) / 2;
+		vector<unsigned short> y(width), cb(chroma), cr(chroma);
+		for (int row = 0; row < height; row++) {
+			unpackV210((const unsigned char*) src + row * srcStride, &y[0], &cb[0], &cr[0], width);
+			decodeRow<Fmt>(&y[0], &cb[0], &cr[0], 1, 0, (typename Fmt::Scalar*) ((unsigned char*) dst + row * dstStride),
+						   width, k);
+		}
+	}
+
+private:
+	template<typename Fmt>
+	static void decodeRow(const unsigned short* y, const unsigned short* cb, const unsigned short* cr, int chromaStep, int align,
+						  typename Fmt::Scalar* dst, int width, const DeepYUVCoefficients& k)
+	{
+		typedef typename Fmt::Scalar S;
+		static_assert(is_same<S, unsigned char>::value || is_same<S, unsigned short>::value,
+					  "DeepColor writes 8 or 16 bit integer samples");
+		static_assert(!Fmt::PLANAR, "DeepColor writes interleaved pixels");
+		long long round = 1ll << (k.shift - 1);
+		for (int x = 0; x < width; x++) {
+			int c = (x >> 1) * chromaStep;
+			long long luma = ((y[x] >> align) - k.yOffset) * k.yScale + round;
+			int u = (cb[c] >> align) - k.chromaOffset;
+			int v = (cr[c] >> align) - k.chromaOffset;
+			S* p = dst + x * Fmt::CHANNELS;
+			p[Fmt::RED] = (S) clampSample((luma + k.crToR * v) >> k.shift, k.max);
+			p[Fmt::GREEN] = (S) clampSample((luma - k.cbToG * u - k.crToG * v) >> k.shift, k.max);
+			p[Fmt::BLUE] = (S) clampSample((luma + k.cbToB * u) >> k.shift, k.max);
+			if (Fmt::HAS_ALPHA) {
+				p[Fmt::HAS_ALPHA ? Fmt::ALPHA : 0] = (S) k.max;
+			}
+		}
+	}
+
+	static int clampSample(long long v, int max) {
+		return v < 0 ? 0 : (v > max ? max : (int) v);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,247 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "InverseColormap.h"
+#include "PixelFormat.h"
+#include "Parallel.h"
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+using namespace std;
+
+enum DitherMethod {
+	DITHER_NONE, DITHER_BAYER, DITHER_BLUE_NOISE, DITHER_FLOYD_STEINBERG, DITHER_ATKINSON
+};
+
+struct DitherOptions {
+	DitherMethod method;
+	float spread;		// ordered dithering amplitude in 0..255 units, 0 to derive it from the palette size
+	float diffusion;	// share of the error that is diffused, 0..1
+	bool serpentine;	// alternate the scan direction per row; runs on a single thread
+	unsigned threads;	// 0 for one per core
+
+	DitherOptions() :
+		method(DITHER_FLOYD_STEINBERG), spread(0), diffusion(1), serpentine(false), threads(0) {
+	}
+};
+
+/**
+ * Dithers images to the palette of an InverseColormap, writing one palette
+ * index per pixel. Nearest colors come from the colormap, so any OColor
+ * palette can be the target.
+ * 
+ * Ordered dithering (Bayer 8x8 or a 64x64 void-and-cluster blue noise
+ * texture) treats every pixel independently and runs in parallel over
+ * bands of rows. Error diffusion (Floyd-Steinberg, Atkinson) runs as a
+ * wavefront: rows are dealt out to the threads in turn and each row
+ * follows the row above it a block of pixels behind, which is all the
+ * error terms need. Serpentine scanning has no such schedule and runs on
+ * one thread.
+ * 
+ * <pre>
+ * InverseColormap map;
+ * map.build(palette);
+ * Dither::apply<BGRA8>(pixels, width, height, width * 4, map, indices);
+ * </pre>
+ */
+class Dither {
+public:
+	static const int BLOCK = 64;
+
+	static const float* getBayer();
+	static const float* getBlueNoise();
+	static float getAutoSpread(size_t paletteSize);
+
+	/**
+	 * @param pixels
+	 *            first row of pixels of the given PixelFormat
+	 * @param width
+	 *            pixels per row
+	 * @param height
+	 *            number of rows
+	 * @param stride
+	 *            bytes between the start of two rows
+	 * @param map
+	 *            colormap built for the target palette
+	 * @param indices
+	 *            result, width * height palette indices
+	 * @param options
+	 *            method and parameters
+	 * @return false if the colormap has not been built
+	 */
+	template<typename Fmt, typename Index>
+	static bool apply(const typename Fmt::Scalar* pixels, size_t width, size_t height, size_t stride,
+			const InverseColormap& map, Index* indices, const DitherOptions& options = DitherOptions())
+	{
+		static_assert(!Fmt::PLANAR, "Dither needs interleaved pixels");
+		if (map.getPaletteSize() == 0) {
+			return false;
+		}
+		if (options.method == DITHER_FLOYD_STEINBERG || options.method == DITHER_ATKINSON) {
+			diffuse<Fmt>(pixels, width, height, stride, map, indices, options);
+		}
+		else {
+			ordered<Fmt>(pixels, width, height, stride, map, indices, options);
+		}
+		return true;
+	}
+
+private:
+	static vector<float> generateBlueNoise(int size, float sigma, unsigned seed);
+
+	template<typename Fmt>
+	static float channel(const typename Fmt::Scalar* p, int c) {
+		return ChannelTraits<typename Fmt::Scalar>::toFloat(p[c]) * 255;
+	}
+
+	static float clamp255(float v) {
+		return v < 0 ? 0 : (v > 255 ? 255 : v);
+	}
+
+	template<typename Fmt, typename Index>
+	static void ordered(const typename Fmt::Scalar* pixels, size_t width, size_t height, size_t stride,
+			const InverseColormap& map, Index* indices, const DitherOptions& options)
+	{
+		typedef typename Fmt::Scalar S;
+		int mask = 0;
+		const float* thresholds = NULL;
+		if (options.method == DITHER_BAYER) {
+			thresholds = getBayer();
+			mask = 7;
+		}
+		else if (options.method == DITHER_BLUE_NOISE) {
+			thresholds = getBlueNoise();
+			mask = 63;
+		}
+		float spread = options.spread > 0 ? options.spread : getAutoSpread(map.getPaletteSize());
+		int shift = (mask == 7) ? 3 : 6;
+
+		Parallel::forChunks(height, 16, options.threads, [&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; y++) {
+				const S* row = (const S*) ((const char*) pixels + y * stride);
+				Index* out = indices + y * width;
+				const float* t = thresholds ? thresholds + ((y & mask) << shift) : NULL;
+				for (size_t x = 0; x < width; x++) {
+					const S* p = row + x * Fmt::CHANNELS;
+					float offset = t ? (t[x & mask] - 0.5f) * spread : 0;
+					out[x] = (Index) map.lookup((int) (clamp255(channel<Fmt>(p, Fmt::RED) + offset) + 0.5f),
+												(int) (clamp255(channel<Fmt>(p, Fmt::GREEN) + offset) + 0.5f),
+												(int) (clamp255(channel<Fmt>(p, Fmt::BLUE) + offset) + 0.5f));
+				}
+			}
+		});
+	}
+
+	template<typename Fmt, typename Index>
+	static void diffuse(const typename Fmt::Scalar* pixels, size_t width, size_t height, size_t stride,
+			const InverseColormap& map, Index* indices, const DitherOptions& options)
+	{
+		typedef typename Fmt::Scalar S;
+		const bool atkinson = (options.method == DITHER_ATKINSON);
+		const float amount = options.diffusion;
+		const float* colors = map.getColors();
+		unsigned threads = options.serpentine ? 1 : Parallel::getThreadCount(options.threads);
+		threads = height < threads ? (unsigned) (height > 0 ? height : 1) : threads;
+
+		// error rows in flight: one per thread plus the two rows below the last;
+		// each row has two pixels of padding on either side
+		size_t slots = threads + 2;
+		size_t rowSize = (width + 4) * 3;
+		vector<float> errors(slots * rowSize, 0.0f);
+		RowProgress progress(height);
+
+		Parallel::forThreads(threads, [&](unsigned index, unsigned count) {
+			for (size_t y = index; y < height; y += count) {
+				const S* row = (const S*) ((const char*) pixels + y * stride);
+				Index* out = indices + y * width;
+				const float* cur = &errors[(y % slots) * rowSize];
+				float* below = &errors[((y + 1) % slots) * rowSize];
+				float* below2 = &errors[((y + 2) % slots) * rowSize];
+				fill(below2, below2 + rowSize, 0.0f);
+
+				// error for the next pixels of this row stays in registers, so the
+				// shared rows only receive error from the rows above them
+				float carry[6] = { 0, 0, 0, 0, 0, 0 };
+				auto step = [&](size_t x, int d) {
+					const S* p = row + x * Fmt::CHANNELS;
+					size_t e = (x + 2) * 3;
+					float v[3] = { channel<Fmt>(p, Fmt::RED), channel<Fmt>(p, Fmt::GREEN), channel<Fmt>(p, Fmt::BLUE) };
+					for (int k = 0; k < 3; k++) {
+						v[k] = clamp255(v[k] + cur[e + k] + carry[k]);
+					}
+					int i = map.lookup((int) (v[0] + 0.5f), (int) (v[1] + 0.5f), (int) (v[2] + 0.5f));
+					out[x] = (Index) i;
+					const float* c = colors + i * 3;
+					for (int k = 0; k < 3; k++) {
+						float error = (v[k] - c[k]) * amount;
+						if (atkinson) {
+							error *= 0.125f;
+							carry[k] = carry[k + 3] + error;
+							carry[k + 3] = error;
+							below[e - d * 3 + k] += error;
+							below[e + k] += error;
+							below[e + d * 3 + k] += error;
+							below2[e + k] += error;
+						}
+						else {
+							carry[k] = error * (7.0f / 16);
+							below[e - d * 3 + k] += error * (3.0f / 16);
+							below[e + k] += error * (5.0f / 16);
+							below[e + d * 3 + k] += error * (1.0f / 16);
+						}
+					}
+				};
+
+				if (options.serpentine && (y & 1)) {
+					for (size_t x = width; x-- > 0;) {
+						step(x, -1);
+					}
+					continue;
+				}
+				for (size_t begin = 0; begin < width; begin += BLOCK) {
+					size_t end = begin + BLOCK < width ? begin + BLOCK : width;
+					if (count > 1 && y > 0) {
+						progress.waitFor(y - 1, end + 1 < width ? end + 1 : width);
+					}
+					for (size_t x = begin; x < end; x++) {
+						step(x, 1);
+					}
+					if (count > 1) {
+						progress.publish(y, end);
+					}
+				}
+			}
+		});
+	}
+};
\ No newline at end of file
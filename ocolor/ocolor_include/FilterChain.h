@@ -0,0 +1,232 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "ColorMatrix.h"
+#include "HSVFilter.h"
+#include "ColorGradient.h"
+#include "Dither.h"
+#include "PixelFormat.h"
+#include "Parallel.h"
+#include <functional>
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Custom chain stage: transforms count pixels held as four planes (red,
+ * green, blue, alpha; 0..1 floats) in place.
+ */
+typedef function<void(float* const* planes, size_t count)> FilterFunction;
+
+enum FilterStageType {
+	FILTER_MATRIX, FILTER_HSV, FILTER_GRADIENT_MAP, FILTER_FUNCTION
+};
+
+/**
+ * Runs a chain of per-pixel operations tile by tile. A tile of up to TILE
+ * pixels is loaded once into planar floats, goes through every stage while
+ * it stays in cache, and is written once, so a long chain costs about the
+ * memory traffic of a single pass.
+ * 
+ * Stages are fused as they are added: consecutive ColorMatrix stages are
+ * multiplied into one matrix and consecutive HSVFilter stages share one
+ * RGB -> HSV -> RGB round trip. A chain is immutable while it runs and can
+ * be reused for every frame and shared between threads.
+ * 
+ * <pre>
+ * FilterChain chain;
+ * chain.addHSV(hsv)->addMatrix(ColorMatrix::newContrast(1.1f))->addGradientMap(gradient);
+ * chain.run<BGRA8, BGRA8>(src, width * 4, dst, width * 4, width, height);
+ * chain.dither<BGRA8>(src, width * 4, width, height, colormap, indices, options);
+ * </pre>
+ */
+class FilterChain {
+public:
+	/**
+	 * Pixels per tile: 4 planes plus 3 scratch planes of floats come to
+	 * 56 KB, which leaves room in a 256 KB L2 cache for source and
+	 * destination rows.
+	 */
+	static const size_t TILE = 2048;
+
+	FilterChain* addMatrix(const ColorMatrix& matrix);
+	FilterChain* addHSV(const HSVFilter& filter);
+	FilterChain* addGradientMap(const ColorGradient& gradient, int size = 256);
+	FilterChain* addFunction(const FilterFunction& function);
+	FilterChain* clear();
+	size_t getStageCount() const;
+	FilterStageType getStageType(size_t index) const;
+
+	void runTile(float* const* planes, float* const* scratch, size_t count) const;
+
+	/**
+	 * Runs the chain over an image.
+	 * 
+	 * @param src
+	 *            source pixels
+	 * @param srcStride
+	 *            bytes between two source rows
+	 * @param dst
+	 *            result pixels; may be src if both formats are the same
+	 * @param dstStride
+	 *            bytes between two result rows
+	 * @param width
+	 *            pixels per row
+	 * @param height
+	 *            number of rows
+	 * @param threads
+	 *            0 for one thread per core
+	 */
+	template<typename Src, typename Dst>
+	void run(const typename Src::Scalar* src, size_t srcStride, typename Dst::Scalar* dst, size_t dstStride,
+			size_t width, size_t height, unsigned threads = 0) const
+	{
+		static_assert(!Dst::PLANAR, "FilterChain needs interleaved pixels");
+		typedef typename Dst::Scalar D;
+		forTiles<Src>(src, srcStride, width, height, threads, [&](float* const* planes, size_t x, size_t y, size_t n) {
+			D* q = (D*) ((char*) dst + y * dstStride) + x * Dst::CHANNELS;
+			for (size_t i = 0; i < n; i++) {
+				q[i * Dst::CHANNELS + Dst::RED] = ChannelTraits<D>::fromFloat(planes[0][i]);
+				q[i * Dst::CHANNELS + Dst::GREEN] = ChannelTraits<D>::fromFloat(planes[1][i]);
+				q[i * Dst::CHANNELS + Dst::BLUE] = ChannelTraits<D>::fromFloat(planes[2][i]);
+				if (Dst::HAS_ALPHA) {
+					q[i * Dst::CHANNELS + (Dst::ALPHA < 0 ? 0 : Dst::ALPHA)] = ChannelTraits<D>::fromFloat(planes[3][i]);
+				}
+			}
+		});
+	}
+
+	/**
+	 * Runs the chain and dithers the result to a palette. Ordered dithering
+	 * (and DITHER_NONE) is fused as the last stage of each tile. Error
+	 * diffusion has to see pixels in scan order, so for those methods the
+	 * chain output goes through one RGBAF intermediate image first.
+	 * 
+	 * @param src
+	 *            source pixels
+	 * @param srcStride
+	 *            bytes between two source rows
+	 * @param width
+	 *            pixels per row
+	 * @param height
+	 *            number of rows
+	 * @param map
+	 *            colormap built for the target palette
+	 * @param indices
+	 *            result, width * height palette indices
+	 * @param options
+	 *            dithering method and parameters
+	 */
+	template<typename Src, typename Index>
+	void dither(const typename Src::Scalar* src, size_t srcStride, size_t width, size_t height,
+			const InverseColormap& map, Index* indices, const DitherOptions& options = DitherOptions()) const
+	{
+		static_assert(!Src::PLANAR, "FilterChain needs interleaved pixels");
+		if (options.method == DITHER_FLOYD_STEINBERG || options.method == DITHER_ATKINSON) {
+			vector<float> image(width * height * 4);
+			run<Src, RGBAF>(src, srcStride, &image[0], width * 4 * sizeof(float), width, height, options.threads);
+			Dither::apply<RGBAF>(&image[0], width, height, width * 4 * sizeof(float), map, indices, options);
+			return;
+		}
+		int mask = 0, shift = 0;
+		const float* thresholds = NULL;
+		if (options.method == DITHER_BAYER) {
+			thresholds = Dither::getBayer();
+			mask = 7;
+			shift = 3;
+		}
+		else if (options.method == DITHER_BLUE_NOISE) {
+			thresholds = Dither::getBlueNoise();
+			mask = 63;
+			shift = 6;
+		}
+		float spread = options.spread > 0 ? options.spread : Dither::getAutoSpread(map.getPaletteSize());
+		forTiles<Src>(src, srcStride, width, height, options.threads, [&](float* const* planes, size_t x, size_t y, size_t n) {
+			Index* out = indices + y * width + x;
+			const float* t = thresholds ? thresholds + ((y & mask) << shift) : NULL;
+			for (size_t i = 0; i < n; i++) {
+				float offset = t ? (t[(x + i) & mask] - 0.5f) * spread : 0;
+				out[i] = (Index) map.lookup(quantize(planes[0][i], offset), quantize(planes[1][i], offset), quantize(planes[2][i], offset));
+			}
+		});
+	}
+
+private:
+	static int quantize(float v, float offset) {
+		v = v * 255 + offset;
+		return (int) ((v < 0 ? 0 : (v > 255 ? 255 : v)) + 0.5f);
+	}
+
+	/**
+	 * Loads the image tile by tile, runs the stages and hands each tile to
+	 * sink(planes, x, y, count). Tiles never span rows.
+	 */
+	template<typename Src, typename Sink>
+	void forTiles(const typename Src::Scalar* src, size_t srcStride, size_t width, size_t height, unsigned threads, Sink sink) const
+	{
+		static_assert(!Src::PLANAR, "FilterChain needs interleaved pixels");
+		typedef typename Src::Scalar S;
+		size_t tilesPerRow = (width + TILE - 1) / TILE;
+		Parallel::forChunks(tilesPerRow * height, 16, threads, [&](size_t first, size_t last) {
+			vector<float> buffer(TILE * 7);
+			float* planes[4] = { &buffer[0], &buffer[TILE], &buffer[TILE * 2], &buffer[TILE * 3] };
+			float* scratch[3] = { &buffer[TILE * 4], &buffer[TILE * 5], &buffer[TILE * 6] };
+			for (size_t tile = first; tile < last; tile++) {
+				size_t y = tile / tilesPerRow;
+				size_t x = (tile % tilesPerRow) * TILE;
+				size_t n = width - x < TILE ? width - x : TILE;
+				const S* p = (const S*) ((const char*) src + y * srcStride) + x * Src::CHANNELS;
+				for (size_t i = 0; i < n; i++) {
+					planes[0][i] = ChannelTraits<S>::toFloat(p[i * Src::CHANNELS + Src::RED]);
+					planes[1][i] = ChannelTraits<S>::toFloat(p[i * Src::CHANNELS + Src::GREEN]);
+					planes[2][i] = ChannelTraits<S>::toFloat(p[i * Src::CHANNELS + Src::BLUE]);
+					planes[3][i] = Src::HAS_ALPHA ? ChannelTraits<S>::toFloat(p[i * Src::CHANNELS + (Src::ALPHA < 0 ? 0 : Src::ALPHA)]) : 1;
+				}
+				runTile(planes, scratch, n);
+				sink(planes, x, y, n);
+			}
+		});
+	}
+
+	struct Stage {
+		FilterStageType type;
+		ColorMatrix matrix;
+		HSVFilter hsv;
+		int rampSize;
+		vector<float> ramp;		// 4 planes of rampSize + 1 entries, as ColorGradient
+		FilterFunction function;
+	};
+
+	vector<Stage> stages;
+};
\ No newline at end of file
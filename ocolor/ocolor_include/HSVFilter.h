@@ -0,0 +1,135 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include "Parallel.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+enum HSVOperation {
+	HSV_LIGHTEN, HSV_DARKEN, HSV_SATURATE, HSV_DESATURATE, HSV_SET_HUE, HSV_ADJUST, HSV_ADJUST_CONTRAST
+};
+
+/**
+ * The OColor HSV adjustments (lighten(), darken(), saturate(),
+ * desaturate(), setHue(), adjustHSV(), adjustContrast()) as a filter for
+ * whole pixel buffers. Steps are recorded in order and applied with the
+ * same clipping and hue wrapping as the OColor methods, so a pixel comes
+ * out as if an OColor had been built from it and the same calls made.
+ * 
+ * Pixels are processed in blocks: the block is converted to planar HSV,
+ * every step runs over it and it is converted back, with branch-free SSE2
+ * kernels for the conversions. Blocks are spread over threads.
+ * 
+ * <pre>
+ * HSVFilter filter;
+ * filter.saturate(0.2f)->adjustHSV(0.05f, 0, 0)->adjustContrast(0.1f);
+ * filter.apply<BGRA8>(pixels, pixels, width * height);
+ * </pre>
+ */
+class HSVFilter {
+public:
+	static const int BLOCK = 256;
+
+	HSVFilter* lighten(float step);
+	HSVFilter* darken(float step);
+	HSVFilter* saturate(float step);
+	HSVFilter* desaturate(float step);
+	HSVFilter* setHue(float hue);
+	HSVFilter* adjustHSV(float h, float s, float v);
+	HSVFilter* adjustContrast(float amount);
+	HSVFilter* append(const HSVFilter& other);
+	HSVFilter* clear();
+	size_t getStepCount() const;
+
+	void applyHSV(float* h, float* s, float* v, size_t count) const;
+	static void rgbToHSV(const float* r, const float* g, const float* b, float* h, float* s, float* v, size_t count);
+	static void hsvToRGB(const float* h, const float* s, const float* v, float* r, float* g, float* b, size_t count);
+
+	/**
+	 * Filters pixels of any interleaved PixelFormat; src and dst may be the
+	 * same buffer. Alpha is copied unchanged.
+	 * 
+	 * @param src
+	 *            source pixels
+	 * @param dst
+	 *            result pixels
+	 * @param count
+	 *            number of pixels
+	 * @param threads
+	 *            0 for one thread per core
+	 */
+	template<typename Fmt>
+	void apply(const typename Fmt::Scalar* src, typename Fmt::Scalar* dst, size_t count, unsigned threads = 0) const
+	{
+		static_assert(!Fmt::PLANAR, "HSVFilter needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		Parallel::forChunks(count, BLOCK * 64, threads, [&](size_t first, size_t last) {
+			float planes[6][BLOCK];
+			for (size_t begin = first; begin < last; begin += BLOCK) {
+				size_t n = last - begin < (size_t) BLOCK ? last - begin : (size_t) BLOCK;
+				const S* p = src + begin * Fmt::CHANNELS;
+				for (size_t i = 0; i < n; i++) {
+					planes[0][i] = ChannelTraits<S>::toFloat(p[i * Fmt::CHANNELS + Fmt::RED]);
+					planes[1][i] = ChannelTraits<S>::toFloat(p[i * Fmt::CHANNELS + Fmt::GREEN]);
+					planes[2][i] = ChannelTraits<S>::toFloat(p[i * Fmt::CHANNELS + Fmt::BLUE]);
+				}
+				rgbToHSV(planes[0], planes[1], planes[2], planes[3], planes[4], planes[5], n);
+				applyHSV(planes[3], planes[4], planes[5], n);
+				hsvToRGB(planes[3], planes[4], planes[5], planes[0], planes[1], planes[2], n);
+				S* q = dst + begin * Fmt::CHANNELS;
+				for (size_t i = 0; i < n; i++) {
+					q[i * Fmt::CHANNELS + Fmt::RED] = ChannelTraits<S>::fromFloat(planes[0][i]);
+					q[i * Fmt::CHANNELS + Fmt::GREEN] = ChannelTraits<S>::fromFloat(planes[1][i]);
+					q[i * Fmt::CHANNELS + Fmt::BLUE] = ChannelTraits<S>::fromFloat(planes[2][i]);
+					if (Fmt::HAS_ALPHA) {
+						q[i * Fmt::CHANNELS + (Fmt::ALPHA < 0 ? 0 : Fmt::ALPHA)] = p[i * Fmt::CHANNELS + (Fmt::ALPHA < 0 ? 0 : Fmt::ALPHA)];
+					}
+				}
+			}
+		});
+	}
+
+private:
+	HSVFilter* add(HSVOperation operation, float h, float s, float v);
+
+	struct Step {
+		HSVOperation operation;
+		float h, s, v;
+	};
+
+	vector<Step> steps;
+};
\ No newline at end of file
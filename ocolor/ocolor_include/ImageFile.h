@@ -0,0 +1,212 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "PixelFormat.h"
+#include <cstddef>
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * File types understood by MappedImageReader and MappedImageWriter. Only
+ * the binary Netpbm variants are supported.
+ */
+enum ImageFileType {
+	IMAGE_PGM,	// P5
+	IMAGE_PPM,	// P6
+	IMAGE_PAM,	// P7
+	IMAGE_RAW	// headerless, interleaved
+};
+
+/**
+ * Layout of an image file: dimensions, samples per pixel and where the
+ * pixel rows start. Netpbm files with maxval > 255 store 16 bit samples in
+ * big-endian order; raw files are always native order.
+ */
+struct ImageHeader {
+	ImageHeader();
+
+	ImageFileType type;
+	int width;
+	int height;
+	int depth;
+	int maxval;
+	bool bigEndian;
+	string tupleType;
+	long long dataOffset;
+
+	int bytesPerSample() const { return maxval > 255 ? 2 : 1; }
+	size_t rowBytes() const { return (size_t) width * depth * bytesPerSample(); }
+};
+
+/**
+ * Reads PGM/PPM/PAM or headerless raw images through memory-mapped row
+ * bands. Only the band that is currently requested is mapped, so images
+ * larger than physical memory are processed in bounded RAM, and the
+ * returned rows point straight into the page cache without a copy.
+ * 
+ * <pre>
+ * MappedImageReader in;
+ * in.open("frame.pam");
+ * for (int y = 0; y < in.getHeader().height; y += 64) {
+ *     const unsigned char* rows = in.mapRows(y, 64);
+ *     ...
+ * }
+ * </pre>
+ */
+class MappedImageReader {
+public:
+	MappedImageReader();
+	~MappedImageReader();
+
+	bool open(const char* path);
+	bool openRaw(const char* path, int width, int height, int depth, int bytesPerSample);
+	const ImageHeader& getHeader() const;
+	const unsigned char* mapRows(int firstRow, int rowCount);
+	void close();
+
+private:
+	MappedImageReader(const MappedImageReader&);
+	MappedImageReader& operator=(const MappedImageReader&);
+
+	bool openFile(const char* path);
+	bool parseHeader();
+	void unmap();
+
+	ImageHeader header;
+	long long fileSize;
+	intptr_t file;
+	intptr_t mapping;
+	void* view;
+	size_t viewLength;
+};
+
+/**
+ * Writes PGM/PPM/PAM or headerless raw images through memory-mapped row
+ * bands. The file is created at its final size up front; rows are written
+ * by filling the band returned from mapRows(), and the OS writes them back
+ * as bands are released.
+ */
+class MappedImageWriter {
+public:
+	MappedImageWriter();
+	~MappedImageWriter();
+
+	bool create(const char* path, ImageFileType type, int width, int height, int depth, int maxval);
+	const ImageHeader& getHeader() const;
+	unsigned char* mapRows(int firstRow, int rowCount);
+	void close();
+
+private:
+	MappedImageWriter(const MappedImageWriter&);
+	MappedImageWriter& operator=(const MappedImageWriter&);
+
+	void unmap();
+
+	ImageHeader header;
+	intptr_t file;
+	intptr_t mapping;
+	void* view;
+	size_t viewLength;
+};
+
+/**
+ * Drives a reader/writer pair band by band. At most one input band and one
+ * output band are mapped at any time.
+ */
+class ImageStream {
+public:
+	/**
+	 * Calls fn(src, dst, rowCount, inHeader, outHeader) for every band of
+	 * bandRows rows. Both images must have the same height.
+	 * 
+	 * @param in
+	 * @param out
+	 * @param bandRows
+	 * @param fn
+	 * @return false if a band could not be mapped
+	 */
+	template<typename Fn>
+	static bool process(MappedImageReader& in, MappedImageWriter& out, int bandRows, Fn fn)
+	{
+		const ImageHeader& ih = in.getHeader();
+		const ImageHeader& oh = out.getHeader();
+		if (ih.height != oh.height || bandRows <= 0) {
+			return false;
+		}
+		for (int y = 0; y < ih.height; y += bandRows) {
+			int rows = (ih.height - y) < bandRows ? (ih.height - y) : bandRows;
+			const unsigned char* src = in.mapRows(y, rows);
+			unsigned char* dst = out.mapRows(y, rows);
+			if (src == NULL || dst == NULL) {
+				return false;
+			}
+			fn(src, dst, rows, ih, oh);
+		}
+		return true;
+	}
+
+	/**
+	 * Converts a whole image between two pixel formats, feeding each mapped
+	 * band directly to PixelConverter. Sample order must be native, so
+	 * 16 bit Netpbm input has to go through process() and swap bytes.
+	 * 
+	 * @param in
+	 * @param out
+	 * @param bandRows
+	 * @return false on size/format mismatch or mapping failure
+	 */
+	template<typename Src, typename Dst>
+	static bool convert(MappedImageReader& in, MappedImageWriter& out, int bandRows)
+	{
+		const ImageHeader& ih = in.getHeader();
+		const ImageHeader& oh = out.getHeader();
+		if (ih.width != oh.width || ih.depth != Src::CHANNELS || oh.depth != Dst::CHANNELS ||
+			ih.bytesPerSample() != (int) sizeof(typename Src::Scalar) ||
+			oh.bytesPerSample() != (int) sizeof(typename Dst::Scalar) ||
+			(ih.bigEndian && ih.bytesPerSample() > 1) || (oh.bigEndian && oh.bytesPerSample() > 1)) {
+			return false;
+		}
+		return process(in, out, bandRows, ConvertBand<Src, Dst>());
+	}
+
+private:
+	template<typename Src, typename Dst>
+	struct ConvertBand {
+		void operator()(const unsigned char* src, unsigned char* dst, int rows, const ImageHeader& ih, const ImageHeader&) const {
+			PixelConverter<Src, Dst>::convert((const typename Src::Scalar*) src,
+											  (typename Dst::Scalar*) dst, (size_t) ih.width * rows);
+		}
+	};
+};
\ No newline at end of file
@@ -0,0 +1,192 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include "Parallel.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Statistics of one image, see ImageStatistics::compute().
+ */
+struct ImageStats {
+	static const int HUE_BINS = 12;
+	static const int LUMINANCE_BINS = 256;
+
+	size_t pixelCount;
+
+	/**
+	 * Non grey pixels per closest named hue, in the order of
+	 * ImageStatistics::getHueBin(): red, orange, yellow, lime, green, teal,
+	 * cyan, azure, blue, indigo, purple, pink.
+	 */
+	size_t hueHistogram[HUE_BINS];
+
+	/**
+	 * Pixels per luminance (OColor::getLuminance()) bin of 1/256.
+	 */
+	size_t luminanceHistogram[LUMINANCE_BINS];
+
+	float mean[3];
+	float variance[3];
+	float meanLuminance;
+	float varianceLuminance;
+
+	size_t greyCount;	// OColor::isGrey()
+	size_t blackCount;	// OColor::isBlack()
+	size_t whiteCount;	// OColor::isWhite()
+};
+
+/**
+ * Partial sums of one chunk of pixels. Every chunk owns its accumulator,
+ * so threads never share state while scanning and the partials are merged
+ * once all threads are done.
+ */
+struct ImageStatsAccumulator {
+	size_t count;
+	size_t hue[ImageStats::HUE_BINS];
+	size_t luminance[ImageStats::LUMINANCE_BINS];
+	double sum[4];
+	double sumSquares[4];
+	size_t grey;
+	size_t black;
+	size_t white;
+
+	ImageStatsAccumulator();
+	void add(float r, float g, float b);
+	void merge(const ImageStatsAccumulator& other);
+	ImageStats finish() const;
+};
+
+/**
+ * Computes the per pixel OColor classifications (luminance, closest hue,
+ * isGrey(), isBlack(), isWhite()) and channel moments of a whole buffer in
+ * one pass, without constructing an OColor per pixel.
+ * 
+ * <pre>
+ * ImageStats stats = ImageStatistics::compute<RGBA8>(pixels, width * height);
+ * </pre>
+ */
+class ImageStatistics {
+public:
+	/**
+	 * Minimum number of pixels scanned by one thread at a time.
+	 */
+	static const size_t CHUNK = 65536;
+
+	static Hue getHueBin(int bin);
+
+	/**
+	 * @param pixels
+	 *            interleaved pixels of the given PixelFormat
+	 * @param count
+	 *            number of pixels
+	 * @param threads
+	 *            0 for one thread per core
+	 * @return statistics; alpha is ignored
+	 */
+	template<typename Fmt>
+	static ImageStats compute(const typename Fmt::Scalar* pixels, size_t count, unsigned threads = 0)
+	{
+		static_assert(!Fmt::PLANAR, "ImageStatistics needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		size_t chunk = count / (Parallel::getThreadCount(threads) * 4) + 1;
+		chunk = chunk < CHUNK ? CHUNK : chunk;
+		vector<ImageStatsAccumulator> partials((count + chunk - 1) / chunk);
+
+		Parallel::forChunks(count, chunk, threads, [&](size_t begin, size_t end) {
+			ImageStatsAccumulator& acc = partials[begin / chunk];
+			for (size_t i = begin; i < end; i++) {
+				const S* p = pixels + i * Fmt::CHANNELS;
+				acc.add(ChannelTraits<S>::toFloat(p[Fmt::RED]), ChannelTraits<S>::toFloat(p[Fmt::GREEN]), ChannelTraits<S>::toFloat(p[Fmt::BLUE]));
+			}
+		});
+
+		ImageStatsAccumulator total;
+		for (size_t i = 0; i < partials.size(); i++) {
+			total.merge(partials[i]);
+		}
+		return total.finish();
+	}
+};
+
+/**
+ * Adds one pixel. Inline so the scan loop of compute() needs no calls.
+ * 
+ * @param r
+ * @param g
+ * @param b
+ */
+inline void ImageStatsAccumulator::add(float r, float g, float b)
+{
+	float v = (r > g) ? ((r > b) ? r : b) : ((g > b) ? g : b);
+	float d = v - ((r < g) ? ((r < b) ? r : b) : ((g < b) ? g : b));
+	float s = v != 0 ? d / v : 0;
+	float l = r * 0.299f + g * 0.587f + b * 0.114f;
+	bool neutral = fabs(r - g) <= .000001 && fabs(g - b) <= .000001;
+
+	count++;
+	int bin = (int) (l * ImageStats::LUMINANCE_BINS);
+	luminance[bin < 0 ? 0 : (bin > ImageStats::LUMINANCE_BINS - 1 ? ImageStats::LUMINANCE_BINS - 1 : bin)]++;
+	sum[0] += r;
+	sum[1] += g;
+	sum[2] += b;
+	sum[3] += l;
+	sumSquares[0] += r * r;
+	sumSquares[1] += g * g;
+	sumSquares[2] += b * b;
+	sumSquares[3] += l * l;
+	black += (neutral && r <= OColor::BLACK_POINT) ? 1 : 0;
+	white += (neutral && r >= OColor::WHITE_POINT) ? 1 : 0;
+
+	if (s < OColor::GREY_THRESHOLD) {
+		grey++;
+		return;
+	}
+	// same hue as OColor::rgbToHSV(); named hues are 30 degrees apart, ties
+	// go to the following hue
+	float h;
+	if (fabs(r - v) < 0.0000001) {
+		h = (g - b) / d;
+	} else if (fabs(g - v) < 0.0000001) {
+		h = 2 + (b - r) / d;
+	} else {
+		h = 4 + (r - g) / d;
+	}
+	h *= OColor::INV60DEGREES;
+	h = h < 0 ? h + 1 : h;
+	hue[(int) (h * ImageStats::HUE_BINS + 0.5f) % ImageStats::HUE_BINS]++;
+}
\ No newline at end of file
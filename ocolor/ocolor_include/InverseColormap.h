@@ -0,0 +1,161 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include "Parallel.h"
+#include <vector>
+#include <cstddef>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+/**
+ * Inverse colormap: a grid over 8 bit RGB that stores the nearest palette
+ * entry (by OColor::distanceToRGB()) of every cell, so mapping a pixel to
+ * its palette index is a table lookup instead of a palette search.
+ * 
+ * In exact mode (the default) build() also finds the cells that contain a
+ * boundary between palette entries. Such cells are split in eight parts;
+ * each part stores its nearest entry or, if it still contains a boundary,
+ * a short list of the entries that can be nearest there, and lookups in
+ * those parts compare only the listed entries. Results always equal a
+ * full search. getAmbiguousRatio() reports how much of the grid needs the
+ * comparison. In approximate mode every cell stores the entry nearest to
+ * its centre.
+ * 
+ * <pre>
+ * InverseColormap map;
+ * map.build(palette, 5);
+ * map.map<BGRA8>(pixels, width * height, indices);
+ * </pre>
+ */
+class InverseColormap {
+public:
+	InverseColormap();
+	bool build(const vector<OColor>& palette, int bits = 5, bool exact = true, unsigned threads = 0);
+	int getBits() const;
+	size_t getPaletteSize() const;
+	float getAmbiguousRatio() const;
+	const float* getColors() const;
+
+	/**
+	 * @param r
+	 *            0..255
+	 * @param g
+	 *            0..255
+	 * @param b
+	 *            0..255
+	 * @return index of the nearest palette entry
+	 */
+	int lookup(int r, int g, int b) const {
+		unsigned int entry = table[cellIndex(r, g, b)];
+		return (entry & AMBIGUOUS) ? search(entry & ~AMBIGUOUS, r, g, b) : (int) entry;
+	}
+
+	/**
+	 * Maps pixels to palette indices. 8 bit RGBA layouts are processed
+	 * 8 pixels at a time with AVX2 gathers when the compiler targets AVX2.
+	 * 
+	 * @param pixels
+	 *            interleaved pixels of the given PixelFormat
+	 * @param count
+	 *            number of pixels
+	 * @param indices
+	 *            result array of count indices; unsigned char is enough for
+	 *            palettes of up to 256 colors
+	 * @param threads
+	 *            0 for one thread per core
+	 */
+	template<typename Fmt, typename Index>
+	void map(const typename Fmt::Scalar* pixels, size_t count, Index* indices, unsigned threads = 0) const
+	{
+		static_assert(!Fmt::PLANAR, "InverseColormap needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		Parallel::forChunks(count, 65536, threads, [&](size_t begin, size_t end) {
+			size_t i = begin;
+#if defined(__AVX2__)
+			if (sizeof(S) == 1 && Fmt::CHANNELS == 4) {
+				// as cellIndex(): shift each channel down to its top bits, then
+				// into place, so no shift count goes negative for bits < 4
+				const int shift = 8 - bits;
+				const __m256i mask = _mm256_set1_epi32((1 << bits) - 1);
+				for (; i + 8 <= end; i += 8) {
+					__m256i p = _mm256_loadu_si256((const __m256i*) (pixels + i * 4));
+					__m256i r = _mm256_and_si256(_mm256_srli_epi32(p, 8 * Fmt::RED + shift), mask);
+					__m256i g = _mm256_and_si256(_mm256_srli_epi32(p, 8 * Fmt::GREEN + shift), mask);
+					__m256i b = _mm256_and_si256(_mm256_srli_epi32(p, 8 * Fmt::BLUE + shift), mask);
+					__m256i cell = _mm256_or_si256(_mm256_or_si256(
+							_mm256_slli_epi32(r, 2 * bits), _mm256_slli_epi32(g, bits)), b);
+					__m256i entry = _mm256_i32gather_epi32((const int*) &table[0], cell, 4);
+					int ambiguous = _mm256_movemask_ps(_mm256_castsi256_ps(entry));
+					unsigned int lanes[8];
+					_mm256_storeu_si256((__m256i*) lanes, entry);
+					for (int l = 0; l < 8; l++) {
+						if (ambiguous & (1 << l)) {
+							const S* q = pixels + (i + l) * 4;
+							lanes[l] = search(lanes[l] & ~AMBIGUOUS, q[Fmt::RED], q[Fmt::GREEN], q[Fmt::BLUE]);
+						}
+						indices[i + l] = (Index) lanes[l];
+					}
+				}
+			}
+#endif
+			for (; i < end; i++) {
+				const S* p = pixels + i * Fmt::CHANNELS;
+				indices[i] = (Index) lookup(ChannelConverter<S, unsigned char>::convert(p[Fmt::RED]),
+											ChannelConverter<S, unsigned char>::convert(p[Fmt::GREEN]),
+											ChannelConverter<S, unsigned char>::convert(p[Fmt::BLUE]));
+			}
+		});
+	}
+
+private:
+	static const unsigned int AMBIGUOUS = 0x80000000u;
+
+	int cellIndex(int r, int g, int b) const {
+		int shift = 8 - bits;
+		return ((r >> shift) << (2 * bits)) | ((g >> shift) << bits) | (b >> shift);
+	}
+
+	int search(unsigned int offset, int r, int g, int b) const;
+
+	int bits;
+	vector<float> colors;				// palette as 0..255 RGB triplets
+	vector<unsigned int> table;			// palette index, or AMBIGUOUS | offset into subcells
+	vector<unsigned int> subcells;		// per boundary cell: 8 parts, each a palette index or AMBIGUOUS | offset into candidates
+	vector<unsigned short> candidates;	// per ambiguous part: count, then palette indices
+	size_t ambiguousParts;
+};
\ No newline at end of file
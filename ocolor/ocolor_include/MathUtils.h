@@ -32,6 +32,7 @@
 #pragma once
 
 #include "math.h"
+#include <string.h>
 
 /**
  * Miscellaneous math utilities.
@@ -159,6 +160,79 @@ public:
 		return radians * RAD2DEG;
 	}
 
+	/**
+	 * Polynomial arc tangent of y/x with a maximum error of about 1E-5
+	 * radians. Branches only select between values, so loops calling it
+	 * can be vectorized.
+	 * 
+	 * @param y
+	 * @param x
+	 * @return angle in radians, -PI .. PI
+	 */
+	static float fastAtan2(float y, float x) {
+		float ax = x < 0 ? -x : x;
+		float ay = y < 0 ? -y : y;
+		float mx = ax > ay ? ax : ay;
+		float mn = ax > ay ? ay : ax;
+		float z = mn / (mx + 1E-30f);
+		float z2 = z * z;
+		float r = z * (0.99997726f + z2 * (-0.33262347f + z2 * (0.19354346f + z2 * (-0.11643287f + z2 * (0.05265332f + z2 * -0.01172120f)))));
+		r = ay > ax ? 1.57079633f - r : r;
+		r = x < 0 ? 3.14159265f - r : r;
+		return y < 0 ? -r : r;
+	}
+
+	/**
+	 * Cube root accurate to about 2E-6 relative error. Uses an exponent bit
+	 * estimate refined by two Newton steps, which is several times cheaper
+	 * than pow(x, 1/3.0) and also handles negative input.
+	 * 
+	 * @param x
+	 * @return cube root of x
+	 */
+	static float fastCbrt(float x) {
+		float a = x < 0 ? -x : x;
+		if (a < 1E-30f) {
+			return 0;
+		}
+		unsigned int bits;
+		memcpy(&bits, &a, sizeof(bits));
+		bits = bits / 3 + 709921077;
+		float y;
+		memcpy(&y, &bits, sizeof(y));
+		y = (2 * y + a / (y * y)) * (1 / 3.0f);
+		y = (2 * y + a / (y * y)) * (1 / 3.0f);
+		return x < 0 ? -y : y;
+	}
+
+	/**
+	 * Polynomial cosine with a maximum error of about 1E-6 for any
+	 * argument within a few turns of 0.
+	 * 
+	 * @param x
+	 *            angle in radians
+	 * @return cosine of x
+	 */
+	static float fastCos(float x) {
+		x = x - 6.28318531f * ::floor(x * 0.15915494f + 0.5f);
+		x = x < 0 ? -x : x;
+		float sign = x > 1.57079633f ? -1.0f : 1.0f;
+		x = x > 1.57079633f ? 3.14159265f - x : x;
+		float x2 = x * x;
+		return sign * (1 + x2 * (-0.5f + x2 * (1 / 24.0f + x2 * (-1 / 720.0f + x2 * (1 / 40320.0f + x2 * (-1 / 3628800.0f))))));
+	}
+
+	/**
+	 * Polynomial sine, see fastCos().
+	 * 
+	 * @param x
+	 *            angle in radians
+	 * @return sine of x
+	 */
+	static float fastSin(float x) {
+		return fastCos(x - 1.57079633f);
+	}
+
 	/**
 	 * Find the floor of a value.
 	 * 
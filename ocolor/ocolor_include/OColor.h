@@ -49,6 +49,25 @@
 // DONE refactor params that reference static fields or class methods (eg. 'blue')
 
 using namespace std;
+
+/**
+ * Luma/chroma weightings for YCbCr conversions.
+ * 
+ * @see OColor#rgbToYCbCr()
+ */
+enum YCbCrStandard {
+	YCBCR_BT601,
+	YCBCR_BT709,
+	YCBCR_BT2020
+};
+
+/**
+ * Color difference formulas for OColor::distanceToLab() and DeltaE.
+ */
+enum DeltaEMetric { DELTA_E_76, DELTA_E_94, DELTA_E_2000 };
+
+template<typename Prev = void, typename Op = void> class ColorOps;
+
 /**
  * Floating point color class with implicit RGB, HSV, CMYK access modes,
  * conversion and color theory utils. Based on Toxi's <a href="">TColor</a> class 
@@ -131,16 +150,31 @@ public:
      * @param y
      * @param k
 	 * @param rgb
-     * @return rgb vector
+     *            result array of 3 floats
      */
-	static vector<float> cmykToRGB(float c, float m, float y, float k, vector<float> rgb) 
+	static void cmykToRGB(float c, float m, float y, float k, float* rgb)
 	{
 		float _red   = (c+k);
-		float _blue  = (m+k);
-		float _green = (y+k);
-		rgb[0] = (1.0 < (_red)  ? 1.0 : (_red));
-		rgb[1] = (1.0 < (_blue) ? 1.0 : (_blue));
-		rgb[2] = (1.0 < (_green)? 1.0 : (_green));
+		float _green = (m+k);
+		float _blue  = (y+k);
+		rgb[0] = 1 - (1.0 < (_red)   ? 1.0 : (_red));
+		rgb[1] = 1 - (1.0 < (_green) ? 1.0 : (_green));
+		rgb[2] = 1 - (1.0 < (_blue)  ? 1.0 : (_blue));
+	}
+
+	/**
+     * Converts CMYK floats into an RGB vector.
+     * 
+     * @param c
+     * @param m
+     * @param y
+     * @param k
+	 * @param rgb
+     * @return rgb vector
+     */
+	static vector<float> cmykToRGB(float c, float m, float y, float k, vector<float> rgb)
+	{
+		cmykToRGB(c, m, y, k, &rgb[0]);
 		return rgb;
 	}
 
@@ -152,16 +186,30 @@ public:
      * @param y
      * @param k
      * @param bgr
+     *            result array of 3 floats
+     */
+	static void cmykToBGR(float c, float m, float y, float k, float* bgr)
+	{
+		float rgb[3];
+		cmykToRGB(c, m, y, k, rgb);
+		bgr[0] = rgb[2];
+		bgr[1] = rgb[1];
+		bgr[2] = rgb[0];
+	}
+
+	/**
+     * Converts CMYK floats into the given RGB vector.
+     * 
+     * @param c
+     * @param m
+     * @param y
+     * @param k
+     * @param bgr
      * @return bgr vector
      */
 	static vector<float> cmykToBGR(float c, float m, float y, float k, vector<float> bgr)
 	{
-		float _blue  = (m+k);
-		float _green = (y+k);
-		float _red   = (c+k);
-		bgr[0] = (1.0 < (_blue)  ? 1.0 : _blue);
-		bgr[1] = (1.0 < (_green) ? 1.0 : _green);
-		bgr[3] = (1.0 < (_red)   ? 1.0 : _red);
+		cmykToBGR(c, m, y, k, &bgr[0]);
 		return bgr;
 	}
 
@@ -205,9 +253,9 @@ public:
      * 
      * @param hexString
 	 * @param rgb
-     * @return rgb vector
+     *            result array of 3 floats
      */
-	static vector<float> hexToRGB(const char* hexString, vector<float> rgb)
+	static void hexToRGB(const char* hexString, float* rgb)
 	{
 		char * pEnd;
 		int hexInt;
@@ -216,7 +264,18 @@ public:
 		rgb[0] = ( (hexInt >> 16) &0xFF ) * INV8BIT;
 		rgb[1] = ( (hexInt >> 8 ) &0xFF ) * INV8BIT;
 		rgb[2] = ( (hexInt      ) &0xFF ) * INV8BIT;
+	}
 
+	/**
+     * Converts hex string into a RGB vector.
+     * 
+     * @param hexString
+	 * @param rgb
+     * @return rgb vector
+     */
+	static vector<float> hexToRGB(const char* hexString, vector<float> rgb)
+	{
+		hexToRGB(hexString, &rgb[0]);
 		return rgb;
 	}
 	
@@ -225,9 +284,9 @@ public:
      * 
      * @param hexString
 	 * @param bgr
-     * @return bgr vector
+     *            result array of 3 floats
      */
-	static vector<float> hexToBGR(const char* hexString, vector<float> bgr)
+	static void hexToBGR(const char* hexString, float* bgr)
 	{
 		char* pEnd;
 		int hexInt;
@@ -235,6 +294,18 @@ public:
 		bgr[0] = ( (hexInt      )  &0xFF ) * INV8BIT;
 		bgr[1] = ( (hexInt >> 8 )  &0xFF ) * INV8BIT;
 		bgr[2] = ( (hexInt >> 16)  &0xFF ) * INV8BIT;
+	}
+
+	/**
+     * Converts hex string into a BGR vector.
+     * 
+     * @param hexString
+	 * @param bgr
+     * @return bgr vector
+     */
+	static vector<float> hexToBGR(const char* hexString, vector<float> bgr)
+	{
+		hexToBGR(hexString, &bgr[0]);
 		return bgr;
 	}
 
@@ -271,9 +342,9 @@ public:
      * @param s
      * @param v
 	 * @param rgb
-     * @return rgb vector
+     *            result array of 3 floats
      */
-	static vector<float> hsvToRGB(float h, float s, float v, vector<float> rgb)
+	static void hsvToRGB(float h, float s, float v, float* rgb)
 	{
 		if (fabs(s - 0) < 0.0000001) {
 			rgb[0] = rgb[1] = rgb[2] = v;
@@ -310,6 +381,20 @@ public:
 				rgb[2] = q;
 			}
 		}
+	}
+
+	/**
+     * Converts HSV values into RGB vector.
+     * 
+     * @param h
+     * @param s
+     * @param v
+	 * @param rgb
+     * @return rgb vector
+     */
+	static vector<float> hsvToRGB(float h, float s, float v, vector<float> rgb)
+	{
+		hsvToRGB(h, s, v, &rgb[0]);
 		return rgb;
 	}
 
@@ -318,47 +403,31 @@ public:
      * 
      * @param h
      * @param s
+     * @param v
+	 * @param bgr
+     *            result array of 3 floats
+     */
+	static void hsvToBGR(float h, float s, float v, float* bgr)
+	{
+		float rgb[3];
+		hsvToRGB(h, s, v, rgb);
+		bgr[0] = rgb[2];
+		bgr[1] = rgb[1];
+		bgr[2] = rgb[0];
+	}
+
+	/**
+     * Converts HSV values into BGR vector.
+     * 
+     * @param h
+     * @param s
      * @param v
 	 * @param bgr
      * @return bgr vector
      */
 	static vector<float> hsvToBGR(float h, float s, float v, vector<float> bgr)
 	{
-		if (fabs(s - 0) < 0.0000001) {
-			bgr[0] = bgr[1] = bgr[2] = v;
-		} else {
-			h /= INV60DEGREES;
-			int i = (int) h;
-			float f = h - i;
-			float p = v * (1 - s);
-			float q = v * (1 - s * f);
-			float t = v * (1 - s * (1 - f));
-			if (i == 0) {
-				bgr[0] = p;
-				bgr[1] = t;
-				bgr[2] = v;
-			} else if (i == 1) {
-				bgr[0] = p;
-				bgr[1] = v;
-				bgr[2] = q;
-			} else if (i == 2) {
-				bgr[0] = t;
-				bgr[1] = v;
-				bgr[2] = p;
-			} else if (i == 3) {
-				bgr[0] = v;
-				bgr[1] = q;
-				bgr[2] = p;
-			} else if (i == 4) {
-				bgr[0] = v;
-				bgr[1] = p;
-				bgr[2] = t;
-			} else {
-				bgr[0] = q;
-				bgr[1] = p;
-				bgr[2] = v;
-			}
-		}
+		hsvToBGR(h, s, v, &bgr[0]);
 		return bgr;
 	}
 
@@ -410,9 +479,9 @@ public:
      * @param a
      * @param b
      * @param rgb
-     * @return rgb vector
+     *            result array of 3 floats
      */
-	static vector<float> labToRGB(float l, float a, float b, vector<float> rgb)
+	static void labToRGB(float l, float a, float b, float* rgb)
 	{
 		float y = (l + 16) / 116.0f;
 		float x = a / 500.0f + y;
@@ -445,6 +514,25 @@ public:
 				rgb[i] = 12.92f * rgb[i];
 			}
 		}
+	}
+
+	/**
+     * Converts CIE Lab to RGB components.
+     * 
+     * First we have to convert to XYZ color space. Conversion involves using a
+     * white point, in this case D65 which represents daylight illumination.
+     * 
+     * Algorithm adopted from: http://www.easyrgb.com/math.php
+     * 
+     * @param l
+     * @param a
+     * @param b
+     * @param rgb
+     * @return rgb vector
+     */
+	static vector<float> labToRGB(float l, float a, float b, vector<float> rgb)
+	{
+		labToRGB(l, a, b, &rgb[0]);
 		return rgb;
 	}
 	
@@ -460,43 +548,428 @@ public:
      * @param a
      * @param b
      * @param bgr
+     *            result array of 3 floats
+     */
+	static void labToBGR(float l, float a, float b, float* bgr)
+	{
+		float rgb[3];
+		labToRGB(l, a, b, rgb);
+		bgr[0] = rgb[2];
+		bgr[1] = rgb[1];
+		bgr[2] = rgb[0];
+	}
+
+	/**
+     * Converts CIE Lab to BGR components.
+     * 
+     * First we have to convert to XYZ color space. Conversion involves using a
+     * white point, in this case D65 which represents daylight illumination.
+     * 
+     * Algorithm adopted from: http://www.easyrgb.com/math.php
+     * 
+     * @param l
+     * @param a
+     * @param b
+     * @param bgr
      * @return bgr vector
      */
 	static vector<float> labToBGR(float l, float a, float b, vector<float> bgr)
 	{
-		float y = (l + 16) / 116.0f;
-		float x = a / 500.0f + y;
-		float z = y - b / 200.0f;
-		bgr[0] = z;
-		bgr[1] = y;
-		bgr[2] = x;
+		labToBGR(l, a, b, &bgr[0]);
+		return bgr;
+	}
+
+	/**
+     * Converts RGB components to CIE Lab. This is the inverse of labToRGB()
+     * and uses the same D65 white point.
+     * 
+     * Algorithm adopted from: http://www.easyrgb.com/math.php
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param lab
+     *            result array of 3 floats: L (0..100), a, b
+     */
+	static void rgbToLab(float r, float g, float b, float* lab)
+	{
+		float rgb[3] = { r, g, b };
 		for (int i = 0; i < 3; i++) {
-			float p = (float) pow(bgr[i], 3);
-			if (p > 0.008856) {
-				bgr[i] = p;
+			if (rgb[i] > 0.04045f) {
+				rgb[i] = (float) pow((rgb[i] + 0.055) / 1.055, 2.4);
 			} else {
-				bgr[i] = (bgr[i] - 16 / 116.0f) / 7.787f;
+				rgb[i] = rgb[i] / 12.92f;
 			}
 		}
 
 		// Observer = 2, Illuminant = D65
-		z = bgr[0] * 0.95047f;
-		y = bgr[1];
-		x = bgr[2] * 1.08883f;
-
-		bgr[0] = x * 0.0557f + y * -0.2040f + z * 1.0570f;
-		bgr[1] = x * -0.9689f + y * 1.8758f + z * 0.0415f;
-		bgr[2] = x * 3.2406f + y * -1.5372f + z * -0.4986f;
-		float tpow = 1 / 2.4; // converted this var to float from double
+		float xyz[3];
+		xyz[0] = (rgb[0] * 0.4124f + rgb[1] * 0.3576f + rgb[2] * 0.1805f) / 0.95047f;
+		xyz[1] =  rgb[0] * 0.2126f + rgb[1] * 0.7152f + rgb[2] * 0.0722f;
+		xyz[2] = (rgb[0] * 0.0193f + rgb[1] * 0.1192f + rgb[2] * 0.9505f) / 1.08883f;
 		for (int i = 0; i < 3; i++) {
-			if (bgr[i] > 0.0031308) {
-				bgr[i] = (float) (1.055 * pow(bgr[i], tpow) - 0.055);
+			if (xyz[i] > 0.008856f) {
+				xyz[i] = (float) pow(xyz[i], 1 / 3.0);
 			} else {
-				bgr[i] = 12.92f * bgr[i];
+				xyz[i] = 7.787f * xyz[i] + 16 / 116.0f;
 			}
 		}
-		return bgr;
-	}	
+		lab[0] = 116 * xyz[1] - 16;
+		lab[1] = 500 * (xyz[0] - xyz[1]);
+		lab[2] = 200 * (xyz[1] - xyz[2]);
+	}
+
+	/**
+     * Converts RGB components to CIE Lab.
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param lab
+     * @return lab vector
+     */
+	static vector<float> rgbToLab(float r, float g, float b, vector<float> lab)
+	{
+		rgbToLab(r, g, b, &lab[0]);
+		return lab;
+	}
+
+	/**
+     * Decodes an sRGB gamma encoded component to linear light.
+     * 
+     * @param c
+     *            sRGB component (0..1)
+     * @return linear component
+     */
+	static float srgbToLinear(float c)
+	{
+		return c > 0.04045f ? (float) pow((c + 0.055) / 1.055, 2.4) : c / 12.92f;
+	}
+
+	/**
+     * Encodes a linear light component with the sRGB transfer curve.
+     * 
+     * @param c
+     *            linear component (0..1)
+     * @return sRGB component
+     */
+	static float linearToSRGB(float c)
+	{
+		return c > 0.0031308f ? (float) (1.055 * pow(c, 1 / 2.4) - 0.055) : c * 12.92f;
+	}
+
+	/**
+     * Converts linear RGB components to OKLab. Only two 3x3 matrices and
+     * three cube roots are needed, so this is the cheap path for
+     * perceptual work on data which is already linear.
+     * 
+     * Algorithm by Bjorn Ottosson: https://bottosson.github.io/posts/oklab/
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param lab
+     *            result array of 3 floats: L (0..1), a, b (about -0.4..0.4)
+     */
+	static void linearRGBToOKLab(float r, float g, float b, float* lab)
+	{
+		float l = MathUtils::fastCbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+		float m = MathUtils::fastCbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+		float s = MathUtils::fastCbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+		lab[0] = 0.2104542553f * l + 0.7936177850f * m - 0.0040720468f * s;
+		lab[1] = 1.9779984951f * l - 2.4285922050f * m + 0.4505937099f * s;
+		lab[2] = 0.0259040371f * l + 0.7827717662f * m - 0.8086757660f * s;
+	}
+
+	/**
+     * Converts OKLab to linear RGB components. The result is not clipped.
+     * 
+     * @param l
+     * @param a
+     * @param b
+     * @param rgb
+     *            result array of 3 floats
+     */
+	static void oklabToLinearRGB(float l, float a, float b, float* rgb)
+	{
+		float l_ = l + 0.3963377774f * a + 0.2158037573f * b;
+		float m_ = l - 0.1055613458f * a - 0.0638541728f * b;
+		float s_ = l - 0.0894841775f * a - 1.2914855480f * b;
+		l_ = l_ * l_ * l_;
+		m_ = m_ * m_ * m_;
+		s_ = s_ * s_ * s_;
+		rgb[0] =  4.0767416621f * l_ - 3.3077115913f * m_ + 0.2309699292f * s_;
+		rgb[1] = -1.2684380046f * l_ + 2.6097574011f * m_ - 0.3413193965f * s_;
+		rgb[2] = -0.0041960863f * l_ - 0.7034186147f * m_ + 1.7076147010f * s_;
+	}
+
+	/**
+     * Converts sRGB components to OKLab.
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param lab
+     *            result array of 3 floats: L (0..1), a, b
+     */
+	static void rgbToOKLab(float r, float g, float b, float* lab)
+	{
+		linearRGBToOKLab(srgbToLinear(r), srgbToLinear(g), srgbToLinear(b), lab);
+	}
+
+	/**
+     * Converts sRGB components to OKLab.
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param lab
+     * @return lab vector
+     */
+	static vector<float> rgbToOKLab(float r, float g, float b, vector<float> lab)
+	{
+		rgbToOKLab(r, g, b, &lab[0]);
+		return lab;
+	}
+
+	/**
+     * Converts OKLab to sRGB components, clipped to the 0..1 interval.
+     * 
+     * @param l
+     * @param a
+     * @param b
+     * @param rgb
+     *            result array of 3 floats
+     */
+	static void oklabToRGB(float l, float a, float b, float* rgb)
+	{
+		oklabToLinearRGB(l, a, b, rgb);
+		for (int i = 0; i < 3; i++) {
+			rgb[i] = linearToSRGB(MathUtils::clipNormalized(rgb[i]));
+		}
+	}
+
+	/**
+     * Converts OKLab to sRGB components.
+     * 
+     * @param l
+     * @param a
+     * @param b
+     * @param rgb
+     * @return rgb vector
+     */
+	static vector<float> oklabToRGB(float l, float a, float b, vector<float> rgb)
+	{
+		oklabToRGB(l, a, b, &rgb[0]);
+		return rgb;
+	}
+
+	/**
+     * Converts OKLab to its polar form OKLCh.
+     * 
+     * @param l
+     * @param a
+     * @param b
+     * @param lch
+     *            result array of 3 floats: L, chroma, hue (normalized 0..1
+     *            like the HSV hue)
+     */
+	static void oklabToOKLCh(float l, float a, float b, float* lch)
+	{
+		float h = (float) atan2(b, a) / MathUtils::TWO_PI;
+		lch[0] = l;
+		lch[1] = (float) sqrt(a * a + b * b);
+		lch[2] = h < 0 ? h + 1 : h;
+	}
+
+	/**
+     * Converts OKLCh to OKLab.
+     * 
+     * @param l
+     * @param c
+     * @param h
+     *            normalized hue (0..1)
+     * @param lab
+     *            result array of 3 floats
+     */
+	static void oklchToOKLab(float l, float c, float h, float* lab)
+	{
+		float theta = h * MathUtils::TWO_PI;
+		lab[0] = l;
+		lab[1] = c * (float) cos(theta);
+		lab[2] = c * (float) sin(theta);
+	}
+
+	/**
+     * Converts sRGB components to OKLCh.
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param lch
+     *            result array of 3 floats: L, chroma, normalized hue
+     */
+	static void rgbToOKLCh(float r, float g, float b, float* lch)
+	{
+		float lab[3];
+		rgbToOKLab(r, g, b, lab);
+		oklabToOKLCh(lab[0], lab[1], lab[2], lch);
+	}
+
+	/**
+     * Converts OKLCh to sRGB components, clipped to the 0..1 interval.
+     * 
+     * @param l
+     * @param c
+     * @param h
+     * @param rgb
+     *            result array of 3 floats
+     */
+	static void oklchToRGB(float l, float c, float h, float* rgb)
+	{
+		float lab[3];
+		oklchToOKLab(l, c, h, lab);
+		oklabToRGB(lab[0], lab[1], lab[2], rgb);
+	}
+
+	/**
+     * Gets the red and blue luma weights of a YCbCr standard. The green
+     * weight is 1 - kr - kb.
+     * 
+     * @param standard
+     * @param kr
+     * @param kb
+     */
+	static void getYCbCrWeights(YCbCrStandard standard, float* kr, float* kb)
+	{
+		if (standard == YCBCR_BT709) {
+			*kr = 0.2126f;
+			*kb = 0.0722f;
+		} else if (standard == YCBCR_BT2020) {
+			*kr = 0.2627f;
+			*kb = 0.0593f;
+		} else {
+			*kr = 0.299f;
+			*kb = 0.114f;
+		}
+	}
+
+	/**
+     * Converts RGB components to YCbCr. Results are normalized code values
+     * (8 bit code / 255): full range uses 0..255 for all channels, limited
+     * ("video") range uses 16..235 for Y and 16..240 for Cb/Cr. Chroma is
+     * centred on 128 / 255 in both cases.
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param standard
+     * @param fullRange
+     * @param ycbcr
+     *            result array of 3 floats
+     */
+	static void rgbToYCbCr(float r, float g, float b, YCbCrStandard standard, bool fullRange, float* ycbcr)
+	{
+		float kr, kb;
+		getYCbCrWeights(standard, &kr, &kb);
+		float y = kr * r + (1 - kr - kb) * g + kb * b;
+		float pb = (b - y) / (2 * (1 - kb));
+		float pr = (r - y) / (2 * (1 - kr));
+		if (fullRange) {
+			ycbcr[0] = y;
+			ycbcr[1] = pb + 128 * INV8BIT;
+			ycbcr[2] = pr + 128 * INV8BIT;
+		} else {
+			ycbcr[0] = (16 + 219 * y) * INV8BIT;
+			ycbcr[1] = (128 + 224 * pb) * INV8BIT;
+			ycbcr[2] = (128 + 224 * pr) * INV8BIT;
+		}
+	}
+
+	/**
+     * Converts RGB components to YCbCr.
+     * 
+     * @param r
+     * @param g
+     * @param b
+     * @param standard
+     * @param fullRange
+     * @param ycbcr
+     * @return ycbcr vector
+     */
+	static vector<float> rgbToYCbCr(float r, float g, float b, YCbCrStandard standard, bool fullRange, vector<float> ycbcr)
+	{
+		rgbToYCbCr(r, g, b, standard, fullRange, &ycbcr[0]);
+		return ycbcr;
+	}
+
+	/**
+     * Converts YCbCr normalized code values (see rgbToYCbCr()) to RGB
+     * components. Results are clipped to 0..1.
+     * 
+     * @param y
+     * @param cb
+     * @param cr
+     * @param standard
+     * @param fullRange
+     * @param rgb
+     *            result array of 3 floats
+     */
+	static void ycbcrToRGB(float y, float cb, float cr, YCbCrStandard standard, bool fullRange, float* rgb)
+	{
+		float kr, kb;
+		getYCbCrWeights(standard, &kr, &kb);
+		float pb, pr;
+		if (fullRange) {
+			pb = cb - 128 * INV8BIT;
+			pr = cr - 128 * INV8BIT;
+		} else {
+			y = (y * 255 - 16) / 219;
+			pb = (cb * 255 - 128) / 224;
+			pr = (cr * 255 - 128) / 224;
+		}
+		float kg = 1 - kr - kb;
+		rgb[0] = MathUtils::clip(y + 2 * (1 - kr) * pr, 0.0f, 1.0f);
+		rgb[1] = MathUtils::clip(y - (2 * kb * (1 - kb) * pb + 2 * kr * (1 - kr) * pr) / kg, 0.0f, 1.0f);
+		rgb[2] = MathUtils::clip(y + 2 * (1 - kb) * pb, 0.0f, 1.0f);
+	}
+
+	/**
+     * Converts YCbCr normalized code values to RGB components.
+     * 
+     * @param y
+     * @param cb
+     * @param cr
+     * @param standard
+     * @param fullRange
+     * @param rgb
+     * @return rgb vector
+     */
+	static vector<float> ycbcrToRGB(float y, float cb, float cr, YCbCrStandard standard, bool fullRange, vector<float> rgb)
+	{
+		ycbcrToRGB(y, cb, cr, standard, fullRange, &rgb[0]);
+		return rgb;
+	}
+
+	/**
+     * Converts YCbCr normalized code values to BGR components.
+     * 
+     * @param y
+     * @param cb
+     * @param cr
+     * @param standard
+     * @param fullRange
+     * @param bgr
+     *            result array of 3 floats
+     */
+	static void ycbcrToBGR(float y, float cb, float cr, YCbCrStandard standard, bool fullRange, float* bgr)
+	{
+		float rgb[3];
+		ycbcrToRGB(y, cb, cr, standard, fullRange, rgb);
+		bgr[0] = rgb[2];
+		bgr[1] = rgb[1];
+		bgr[2] = rgb[0];
+	}
 
 	/**
      * Factory method. Creates new color from ARGB int.
@@ -509,21 +982,22 @@ public:
 		return newRGBA(((argb >> 16) & 0xff) * INV8BIT, 
 					   ((argb >> 8)  & 0xff) * INV8BIT, 
 					    (argb        & 0xff) * INV8BIT, 
-						(argb >> 24)         * INV8BIT);
+					   ((argb >> 24) & 0xff) * INV8BIT);
 	}
 
 	/**
-     * Factory method. Creates new color from BGRA int.
+     * Factory method. Creates new color from BGRA int, as packed by
+     * toBGRA() (blue in the top byte, alpha in the lowest).
      * 
      * @param bgra
      * @return new color
      */
 	static OColor newBGRA(int bgra)
 	{
-		return newBGRA(		(bgra        & 0xff) * INV8BIT, 
-							((bgra >> 8)  & 0xff) * INV8BIT, 
+		return newBGRA(		((bgra >> 24) & 0xff) * INV8BIT, 
 							((bgra >> 16) & 0xff) * INV8BIT, 
-							(bgra >> 24) * INV8BIT);
+							((bgra >> 8)  & 0xff) * INV8BIT, 
+							 (bgra        & 0xff) * INV8BIT);
 	}
 
 	/**
@@ -593,7 +1067,9 @@ public:
 	static OColor newHex(const char* stringHex)
 	{
 		OColor col;
-		col.setRGB(hexToRGB(stringHex));
+		float rgb[3];
+		hexToRGB(stringHex, rgb);
+		col.setRGB(rgb);
 		col.alpha = 1;
 		return col;
 	}
@@ -721,9 +1197,9 @@ public:
      * @param g
      * @param b
 	 * @param cmyk
-     * @return cmyk vector
+     *            result array of 4 floats
      */
-	static vector<float> rgbToCMYK(float r, float g, float b, vector<float> cmyk)
+	static void rgbToCMYK(float r, float g, float b, float* cmyk)
 	{
 		cmyk[0] = 1 - r;
 		cmyk[1] = 1 - g;
@@ -734,6 +1210,20 @@ public:
 		cmyk[1] = (cmyk[1] - cmyk[3]) < 0 ? 1 : ((cmyk[1] - cmyk[3]) > 1 ? 1 : (cmyk[1] - cmyk[3]));
 		cmyk[2] = (cmyk[2] - cmyk[3]) < 0 ? 1 : ((cmyk[2] - cmyk[3]) > 1 ? 1 : (cmyk[2] - cmyk[3]));
 		cmyk[3] = cmyk[3] < 0 ? 1 : (cmyk[3] > 1 ? 1 : cmyk[3]);
+	}
+
+	/**
+     * Converts the RGB values into a CMYK vector.
+     * 
+     * @param r
+     * @param g
+     * @param b
+	 * @param cmyk
+     * @return cmyk vector
+     */
+	static vector<float> rgbToCMYK(float r, float g, float b, vector<float> cmyk)
+	{
+		rgbToCMYK(r, g, b, &cmyk[0]);
 		return cmyk;
 	}
 
@@ -742,22 +1232,27 @@ public:
      * 
      * @param b
      * @param g
+     * @param r
+	 * @param cmyk
+     *            result array of 4 floats
+     */
+	static void bgrToCMYK(float b, float g, float r, float* cmyk)
+	{
+		rgbToCMYK(r, g, b, cmyk);
+	}
+
+	/**
+     * Converts the BGR values into a CMYK vector.
+     * 
+     * @param b
+     * @param g
      * @param r
 	 * @param cmyk
      * @return cmyk vector
      */
 	static vector<float> bgrToCMYK(float b, float g, float r, vector<float> cmyk)
 	{
-		cmyk[0] = 1 - b;
-		cmyk[1] = 1 - g;
-		cmyk[2] = 1 - r;
-		cmyk[3] = (cmyk[0] < cmyk[1]) ? ((cmyk[0] < cmyk[2]) ? cmyk[0] : cmyk[2]) : ((cmyk[1] < cmyk[2]) ? cmyk[1] : cmyk[2]);
-
-		cmyk[3] = (cmyk[2] < cmyk[1]) ? ((cmyk[2] < cmyk[1]) ? cmyk[2] : cmyk[1]) : ((cmyk[1] < cmyk[1]) ? cmyk[1] : cmyk[1]);
-		cmyk[0] = (cmyk[0] - cmyk[3]) < 0 ? 1 : ((cmyk[0] - cmyk[3]) > 1 ? 1 : (cmyk[0] - cmyk[3]));
-		cmyk[1] = (cmyk[1] - cmyk[3]) < 0 ? 1 : ((cmyk[1] - cmyk[3]) > 1 ? 1 : (cmyk[1] - cmyk[3]));
-		cmyk[2] = (cmyk[2] - cmyk[3]) < 0 ? 1 : ((cmyk[2] - cmyk[3]) > 1 ? 1 : (cmyk[2] - cmyk[3]));
-		cmyk[3] = cmyk[3] < 0 ? 1 : (cmyk[3] > 1 ? 1 : cmyk[3]);
+		bgrToCMYK(b, g, r, &cmyk[0]);
 		return cmyk;
 	}
 
@@ -891,13 +1386,13 @@ public:
      * @param g
      * @param b
 	 * @param hsv
-     * @return hsv vector
+     *            result array of 3 floats
      */
-	static vector<float> rgbToHSV(float r, float g, float b, vector<float> hsv)
-	{ 
+	static void rgbToHSV(float r, float g, float b, float* hsv)
+	{
 		float h = 0, s = 0;
 		float v = (r > g) ? ((r > b) ? r : b) : ((g > b) ? g : b);
-		float d = v - (r < g) ? ((r < b) ? r : b) : ((g < b) ? g : b);
+		float d = v - ((r < g) ? ((r < b) ? r : b) : ((g < b) ? g : b));
 
 		if (v != 0.0) {
 			s = d / v;
@@ -921,6 +1416,20 @@ public:
 		hsv[0] = h;
 		hsv[1] = s;
 		hsv[2] = v;
+	}
+
+	/**
+     * Converts the RGB values into an HSV vector.
+     * 
+     * @param r
+     * @param g
+     * @param b
+	 * @param hsv
+     * @return hsv vector
+     */
+	static vector<float> rgbToHSV(float r, float g, float b, vector<float> hsv)
+	{
+		rgbToHSV(r, g, b, &hsv[0]);
 		return hsv;
 	}
 
@@ -929,13 +1438,28 @@ public:
      * 
      * @param b
      * @param g
+     * @param r
+	 * @param _hsv
+     *            result array of 3 floats
+     */
+	static void bgrToHSV(float b, float g, float r, float* _hsv)
+	{
+		rgbToHSV(r, g, b, _hsv);
+	}
+
+	/**
+     * Converts the BGR values into an HSV vector.
+     * 
+     * @param b
+     * @param g
      * @param r
 	 * @param _hsv
      * @return hsv vector
      */
 	static vector<float> bgrToHSV(float b, float g, float r, vector<float> _hsv)
 	{
-		return rgbToHSV(r, g, b, _hsv);
+		bgrToHSV(b, g, r, &_hsv[0]);
+		return _hsv;
 	}
 	
 	/**
@@ -950,34 +1474,99 @@ public:
 		return newHSVA(hue.getHue(), s, v, 1.0);
 	}
 
+	/**
+     * Factory method. Creates new color from YCbCr normalized code values.
+     * 
+     * @param y
+     * @param cb
+     * @param cr
+     * @param standard
+     * @param fullRange
+     * @return new color
+     * @see #rgbToYCbCr()
+     */
+	static OColor newYCbCr(float y, float cb, float cr, YCbCrStandard standard, bool fullRange) {
+		float rgb[3];
+		ycbcrToRGB(y, cb, cr, standard, fullRange, rgb);
+		return newRGB(rgb[0], rgb[1], rgb[2]);
+	}
+
+	/**
+     * Factory method. New color from OKLab values.
+     * 
+     * @param l
+     * @param a
+     * @param b
+     * @return new color
+     * @see #rgbToOKLab()
+     */
+	static OColor newOKLab(float l, float a, float b) {
+		float rgb[3];
+		oklabToRGB(l, a, b, rgb);
+		return newRGB(rgb[0], rgb[1], rgb[2]);
+	}
+
+	/**
+     * Factory method. New color from OKLCh values.
+     * 
+     * @param l
+     * @param c
+     * @param h
+     *            normalized hue (0..1)
+     * @return new color
+     */
+	static OColor newOKLCh(float l, float c, float h) {
+		float rgb[3];
+		oklchToRGB(l, c, h, rgb);
+		return newRGB(rgb[0], rgb[1], rgb[2]);
+	}
+
 	//static OColor newRandom();
 
+	/**
+	 * Starts a deferred chain of adjustments (see ColorOps.h), evaluated
+	 * with a single conversion at the end:
+	 * 
+	 * <pre>
+	 * OColor::ops().darken(0.1f).saturate(0.2f).rotateRYB(30).apply(color);
+	 * </pre>
+	 * 
+	 * @return empty chain
+	 */
+	static ColorOps<> ops();
+
+	static float rotateHueRYB(float hue, int theta);
+
 	OColor* adjustContrast(float amount);
 	OColor* adjustHSV(float h, float s, float v);
 	OColor* adjustRGB(float r, float g, float b);
 	OColor* adjustBGR(float b, float g, float r);
-	float getAlpha();
+	float getAlpha() const;
 	OColor* analog(int angle, float delta);
 	OColor* analog(float theta, float delta);
-	float getBlack();
-	OColor* blend_RGB(OColor c, float t);
-	OColor* blend_BGR(OColor c, float t);
-	float getBrightness();
+	float getBlack() const;
+	OColor* blend_RGB(const OColor& c, float t);
+	OColor* blend_BGR(const OColor& c, float t);
+	OColor* blend_OKLab(const OColor& c, float t);
+	float getBrightness() const;
 	OColor* complement();
 	//OColor copy;
-	float getCyan();
+	float getCyan() const;
 	OColor* darken(float step);
 	OColor* desaturate(float step);
-	float distanceToCMYK(OColor color);
-	float distanceToHSV(OColor c);
-	float distanceToRGB(OColor color);
+	float distanceToCMYK(const OColor& color) const;
+	float distanceToHSV(const OColor& c) const;
+	float distanceToRGB(const OColor& color) const;
+	float distanceToOKLab(const OColor& color) const;
+	float distanceToLab(const OColor& color, DeltaEMetric metric = DELTA_E_2000) const;
 	//bool equals(Object object);// possibly not relevant
 	OColor* getAnalog(float theta, float delta);
 	OColor* getAnalog(int angle, float delta);
-	OColor* getBlended_RGB(OColor c, float t);
-	OColor* getBlended_BGR(OColor c, float t);
-	float getBlue_RGB();
-	float getBlue_BGR();
+	OColor* getBlended_RGB(const OColor& c, float t);
+	OColor* getBlended_BGR(const OColor& c, float t);
+	OColor* getBlended_OKLab(const OColor& c, float t);
+	float getBlue_RGB() const;
+	float getBlue_BGR() const;
 	Hue getClosestHue();
 	Hue getClosestHue(bool primaryOnly);
 	OColor* getComplement();
@@ -990,26 +1579,26 @@ public:
 	OColor* getRotatedRYB(float theta);
 	OColor* getRotatedRYB(int angle);
 	OColor* getSaturated(float step);
-	float getGreen_RGB();
-	float getGreen_BGR();
+	float getGreen_RGB() const;
+	float getGreen_BGR() const;
 	//int hashCode();// possibly not relevant
-	float getHue();
+	float getHue() const;
 	OColor* invertRGB();
 	OColor* invertBGR();
-	bool isBlack();
-	bool isGrey();
-	bool isPrimary();
-	bool isWhite();
+	bool isBlack() const;
+	bool isGrey() const;
+	bool isPrimary() const;
+	bool isWhite() const;
 	OColor* lighten(float step);
-	float getLuminance();
-	float getMagenta();
-	float getRed_RGB();
-	float getRed_BGR();
-	float getYellow();
+	float getLuminance() const;
+	float getMagenta() const;
+	float getRed_RGB() const;
+	float getRed_BGR() const;
+	float getYellow() const;
 	OColor* rotateRYB(float theta);
 	OColor* rotateRYB(int theta);
 	OColor* saturate(float step);
-	float getSaturation();
+	float getSaturation() const;
 	OColor* setAlpha(float a);
 	OColor* setARGB(int argb);
 	OColor* setBlack(float val);
@@ -1017,44 +1606,55 @@ public:
 	OColor* setBlue_BGR(float b);
 	OColor* setBrightness(float brightness);
 	OColor* setCMYK(float c, float m, float y, float k);
-	OColor* setCMYK(vector<float> cmykVector);
+	OColor* setCMYK(const vector<float>& cmykVector);
+	OColor* setCMYK(const float* cmykArray);
 	//OColor setComponent(AccessCriteria value1, float value2);
 	OColor* setCyan(float val);
 	OColor* setGreen_RGB(float g);
 	OColor* setGreen_BGR(float g);
 	OColor* setHSV(float h, float s, float v);
-	OColor* setHSV(vector<float> hsvVector);
+	OColor* setHSV(const vector<float>& hsvVector);
+	OColor* setHSV(const float* hsvArray);
 	OColor* setHue(float hue);
 	OColor* setMagenta(float val);
 	OColor* setRed_RGB(float r);
 	OColor* setRed_BGR(float r);
 	OColor* setRGB(float r, float g, float b);
 	OColor* setBGR(float b, float g, float r); 
-	OColor* setRGB(vector<float> rgbVector);
-	OColor* setBGR(vector<float> bgrVector);
+	OColor* setRGB(const vector<float>& rgbVector);
+	OColor* setBGR(const vector<float>& bgrVector);
+	OColor* setRGB(const float* rgbArray);
+	OColor* setBGR(const float* bgrArray);
 	OColor* setSaturation(float saturation);
 	OColor* setYellow(float val);
-	int toARGB();
-	int toBGRA();
+	int toARGB() const;
+	int toBGRA() const;
 	vector<float> toCMYKAArray(vector<float> cmyka);
 	vector<float> toCMYKAArray();
+	void toCMYKAArray(float (&cmyka)[5]) const;
 	//String toHex(); // possibly not relevant
 	vector<float> toHSVAArray(vector<float> hsva);
 	vector<float> toHSVAArray();
+	void toHSVAArray(float* hsva) const;
+	void toYCbCrArray(float* ycbcr, YCbCrStandard standard, bool fullRange) const;
+	void toOKLabArray(float* lab) const;
+	void toOKLChArray(float* lch) const;
 	vector<float> toRGBAArray(vector<float> rgba);
 	vector<float> toRGBAArray(vector<float>, unsigned int offset);
+	void toRGBAArray(float* rgba, unsigned int offset = 0) const;
 	vector<float> toBGRAArray(vector<float> bgra);
 	vector<float> toBGRAArray(vector<float> bgra, unsigned int offset);
+	void toBGRAArray(float* bgra, unsigned int offset = 0) const;
 	//String toString();
 
 	
 
 private:
 	static vector<float> _tempVector;
-	vector<float> bgr;
-	vector<float> rgb;
-	vector<float> cmyk;
-	vector<float> hsv;
+	float bgr[3];
+	float rgb[3];
+	float cmyk[4];
+	float hsv[3];
 
 	float red;
 	float blue;
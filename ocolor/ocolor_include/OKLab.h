@@ -0,0 +1,129 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "PixelFormat.h"
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Buffer conversions and operations in the OKLab perceptual space. Lab
+ * buffers are interleaved L,a,b float triplets; LCh buffers are L,chroma,hue
+ * triplets with the hue normalized to 0..1.
+ * 
+ * OKLab is a replacement for the CIE Lab path (OColor::labToRGB()) in
+ * sorting, clustering and gradient work: it only needs matrix multiplies and
+ * cube roots, has an exact inverse and interpolates without hue shifts.
+ * 8 bit input is linearized through a lookup table, so converting an 8 bit
+ * image costs no pow() calls at all.
+ * 
+ * <pre>
+ * vector<float> lab(count * 3);
+ * OKLab::fromPixels<BGRA8>(pixels, &lab[0], count);
+ * </pre>
+ */
+class OKLab {
+public:
+	static void fromLinearRGB(const float* rgb, float* lab, size_t count);
+	static void toLinearRGB(const float* lab, float* rgb, size_t count);
+	static void fromRGB(const float* rgb, float* lab, size_t count);
+	static void toRGB(const float* lab, float* rgb, size_t count);
+	static void toLCh(const float* lab, float* lch, size_t count);
+	static void fromLCh(const float* lch, float* lab, size_t count);
+	static void mix(const float* lab1, const float* lab2, float t, float* lab, size_t count);
+	static void gradient(const OColor& from, const OColor& to, int steps, float* rgba);
+	static void distances(const float* ref, const float* lab, float* dist, size_t count);
+	static size_t nearest(const float* ref, const float* lab, size_t count);
+
+	/**
+	 * Converts pixels of any PixelFormat to OKLab. Alpha is ignored.
+	 * 
+	 * @param src
+	 *            interleaved source pixels
+	 * @param lab
+	 *            result buffer of count * 3 floats
+	 * @param count
+	 *            number of pixels
+	 */
+	template<typename Fmt>
+	static void fromPixels(const typename Fmt::Scalar* src, float* lab, size_t count)
+	{
+		static_assert(!Fmt::PLANAR, "OKLab needs interleaved pixels");
+		for (size_t i = 0; i < count; i++) {
+			const typename Fmt::Scalar* p = src + i * Fmt::CHANNELS;
+			OColor::linearRGBToOKLab(linearize(p[Fmt::RED]), linearize(p[Fmt::GREEN]), linearize(p[Fmt::BLUE]), lab + i * 3);
+		}
+	}
+
+	/**
+	 * Converts OKLab to pixels of any PixelFormat. Colors outside the sRGB
+	 * gamut are clipped, alpha is set to opaque.
+	 * 
+	 * @param lab
+	 *            buffer of count * 3 floats
+	 * @param dst
+	 *            interleaved destination pixels
+	 * @param count
+	 *            number of pixels
+	 */
+	template<typename Fmt>
+	static void toPixels(const float* lab, typename Fmt::Scalar* dst, size_t count)
+	{
+		static_assert(!Fmt::PLANAR, "OKLab needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		for (size_t i = 0; i < count; i++) {
+			float rgb[3];
+			OColor::oklabToRGB(lab[i * 3], lab[i * 3 + 1], lab[i * 3 + 2], rgb);
+			S* p = dst + i * Fmt::CHANNELS;
+			p[Fmt::RED] = ChannelTraits<S>::fromFloat(rgb[0]);
+			p[Fmt::GREEN] = ChannelTraits<S>::fromFloat(rgb[1]);
+			p[Fmt::BLUE] = ChannelTraits<S>::fromFloat(rgb[2]);
+			if (Fmt::HAS_ALPHA) {
+				p[Fmt::HAS_ALPHA ? Fmt::ALPHA : 0] = ChannelTraits<S>::opaque();
+			}
+		}
+	}
+
+private:
+	static const float* getSRGB8Table();
+
+	static float linearize(unsigned char v) {
+		return getSRGB8Table()[v];
+	}
+
+	template<typename T>
+	static float linearize(T v) {
+		return OColor::srgbToLinear(ChannelTraits<T>::toFloat(v));
+	}
+};
\ No newline at end of file
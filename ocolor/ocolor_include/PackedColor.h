@@ -0,0 +1,82 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Packed integer pixel formats. The 32 bit formats are read and written as
+ * native unsigned ints and named from the most to the least significant
+ * byte, as OColor::toARGB() and OColor::toBGRA() pack them. RGB565 is a
+ * native unsigned short with red in the top 5 bits. RGB10A2 is the
+ * GL/DXGI/Vulkan layout with red in the lowest 10 bits and alpha in the
+ * top 2 bits. RGBA16 is four unsigned shorts per pixel in R, G, B, A order
+ * (the RGBA16 PixelFormat).
+ */
+enum PackedFormat {
+	PACKED_ARGB8888, PACKED_BGRA8888, PACKED_RGBA8888, PACKED_RGB565, PACKED_RGB10A2, PACKED_RGBA16
+};
+
+/**
+ * Batch conversion between packed integer pixels and normalized floats,
+ * either interleaved RGBA or one plane per channel. Channels map 0 .. max
+ * onto 0.0 .. 1.0; packing clamps to that range (NaN becomes 0) and rounds
+ * to nearest, so unpacking and packing again gives back the same integers.
+ * 
+ * The kernels take four pixels at a time with SSE2: fields are extracted
+ * with shifts and masks, converted with saturating clamps, and a 4x4
+ * transpose switches between planar and interleaved floats.
+ * 
+ * <pre>
+ * vector<float> rgba(count * 4);
+ * PackedColor::unpack(PACKED_ARGB8888, pixels, &rgba[0], count);
+ * PackedColor::pack(PACKED_RGB10A2, &rgba[0], deep, count);
+ * </pre>
+ */
+class PackedColor {
+public:
+	static size_t getPixelSize(PackedFormat format);
+	static bool hasAlpha(PackedFormat format);
+
+	static void unpack(PackedFormat format, const void* src, float* rgba, size_t count);
+	static void unpack(PackedFormat format, const void* src, float* red, float* green, float* blue, float* alpha, size_t count);
+	static void pack(PackedFormat format, const float* rgba, void* dst, size_t count);
+	static void pack(PackedFormat format, const float* red, const float* green, const float* blue, const float* alpha,
+					 void* dst, size_t count);
+	static void convert(PackedFormat from, const void* src, PackedFormat to, void* dst, size_t count);
+
+	static OColor read(PackedFormat format, const void* src, size_t i);
+	static void write(PackedFormat format, const OColor& color, void* dst, size_t i);
+};
\ No newline at end of file
@@ -0,0 +1,140 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "ColorClustering.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Parameters of PaletteTracker.
+ */
+struct PaletteTrackerOptions {
+	KMeansOptions kmeans;	// k, space and seed; maxIterations applies to the first frame
+
+	int tileSize;			// tile edge in pixels
+	int tileSamples;		// samples per tile edge, tileSamples^2 per tile
+	float changeThreshold;	// mean absolute RGB change (0..1) that marks a tile as changed
+	int iterations;			// Lloyd iterations per frame after the first
+	float maxDrift;			// largest per frame movement of a palette color, in units of the space
+	float weightSmoothing;	// 0..1, share of the new frame in the palette weights
+
+	PaletteTrackerOptions();
+};
+
+/**
+ * Palette extraction for video. The tracker keeps the clustering state
+ * between frames:
+ * 
+ * - each frame is read at a fixed grid of samples per tile; tiles whose
+ *   samples changed less than changeThreshold reuse the points converted
+ *   in an earlier frame, so only changed tiles are converted again
+ * - clustering starts from the previous frame's centres and runs a few
+ *   Lloyd iterations instead of a full k-means
+ * - centres move at most maxDrift per frame and weights are smoothed, so
+ *   palette entry i stays the same color over time
+ * 
+ * <pre>
+ * PaletteTracker tracker(options);
+ * for (each frame) {
+ *     const vector<ColorCluster>& palette = tracker.update<BGRA8>(pixels, width, height, width * 4);
+ * }
+ * </pre>
+ */
+class PaletteTracker {
+public:
+	PaletteTracker(const PaletteTrackerOptions& options);
+
+	/**
+	 * Processes a frame.
+	 * 
+	 * @param pixels
+	 * @param width
+	 * @param height
+	 * @param stride
+	 *            bytes per row
+	 * @return palette in stable order (not sorted by weight)
+	 */
+	template<typename Fmt>
+	const vector<ColorCluster>& update(const typename Fmt::Scalar* pixels, size_t width, size_t height, size_t stride)
+	{
+		static_assert(!Fmt::PLANAR, "PaletteTracker needs interleaved pixels");
+		typedef typename Fmt::Scalar S;
+		prepare(width, height);
+		size_t s = getTileSamples();
+		for (size_t tile = 0; tile < tilesX * tilesY; tile++) {
+			float* rgb = &samples[tile * s * s * 3];
+			for (size_t j = 0; j < s; j++) {
+				const S* row = (const S*) ((const char*) pixels + sampleY(tile, j) * stride);
+				for (size_t i = 0; i < s; i++) {
+					const S* p = row + sampleX(tile, i) * Fmt::CHANNELS;
+					rgb[0] = ChannelTraits<S>::toFloat(p[Fmt::RED]);
+					rgb[1] = ChannelTraits<S>::toFloat(p[Fmt::GREEN]);
+					rgb[2] = ChannelTraits<S>::toFloat(p[Fmt::BLUE]);
+					rgb += 3;
+				}
+			}
+		}
+		return track();
+	}
+
+	void reset();
+	const vector<ColorCluster>& getPalette() const;
+	size_t getChangedTiles() const;
+	size_t getTileCount() const;
+
+private:
+	void prepare(size_t width, size_t height);
+	size_t getTileSize() const;
+	size_t getTileSamples() const;
+	size_t sampleX(size_t tile, size_t i) const;
+	size_t sampleY(size_t tile, size_t j) const;
+	const vector<ColorCluster>& track();
+
+	PaletteTrackerOptions options;
+	size_t frameWidth;
+	size_t frameHeight;
+	size_t tilesX;
+	size_t tilesY;
+	size_t changedTiles;
+	bool started;
+	vector<float> samples;		// this frame, RGB per sample
+	vector<float> reference;	// RGB of the samples the cached points came from
+	vector<float> x;
+	vector<float> y;
+	vector<float> z;
+	vector<float> centres;
+	vector<float> weights;
+	vector<ColorCluster> palette;
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Minimal data parallel helper used by the batch kernels. Work is split
+ * into fixed size chunks which worker threads claim from a shared counter,
+ * so uneven chunks balance out. The calling thread works as well.
+ */
+class Parallel {
+public:
+	/**
+	 * @param requested
+	 *            thread count asked for by the caller, 0 for one per core
+	 * @return number of threads to use, at least 1
+	 */
+	static unsigned getThreadCount(unsigned requested) {
+		if (requested > 0) {
+			return requested;
+		}
+		unsigned n = thread::hardware_concurrency();
+		return n > 0 ? n : 1;
+	}
+
+	/**
+	 * Calls fn(begin, end) for consecutive chunks of 0 .. count, spread over
+	 * threads. fn must be safe to call concurrently for different chunks.
+	 * 
+	 * @param count
+	 *            number of items
+	 * @param chunk
+	 *            items per call, at least 1
+	 * @param threads
+	 *            thread count, 0 for one per core
+	 * @param fn
+	 *            callable taking (size_t begin, size_t end)
+	 */
+	template<typename Fn>
+	static void forChunks(size_t count, size_t chunk, unsigned threads, Fn fn)
+	{
+		size_t chunks = (count + chunk - 1) / chunk;
+		size_t n = getThreadCount(threads);
+		n = n < chunks ? n : chunks;
+		if (n <= 1) {
+			for (size_t begin = 0; begin < count; begin += chunk) {
+				fn(begin, begin + chunk < count ? begin + chunk : count);
+			}
+			return;
+		}
+
+		atomic<size_t> next(0);
+		auto worker = [&]() {
+			for (size_t c = next++; c < chunks; c = next++) {
+				size_t begin = c * chunk;
+				fn(begin, begin + chunk < count ? begin + chunk : count);
+			}
+		};
+		vector<thread> pool;
+		for (size_t i = 1; i < n; i++) {
+			pool.push_back(thread(worker));
+		}
+		worker();
+		for (size_t i = 0; i < pool.size(); i++) {
+			pool[i].join();
+		}
+	}
+
+	/**
+	 * Calls fn(index, count) once on each of count threads, all running at
+	 * the same time. Unlike forChunks() this guarantees concurrency, so the
+	 * calls may wait for each other (see RowProgress).
+	 * 
+	 * @param threads
+	 *            thread count, 0 for one per core
+	 * @param fn
+	 *            callable taking (unsigned index, unsigned count)
+	 */
+	template<typename Fn>
+	static void forThreads(unsigned threads, Fn fn)
+	{
+		unsigned n = getThreadCount(threads);
+		vector<thread> pool;
+		for (unsigned i = 1; i < n; i++) {
+			pool.push_back(thread(fn, i, n));
+		}
+		fn(0u, n);
+		for (size_t i = 0; i < pool.size(); i++) {
+			pool[i].join();
+		}
+	}
+};
+
+/**
+ * Per row progress counters for wavefront schedules, where a row may only
+ * advance as far as the rows above it allow (e.g. error diffusion). Each
+ * row is owned by one thread which publishes how many items it has
+ * finished; other threads wait on that count.
+ */
+class RowProgress {
+public:
+	explicit RowProgress(size_t rows) : done(rows) {
+		for (size_t i = 0; i < rows; i++) {
+			done[i].store(0, memory_order_relaxed);
+		}
+	}
+
+	void publish(size_t row, size_t count) {
+		done[row].store(count, memory_order_release);
+	}
+
+	/**
+	 * Blocks until row has published at least count finished items.
+	 */
+	void waitFor(size_t row, size_t count) const {
+		while (done[row].load(memory_order_acquire) < count) {
+			this_thread::yield();
+		}
+	}
+
+private:
+	vector<atomic<size_t> > done;
+};
\ No newline at end of file
@@ -0,0 +1,281 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "OColor.h"
+#include "ColorPrecision.h"
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Compile-time description of a pixel layout: channel scalar type (which
+ * implies the bit depth), the position of each channel within a pixel,
+ * whether there is an alpha channel, and whether channels are interleaved
+ * or stored as separate planes.
+ * 
+ * Formats describe memory order, so a packed ARGB int (see OColor::toARGB())
+ * on a little-endian machine has the byte layout of BGRA8.
+ * 
+ * @param T
+ *            channel scalar: unsigned char, unsigned short, Half, float
+ * @param R
+ *            position of red
+ * @param G
+ *            position of green
+ * @param B
+ *            position of blue
+ * @param A
+ *            position of alpha, or -1 if the format has none
+ * @param Planar
+ *            true if every channel is stored in its own plane
+ */
+template<typename T, int R, int G, int B, int A, bool Planar = false>
+struct PixelFormat {
+	typedef T Scalar;
+	static const int RED = R;
+	static const int GREEN = G;
+	static const int BLUE = B;
+	static const int ALPHA = A;
+	static const bool HAS_ALPHA = (A >= 0);
+	static const int CHANNELS = (A >= 0) ? 4 : 3;
+	static const bool PLANAR = Planar;
+
+	/**
+	 * Offset of channel c of pixel i. For interleaved formats planeStride
+	 * is ignored; for planar formats it is the number of scalars between
+	 * the start of two planes.
+	 */
+	static size_t offset(size_t i, int c, size_t planeStride) {
+		return Planar ? (c * planeStride + i) : (i * CHANNELS + c);
+	}
+};
+
+typedef PixelFormat<unsigned char, 0, 1, 2, 3> RGBA8;
+typedef PixelFormat<unsigned char, 2, 1, 0, 3> BGRA8;
+typedef PixelFormat<unsigned char, 1, 2, 3, 0> ARGB8;
+typedef PixelFormat<unsigned char, 3, 2, 1, 0> ABGR8;
+typedef PixelFormat<unsigned char, 0, 1, 2, -1> RGB8;
+typedef PixelFormat<unsigned char, 2, 1, 0, -1> BGR8;
+typedef PixelFormat<unsigned short, 0, 1, 2, 3> RGBA16;
+typedef PixelFormat<unsigned short, 2, 1, 0, 3> BGRA16;
+typedef PixelFormat<unsigned short, 0, 1, 2, -1> RGB16;
+typedef PixelFormat<Half, 0, 1, 2, 3> RGBAH;
+typedef PixelFormat<float, 0, 1, 2, 3> RGBAF;
+typedef PixelFormat<float, 2, 1, 0, 3> BGRAF;
+typedef PixelFormat<float, 0, 1, 2, -1> RGBF;
+typedef PixelFormat<float, 2, 1, 0, -1> BGRF;
+typedef PixelFormat<unsigned char, 0, 1, 2, 3, true> RGBA8_PLANAR;
+typedef PixelFormat<float, 0, 1, 2, 3, true> RGBAF_PLANAR;
+typedef PixelFormat<float, 0, 1, 2, -1, true> RGBF_PLANAR;
+
+/**
+ * Normalization rules for a channel scalar type. Integer channels map
+ * 0 .. max onto 0.0 .. 1.0; float channels are already normalized.
+ */
+template<typename T> struct ChannelTraits;
+
+template<> struct ChannelTraits<unsigned char> {
+	static unsigned char opaque() { return 255; }
+	static float toFloat(unsigned char v) { return v * OColor::INV8BIT; }
+	static unsigned char fromFloat(float v) {
+		return (unsigned char) (v <= 0 ? 0 : (v >= 1 ? 255 : (int) (v * 255 + 0.5f)));
+	}
+};
+
+template<> struct ChannelTraits<unsigned short> {
+	static unsigned short opaque() { return 65535; }
+	static float toFloat(unsigned short v) { return v * (1.0f / 65535); }
+	static unsigned short fromFloat(float v) {
+		return (unsigned short) (v <= 0 ? 0 : (v >= 1 ? 65535 : (int) (v * 65535 + 0.5f)));
+	}
+};
+
+template<> struct ChannelTraits<float> {
+	static float opaque() { return 1; }
+	static float toFloat(float v) { return v; }
+	static float fromFloat(float v) { return v; }
+};
+
+template<> struct ChannelTraits<Half> {
+	static Half opaque() { return ColorPrecision::floatToHalf(1); }
+	static float toFloat(Half v) { return ColorPrecision::halfToFloat(v); }
+	static Half fromFloat(float v) { return ColorPrecision::floatToHalf(v); }
+};
+
+/**
+ * Converts a single channel value between scalar types. The generic
+ * version goes through normalized float; integer to integer and identity
+ * conversions are specialized so they stay exact and never touch float.
+ */
+template<typename S, typename D>
+struct ChannelConverter {
+	static D convert(S v) {
+		return ChannelTraits<D>::fromFloat(ChannelTraits<S>::toFloat(v));
+	}
+};
+
+template<typename T>
+struct ChannelConverter<T, T> {
+	static T convert(T v) {
+		return v;
+	}
+};
+
+template<>
+struct ChannelConverter<unsigned char, unsigned short> {
+	static unsigned short convert(unsigned char v) {
+		return (unsigned short) (v * 257);
+	}
+};
+
+template<>
+struct ChannelConverter<unsigned short, unsigned char> {
+	static unsigned char convert(unsigned short v) {
+		// round(v / 257)
+		return (unsigned char) ((v * 255u + 32895u) >> 16);
+	}
+};
+
+/**
+ * Generates the conversion kernel between two pixel formats. The channel
+ * swizzle, plane addressing and depth conversion are all resolved at
+ * compile time, so every Src/Dst pair gets its own branch-free loop that
+ * reads each source channel once and writes the destination directly.
+ * 
+ * <pre>
+ * PixelConverter<BGRA8, RGBAF>::convert(frame, floats, width * height);
+ * </pre>
+ */
+template<typename Src, typename Dst>
+class PixelConverter {
+public:
+	typedef typename Src::Scalar S;
+	typedef typename Dst::Scalar D;
+
+	/**
+	 * Converts count pixels between two interleaved (or single-row planar)
+	 * buffers.
+	 * 
+	 * @param src
+	 * @param dst
+	 * @param count
+	 *            number of pixels
+	 */
+	static void convert(const S* src, D* dst, size_t count)
+	{
+		convert(src, count, dst, count, count);
+	}
+
+	/**
+	 * Converts count pixels. The plane strides are only used by planar
+	 * formats and give the number of scalars between two planes.
+	 * 
+	 * @param src
+	 * @param srcPlaneStride
+	 * @param dst
+	 * @param dstPlaneStride
+	 * @param count
+	 *            number of pixels
+	 */
+	static void convert(const S* src, size_t srcPlaneStride, D* dst, size_t dstPlaneStride, size_t count)
+	{
+		for (size_t i = 0; i < count; i++) {
+			dst[Dst::offset(i, Dst::RED, dstPlaneStride)] = ChannelConverter<S, D>::convert(src[Src::offset(i, Src::RED, srcPlaneStride)]);
+			dst[Dst::offset(i, Dst::GREEN, dstPlaneStride)] = ChannelConverter<S, D>::convert(src[Src::offset(i, Src::GREEN, srcPlaneStride)]);
+			dst[Dst::offset(i, Dst::BLUE, dstPlaneStride)] = ChannelConverter<S, D>::convert(src[Src::offset(i, Src::BLUE, srcPlaneStride)]);
+			AlphaCopy<Src::HAS_ALPHA, Dst::HAS_ALPHA, 0>::copy(src, srcPlaneStride, dst, dstPlaneStride, i);
+		}
+	}
+
+private:
+	template<bool SrcAlpha, bool DstAlpha, int Unused>
+	struct AlphaCopy {
+		static void copy(const S*, size_t, D*, size_t, size_t) {}
+	};
+
+	template<int Unused>
+	struct AlphaCopy<true, true, Unused> {
+		static void copy(const S* src, size_t srcPlaneStride, D* dst, size_t dstPlaneStride, size_t i) {
+			dst[Dst::offset(i, Dst::ALPHA, dstPlaneStride)] = ChannelConverter<S, D>::convert(src[Src::offset(i, Src::ALPHA, srcPlaneStride)]);
+		}
+	};
+
+	template<int Unused>
+	struct AlphaCopy<false, true, Unused> {
+		static void copy(const S*, size_t, D* dst, size_t dstPlaneStride, size_t i) {
+			dst[Dst::offset(i, Dst::ALPHA, dstPlaneStride)] = ChannelTraits<D>::opaque();
+		}
+	};
+};
+
+/**
+ * Reads and writes OColor values from and to buffers of any PixelFormat.
+ * This replaces the per-order variants (toRGBAArray()/toBGRAArray(),
+ * setRGB()/setBGR()) for code that works on pixel buffers.
+ */
+template<typename Fmt>
+class PixelAccess {
+public:
+	typedef typename Fmt::Scalar S;
+
+	/**
+	 * Writes a color into pixel i of the buffer.
+	 * 
+	 * @param c
+	 * @param buffer
+	 * @param i
+	 * @param planeStride
+	 *            only used by planar formats
+	 */
+	static void write(const OColor& c, S* buffer, size_t i, size_t planeStride = 0)
+	{
+		float rgba[4] = { c.getRed_RGB(), c.getGreen_RGB(), c.getBlue_RGB(), c.getAlpha() };
+		PixelConverter<RGBAF, Fmt>::convert(rgba, 1, buffer + (Fmt::PLANAR ? i : i * Fmt::CHANNELS), planeStride, 1);
+	}
+
+	/**
+	 * Reads pixel i of the buffer into a new color.
+	 * 
+	 * @param buffer
+	 * @param i
+	 * @param planeStride
+	 *            only used by planar formats
+	 * @return new color
+	 */
+	static OColor read(const S* buffer, size_t i, size_t planeStride = 0)
+	{
+		float rgba[4];
+		PixelConverter<Fmt, RGBAF>::convert(buffer + (Fmt::PLANAR ? i : i * Fmt::CHANNELS), planeStride, rgba, 1, 1);
+		return OColor::newRGBA(rgba[0], rgba[1], rgba[2], rgba[3]);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,142 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "ColorClustering.h"
+#include <vector>
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Current state of a ProgressivePalette.
+ */
+struct PaletteEstimate {
+	vector<ColorCluster> palette;
+
+	/**
+	 * 0..1, one minus three standard errors of the least certain cluster
+	 * weight. Grows with the square root of the sample count.
+	 */
+	float confidence;
+
+	/**
+	 * Largest movement of a palette color since the previous estimate, as
+	 * an OKLab distance. Small values mean the palette has settled.
+	 */
+	float drift;
+
+	size_t samples;
+
+	bool complete;	// every pixel has been read
+};
+
+/**
+ * Approximate dominant colors within a time budget. Pixels are visited in
+ * the order of the R2 low discrepancy sequence, so any prefix of the
+ * samples covers the image evenly, and are collected in the same RGB
+ * histogram KMeans uses. Each pixel is read at most once; the pixels the
+ * sequence misses are read in a final pass, so a complete estimate has
+ * seen the whole image. estimate() clusters the histogram; its cost
+ * depends on the number of samples taken, never on the image size.
+ * 
+ * <pre>
+ * ProgressivePalette preview(options);
+ * preview.setImage<RGBA8>(pixels, width, height, width * 4);
+ * PaletteEstimate e = preview.run(10, 0);	// 10 ms
+ * // ... later, keep refining the same image
+ * e = preview.run(10, 0);
+ * </pre>
+ */
+class ProgressivePalette {
+public:
+	/**
+	 * Samples taken between two deadline checks.
+	 */
+	static const size_t BATCH = 2048;
+
+	ProgressivePalette(const KMeansOptions& options);
+
+	/**
+	 * Sets the image to sample and discards previous samples. The pixels
+	 * must stay valid while sampling.
+	 * 
+	 * @param pixels
+	 * @param width
+	 * @param height
+	 * @param stride
+	 *            bytes per row
+	 */
+	template<typename Fmt>
+	void setImage(const typename Fmt::Scalar* pixels, size_t width, size_t height, size_t stride)
+	{
+		static_assert(!Fmt::PLANAR, "ProgressivePalette needs interleaved pixels");
+		image = pixels;
+		imageWidth = width;
+		imageHeight = height;
+		imageStride = stride;
+		reader = readPixel<Fmt>;
+		reset();
+	}
+
+	void reset();
+	void sample(size_t count);
+	PaletteEstimate estimate();
+	PaletteEstimate run(double milliseconds, size_t maxSamples);
+	size_t getSampleCount() const;
+
+private:
+	typedef void (*PixelReader)(const void* row, size_t x, float* rgb);
+
+	template<typename Fmt>
+	static void readPixel(const void* row, size_t x, float* rgb)
+	{
+		typedef typename Fmt::Scalar S;
+		const S* p = (const S*) row + x * Fmt::CHANNELS;
+		rgb[0] = ChannelTraits<S>::toFloat(p[Fmt::RED]);
+		rgb[1] = ChannelTraits<S>::toFloat(p[Fmt::GREEN]);
+		rgb[2] = ChannelTraits<S>::toFloat(p[Fmt::BLUE]);
+	}
+
+	KMeansOptions options;
+	const void* image;
+	size_t imageWidth;
+	size_t imageHeight;
+	size_t imageStride;
+	PixelReader reader;
+	size_t samples;
+	size_t sequence;		// R2 steps taken
+	size_t sweep;			// first pixel the final pass has not passed
+	vector<bool> visited;
+	vector<double> cells;
+	vector<ColorCluster> previous;
+};
\ No newline at end of file
@@ -0,0 +1,242 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+#pragma once
+#include "PixelFormat.h"
+#include <cstddef>
+
+using namespace std;
+
+/**
+ * Fixed point (16.16) coefficients for one YCbCr standard and range, as
+ * used by the YUVConvert kernels. Build them once with
+ * YUVConvert::coefficients() and reuse them for every frame.
+ */
+struct YUVCoefficients {
+	int yOffset;
+
+	// YCbCr -> RGB
+	int yScale;
+	int crToR;
+	int cbToG;
+	int crToG;
+	int cbToB;
+
+	// RGB -> YCbCr
+	int rToY;
+	int gToY;
+	int bToY;
+	int rToCb;
+	int gToCb;
+	int bToCb;
+	int rToCr;
+	int gToCr;
+	int bToCr;
+};
+
+/**
+ * Batch conversions between 8 bit 4:2:0 YCbCr frames, as delivered by video
+ * decoders, and the interleaved 8 bit pixel formats of PixelFormat.h.
+ * NV12 stores a Y plane followed by one interleaved CbCr plane, I420 stores
+ * separate Y, Cb and Cr planes. Each chroma sample covers 2x2 pixels; odd
+ * widths and heights are allowed.
+ * 
+ * The kernels use integer math only and are written as straight row loops
+ * so the compiler can vectorize them.
+ * 
+ * <pre>
+ * YUVCoefficients k = YUVConvert::coefficients(YCBCR_BT709, false);
+ * YUVConvert::nv12ToRGB<BGRA8>(y, width, uv, width, bgra, width * 4, width, height, k);
+ * </pre>
+ */
+class YUVConvert {
+public:
+	static YUVCoefficients coefficients(YCbCrStandard standard, bool fullRange);
+
+	/**
+	 * Converts an NV12 frame to an interleaved 8 bit format.
+	 * 
+	 * @param yPlane
+	 * @param yStride
+	 *            bytes per Y row
+	 * @param uvPlane
+	 * @param uvStride
+	 *            bytes per CbCr row
+	 * @param dst
+	 * @param dstStride
+	 *            bytes per destination row
+	 * @param width
+	 * @param height
+	 * @param k
+	 */
+	template<typename Fmt>
+	static void nv12ToRGB(const unsigned char* yPlane, size_t yStride, const unsigned char* uvPlane, size_t uvStride,
+						  unsigned char* dst, size_t dstStride, int width, int height, const YUVCoefficients& k)
+	{
+		for (int row = 0; row < height; row++) {
+			const unsigned char* uv = uvPlane + (row >> 1) * uvStride;
+			decodeRow<Fmt>(yPlane + row * yStride, uv, uv + 1, 2, dst + row * dstStride, width, k);
+		}
+	}
+
+	/**
+	 * Converts an I420 frame to an interleaved 8 bit format.
+	 * 
+	 * @param yPlane
+	 * @param yStride
+	 * @param cbPlane
+	 * @param cbStride
+	 * @param crPlane
+	 * @param crStride
+	 * @param dst
+	 * @param dstStride
+	 * @param width
+	 * @param height
+	 * @param k
+	 */
+	template<typename Fmt>
+	static void i420ToRGB(const unsigned char* yPlane, size_t yStride, const unsigned char* cbPlane, size_t cbStride,
+						  const unsigned char* crPlane, size_t crStride, unsigned char* dst, size_t dstStride,
+						  int width, int height, const YUVCoefficients& k)
+	{
+		for (int row = 0; row < height; row++) {
+			decodeRow<Fmt>(yPlane + row * yStride, cbPlane + (row >> 1) * cbStride, crPlane + (row >> 1) * crStride, 1,
+						   dst + row * dstStride, width, k);
+		}
+	}
+
+	/**
+	 * Converts an interleaved 8 bit frame to NV12. Chroma is the average of
+	 * each 2x2 block.
+	 * 
+	 * @param src
+	 * @param srcStride
+	 * @param yPlane
+	 * @param yStride
+	 * @param uvPlane
+	 * @param uvStride
+	 * @param width
+	 * @param height
+	 * @param k
+	 */
+	template<typename Fmt>
+	static void rgbToNV12(const unsigned char* src, size_t srcStride, unsigned char* yPlane, size_t yStride,
+						  unsigned char* uvPlane, size_t uvStride, int width, int height, const YUVCoefficients& k)
+	{
+		for (int row = 0; row < height; row += 2) {
+			int next = (row + 1 < height) ? row + 1 : row;
+			unsigned char* uv = uvPlane + (row >> 1) * uvStride;
+			encodeRows<Fmt>(src + row * srcStride, src + next * srcStride, yPlane + row * yStride, yPlane + next * yStride,
+							uv, uv + 1, 2, width, k);
+		}
+	}
+
+	/**
+	 * Converts an interleaved 8 bit frame to I420. Chroma is the average of
+	 * each 2x2 block.
+	 * 
+	 * @param src
+	 * @param srcStride
+	 * @param yPlane
+	 * @param yStride
+	 * @param cbPlane
+	 * @param cbStride
+	 * @param crPlane
+	 * @param crStride
+	 * @param width
+	 * @param height
+	 * @param k
+	 */
+	template<typename Fmt>
+	static void rgbToI420(const unsigned char* src, size_t srcStride, unsigned char* yPlane, size_t yStride,
+						  unsigned char* cbPlane, size_t cbStride, unsigned char* crPlane, size_t crStride,
+						  int width, int height, const YUVCoefficients& k)
+	{
+		for (int row = 0; row < height; row += 2) {
+			int next = (row + 1 < height) ? row + 1 : row;
+			encodeRows<Fmt>(src + row * srcStride, src + next * srcStride, yPlane + row * yStride, yPlane + next * yStride,
+							cbPlane + (row >> 1) * cbStride, crPlane + (row >> 1) * crStride, 1, width, k);
+		}
+	}
+
+private:
+	static unsigned char clamp8(int v) {
+		return (unsigned char) (v < 0 ? 0 : (v > 255 ? 255 : v));
+	}
+
+	template<typename Fmt>
+	static void decodeRow(const unsigned char* y, const unsigned char* cb, const unsigned char* cr, int chromaStep,
+						  unsigned char* dst, int width, const YUVCoefficients& k)
+	{
+		static_assert(!Fmt::PLANAR, "YUVConvert needs interleaved pixels");
+		for (int x = 0; x < width; x++) {
+			int c = (x >> 1) * chromaStep;
+			int luma = (y[x] - k.yOffset) * k.yScale + (1 << 15);
+			int u = cb[c] - 128;
+			int v = cr[c] - 128;
+			unsigned char* p = dst + x * Fmt::CHANNELS;
+			p[Fmt::RED] = clamp8((luma + k.crToR * v) >> 16);
+			p[Fmt::GREEN] = clamp8((luma - k.cbToG * u - k.crToG * v) >> 16);
+			p[Fmt::BLUE] = clamp8((luma + k.cbToB * u) >> 16);
+			if (Fmt::HAS_ALPHA) {
+				p[Fmt::HAS_ALPHA ? Fmt::ALPHA : 0] = 255;
+			}
+		}
+	}
+
+	template<typename Fmt>
+	static void encodeRows(const unsigned char* src0, const unsigned char* src1, unsigned char* y0, unsigned char* y1,
+						   unsigned char* cb, unsigned char* cr, int chromaStep, int width, const YUVCoefficients& k)
+	{
+		static_assert(!Fmt::PLANAR, "YUVConvert needs interleaved pixels");
+		for (int x = 0; x < width; x += 2) {
+			int x1 = (x + 1 < width) ? x + 1 : x;
+			const unsigned char* p[4] = {
+				src0 + x * Fmt::CHANNELS, src0 + x1 * Fmt::CHANNELS,
+				src1 + x * Fmt::CHANNELS, src1 + x1 * Fmt::CHANNELS
+			};
+			int r = 0, g = 0, b = 0;
+			for (int i = 0; i < 4; i++) {
+				r += p[i][Fmt::RED];
+				g += p[i][Fmt::GREEN];
+				b += p[i][Fmt::BLUE];
+			}
+			y0[x] = clamp8(k.yOffset + ((k.rToY * p[0][Fmt::RED] + k.gToY * p[0][Fmt::GREEN] + k.bToY * p[0][Fmt::BLUE] + (1 << 15)) >> 16));
+			y0[x1] = clamp8(k.yOffset + ((k.rToY * p[1][Fmt::RED] + k.gToY * p[1][Fmt::GREEN] + k.bToY * p[1][Fmt::BLUE] + (1 << 15)) >> 16));
+			y1[x] = clamp8(k.yOffset + ((k.rToY * p[2][Fmt::RED] + k.gToY * p[2][Fmt::GREEN] + k.bToY * p[2][Fmt::BLUE] + (1 << 15)) >> 16));
+			y1[x1] = clamp8(k.yOffset + ((k.rToY * p[3][Fmt::RED] + k.gToY * p[3][Fmt::GREEN] + k.bToY * p[3][Fmt::BLUE] + (1 << 15)) >> 16));
+			int c = (x >> 1) * chromaStep;
+			cb[c] = clamp8(128 + ((k.rToCb * r + k.gToCb * g + k.bToCb * b + (1 << 17)) >> 18));
+			cr[c] = clamp8(128 + ((k.rToCr * r + k.gToCr * g + k.bToCr * b + (1 << 17)) >> 18));
+		}
+	}
+};
\ No newline at end of file
@@ -0,0 +1,301 @@
+#include "ColorClustering.h"
+#include <algorithm>
+#include <random>
+
+// points assigned per call of the parallel assignment step
+static const size_t ASSIGN_CHUNK = 4096;
+
+// points per inner block, small enough for the labels to stay in L1
+static const size_t ASSIGN_BLOCK = 256;
+
+static bool heavierCluster(const ColorCluster& a, const ColorCluster& b)
+{
+	return a.weight > b.weight;
+}
+
+KMeansOptions::KMeansOptions() :
+	k(8), space(CLUSTER_OKLAB), maxIterations(30), tolerance(0), threads(0), seed(1)
+{
+
+}
+
+/**
+ * Maps an RGB color to a point of the clustering space.
+ * 
+ * @param space
+ * @param rgb
+ * @param point
+ *            result array of 3 floats
+ */
+void KMeans::toSpace(ClusterSpace space, const float* rgb, float* point)
+{
+	if (space == CLUSTER_LAB) {
+		OColor::rgbToLab(rgb[0], rgb[1], rgb[2], point);
+	}
+	else if (space == CLUSTER_OKLAB) {
+		OColor::rgbToOKLab(rgb[0], rgb[1], rgb[2], point);
+	}
+	else {
+		point[0] = rgb[0];
+		point[1] = rgb[1];
+		point[2] = rgb[2];
+	}
+}
+
+/**
+ * Maps a point of the clustering space back to a color.
+ * 
+ * @param space
+ * @param point
+ * @return color, clipped to the RGB gamut
+ */
+OColor KMeans::fromSpace(ClusterSpace space, const float* point)
+{
+	float rgb[3];
+	if (space == CLUSTER_LAB) {
+		OColor::labToRGB(point[0], point[1], point[2], rgb);
+	}
+	else if (space == CLUSTER_OKLAB) {
+		OColor::oklabToRGB(point[0], point[1], point[2], rgb);
+	}
+	else {
+		rgb[0] = point[0];
+		rgb[1] = point[1];
+		rgb[2] = point[2];
+	}
+	return OColor::newRGB(MathUtils::clipNormalized(rgb[0]), MathUtils::clipNormalized(rgb[1]), MathUtils::clipNormalized(rgb[2]));
+}
+
+/**
+ * Clusters weighted colors.
+ * 
+ * @param rgb
+ *            count RGB triplets (0..1)
+ * @param weights
+ *            count weights, or NULL for equal weights
+ * @param count
+ *            number of colors
+ * @param options
+ * @return clusters sorted by descending weight
+ */
+vector<ColorCluster> KMeans::cluster(const float* rgb, const float* weights, size_t count, const KMeansOptions& options)
+{
+	vector<float> px, py, pz, pw;
+	px.reserve(count);
+	py.reserve(count);
+	pz.reserve(count);
+	pw.reserve(count);
+	double totalWeight = 0;
+	for (size_t i = 0; i < count; i++) {
+		float w = weights ? weights[i] : 1;
+		if (w <= 0) {
+			continue;
+		}
+		float p[3];
+		toSpace(options.space, rgb + i * 3, p);
+		px.push_back(p[0]);
+		py.push_back(p[1]);
+		pz.push_back(p[2]);
+		pw.push_back(w);
+		totalWeight += w;
+	}
+	size_t n = px.size();
+	int k = (int) min((size_t) max(options.k, 1), n);
+	vector<ColorCluster> result;
+	if (k == 0) {
+		return result;
+	}
+
+	vector<float> centres(k * 3);
+	vector<double> clusterWeights(k);
+	seed(&px[0], &py[0], &pz[0], &pw[0], n, k, options.seed, &centres[0]);
+	iterate(&px[0], &py[0], &pz[0], &pw[0], n, k, &centres[0], &clusterWeights[0], options);
+
+	for (int c = 0; c < k; c++) {
+		if (clusterWeights[c] <= 0) {
+			continue;
+		}
+		ColorCluster cluster;
+		cluster.color = fromSpace(options.space, &centres[c * 3]);
+		cluster.weight = (float) (clusterWeights[c] / totalWeight);
+		result.push_back(cluster);
+	}
+	sort(result.begin(), result.end(), heavierCluster);
+	return result;
+}
+
+/**
+ * k-means++ seeding: picks each new centre with probability weight * D^2,
+ * D being the distance to the closest centre picked so far.
+ * 
+ * @param x
+ *            n point coordinates, one array per axis
+ * @param y
+ * @param z
+ * @param w
+ *            n positive weights
+ * @param n
+ *            number of points, at least 1
+ * @param k
+ *            number of centres
+ * @param seed
+ *            random seed
+ * @param centres
+ *            result array of k * 3 floats
+ */
+void KMeans::seed(const float* x, const float* y, const float* z, const float* w, size_t n, int k, unsigned seed, float* centres)
+{
+	minstd_rand random(seed);
+	uniform_real_distribution<double> uniform(0, 1);
+	vector<float> nearest(n, 1E30f);
+	for (int c = 0; c < k; c++) {
+		double sum = 0;
+		for (size_t i = 0; i < n; i++) {
+			sum += (double) w[i] * (c == 0 ? 1 : nearest[i]);
+		}
+		double target = uniform(random) * sum;
+		size_t pick = 0;
+		for (double acc = 0; pick < n - 1 && (acc += (double) w[pick] * (c == 0 ? 1 : nearest[pick])) < target; pick++);
+		centres[c * 3] = x[pick];
+		centres[c * 3 + 1] = y[pick];
+		centres[c * 3 + 2] = z[pick];
+		for (size_t i = 0; i < n; i++) {
+			float dx = x[i] - centres[c * 3], dy = y[i] - centres[c * 3 + 1], dz = z[i] - centres[c * 3 + 2];
+			float d = dx * dx + dy * dy + dz * dz;
+			nearest[i] = d < nearest[i] ? d : nearest[i];
+		}
+	}
+}
+
+/**
+ * Lloyd iterations from the given centres until no centre moves more than
+ * the tolerance or the iteration cap is reached. Centres without points
+ * keep their position.
+ * 
+ * @param x
+ *            n point coordinates, one array per axis
+ * @param y
+ * @param z
+ * @param w
+ *            n weights
+ * @param n
+ *            number of points
+ * @param k
+ *            number of centres
+ * @param centres
+ *            k * 3 floats, start positions in, final positions out
+ * @param weights
+ *            result array of k total weights of the points of each centre
+ * @param options
+ *            tolerance, maxIterations, space and threads are used
+ * @return number of iterations run
+ */
+int KMeans::iterate(const float* x, const float* y, const float* z, const float* w, size_t n, int k, float* centres, double* weights, const KMeansOptions& options)
+{
+	float tolerance = options.tolerance > 0 ? options.tolerance : (options.space == CLUSTER_LAB ? 0.1f : 0.001f);
+	size_t chunks = (n + ASSIGN_CHUNK - 1) / ASSIGN_CHUNK;
+	vector<vector<double> > sums(chunks);
+	vector<double> total(k * 4, 0.0);
+	int iteration = 0;
+	while (iteration < max(options.maxIterations, 1)) {
+		iteration++;
+		Parallel::forChunks(n, ASSIGN_CHUNK, options.threads, [&](size_t begin, size_t end) {
+			vector<double>& acc = sums[begin / ASSIGN_CHUNK];
+			acc.assign(k * 4, 0);
+			float best[ASSIGN_BLOCK];
+			int label[ASSIGN_BLOCK];
+			for (size_t block = begin; block < end; block += ASSIGN_BLOCK) {
+				size_t m = min(ASSIGN_BLOCK, end - block);
+				const float* bx = x + block;
+				const float* by = y + block;
+				const float* bz = z + block;
+				for (size_t i = 0; i < m; i++) {
+					best[i] = 1E30f;
+					label[i] = 0;
+				}
+				for (int c = 0; c < k; c++) {
+					float ux = centres[c * 3], uy = centres[c * 3 + 1], uz = centres[c * 3 + 2];
+					for (size_t i = 0; i < m; i++) {
+						float dx = bx[i] - ux, dy = by[i] - uy, dz = bz[i] - uz;
+						float d = dx * dx + dy * dy + dz * dz;
+						bool closer = d < best[i];
+						best[i] = closer ? d : best[i];
+						label[i] = closer ? c : label[i];
+					}
+				}
+				for (size_t i = 0; i < m; i++) {
+					double pw = w[block + i];
+					double* s = &acc[label[i] * 4];
+					s[0] += pw;
+					s[1] += pw * bx[i];
+					s[2] += pw * by[i];
+					s[3] += pw * bz[i];
+				}
+			}
+		});
+
+		fill(total.begin(), total.end(), 0.0);
+		for (size_t c = 0; c < chunks; c++) {
+			for (int i = 0; i < k * 4; i++) {
+				total[i] += sums[c][i];
+			}
+		}
+		float moved = 0;
+		for (int c = 0; c < k; c++) {
+			double cw = total[c * 4];
+			if (cw <= 0) {
+				continue;
+			}
+			float* centre = centres + c * 3;
+			float nx = (float) (total[c * 4 + 1] / cw);
+			float ny = (float) (total[c * 4 + 2] / cw);
+			float nz = (float) (total[c * 4 + 3] / cw);
+			float d = sqrt((nx - centre[0]) * (nx - centre[0]) + (ny - centre[1]) * (ny - centre[1]) + (nz - centre[2]) * (nz - centre[2]));
+			moved = d > moved ? d : moved;
+			centre[0] = nx;
+			centre[1] = ny;
+			centre[2] = nz;
+		}
+		if (moved < tolerance) {
+			break;
+		}
+	}
+	for (int c = 0; c < k; c++) {
+		weights[c] = total[c * 4];
+	}
+	return iteration;
+}
+
+/**
+ * Merges the per thread histograms of dominantColors() and clusters the
+ * mean colors of the occupied cells, weighted by their pixel counts.
+ */
+vector<ColorCluster> KMeans::clusterHistogram(vector<vector<double> >& partials, const KMeansOptions& options)
+{
+	if (partials.empty()) {
+		return vector<ColorCluster>();
+	}
+	vector<double>& cells = partials[0];
+	for (size_t p = 1; p < partials.size(); p++) {
+		for (size_t i = 0; i < cells.size(); i++) {
+			cells[i] += partials[p][i];
+		}
+		vector<double>().swap(partials[p]);
+	}
+
+	vector<float> rgb;
+	vector<float> weights;
+	for (int cell = 0; cell < HISTOGRAM_SIZE; cell++) {
+		double n = cells[cell * 4];
+		if (n > 0) {
+			rgb.push_back((float) (cells[cell * 4 + 1] / n));
+			rgb.push_back((float) (cells[cell * 4 + 2] / n));
+			rgb.push_back((float) (cells[cell * 4 + 3] / n));
+			weights.push_back((float) n);
+		}
+	}
+	if (weights.empty()) {
+		return vector<ColorCluster>();
+	}
+	return cluster(&rgb[0], &weights[0], weights.size(), options);
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include "ColorDifference.h"
+
+static const float POW25_7 = 6103515625.0f;
+
+// 1 - sin(60 degrees): lower limit of the CIEDE2000 chroma/hue quadratic form
+static const float MIN_ROTATION_FACTOR = 0.1339746f;
+
+struct ExactTrig {
+	static float atan2(float y, float x) { return (float) ::atan2(y, x); }
+	static float cos(float x) { return (float) ::cos(x); }
+	static float sin(float x) { return (float) ::sin(x); }
+};
+
+struct FastTrig {
+	static float atan2(float y, float x) { return MathUtils::fastAtan2(y, x); }
+	static float cos(float x) { return MathUtils::fastCos(x); }
+	static float sin(float x) { return MathUtils::fastSin(x); }
+};
+
+static float pow7(float x)
+{
+	float x2 = x * x;
+	return x2 * x2 * x2 * x;
+}
+
+/**
+ * CIEDE2000 after Sharma, Wu and Dalal, "The CIEDE2000 Color-Difference
+ * Formula: Implementation Notes". c1 and c2 are the Lab chromas, passed in
+ * so batch callers can compute the reference chroma once. Hue selection
+ * is written with conditional expressions only.
+ */
+template<typename Trig>
+static float ciede2000Impl(float l1, float a1, float b1, float c1, float l2, float a2, float b2, float c2)
+{
+	const float PI = 3.14159265f;
+	const float TWO_PI = 6.28318531f;
+
+	float cBar7 = pow7((c1 + c2) * 0.5f);
+	float g = 0.5f * (1 - sqrt(cBar7 / (cBar7 + POW25_7)));
+	float a1p = a1 * (1 + g);
+	float a2p = a2 * (1 + g);
+	float c1p = sqrt(a1p * a1p + b1 * b1);
+	float c2p = sqrt(a2p * a2p + b2 * b2);
+	float h1p = Trig::atan2(b1, a1p);
+	float h2p = Trig::atan2(b2, a2p);
+	h1p = h1p < 0 ? h1p + TWO_PI : h1p;
+	h2p = h2p < 0 ? h2p + TWO_PI : h2p;
+	bool achromatic = c1p * c2p == 0;
+
+	float dl = l2 - l1;
+	float dc = c2p - c1p;
+	float dh = h2p - h1p;
+	dh = dh > PI ? dh - TWO_PI : (dh < -PI ? dh + TWO_PI : dh);
+	dh = achromatic ? 0 : dh;
+	float dH = 2 * sqrt(c1p * c2p) * Trig::sin(dh * 0.5f);
+
+	float lBar = (l1 + l2) * 0.5f;
+	float cBarP = (c1p + c2p) * 0.5f;
+	float hSum = h1p + h2p;
+	float hDiff = h1p - h2p;
+	float hBar = (hDiff > PI || hDiff < -PI) ? (hSum < TWO_PI ? hSum + TWO_PI : hSum - TWO_PI) * 0.5f : hSum * 0.5f;
+	hBar = achromatic ? hSum : hBar;
+
+	float t = 1 - 0.17f * Trig::cos(hBar - 0.52359878f)
+				+ 0.24f * Trig::cos(2 * hBar)
+				+ 0.32f * Trig::cos(3 * hBar + 0.10471976f)
+				- 0.20f * Trig::cos(4 * hBar - 1.09955743f);
+	float hBarDeg = (hBar * 57.2957795f - 275) / 25;
+	float dTheta = 0.52359878f * (float) exp(-hBarDeg * hBarDeg);
+	float cBarP7 = pow7(cBarP);
+	float rc = 2 * sqrt(cBarP7 / (cBarP7 + POW25_7));
+	float lb = (lBar - 50) * (lBar - 50);
+	float sl = 1 + 0.015f * lb / sqrt(20 + lb);
+	float sc = 1 + 0.045f * cBarP;
+	float sh = 1 + 0.015f * cBarP * t;
+	float rt = -Trig::sin(2 * dTheta) * rc;
+
+	float tl = dl / sl;
+	float tc = dc / sc;
+	float th = dH / sh;
+	return sqrt(tl * tl + tc * tc + th * th + rt * tc * th);
+}
+
+static float cie94Impl(float l1, float a1, float b1, float c1, float l2, float a2, float b2)
+{
+	float c2 = sqrt(a2 * a2 + b2 * b2);
+	float dl = l1 - l2;
+	float dc = c1 - c2;
+	float da = a1 - a2;
+	float db = b1 - b2;
+	float dh2 = da * da + db * db - dc * dc;
+	dh2 = dh2 < 0 ? 0 : dh2;
+	float sc = 1 + 0.045f * c1;
+	float sh = 1 + 0.015f * c1;
+	return sqrt(dl * dl + (dc / sc) * (dc / sc) + dh2 / (sh * sh));
+}
+
+/**
+ * CIE76: Euclidean distance in Lab.
+ * 
+ * @param lab1
+ * @param lab2
+ * @return delta E
+ */
+float DeltaE::cie76(const float* lab1, const float* lab2)
+{
+	float dl = lab1[0] - lab2[0];
+	float da = lab1[1] - lab2[1];
+	float db = lab1[2] - lab2[2];
+	return sqrt(dl * dl + da * da + db * db);
+}
+
+/**
+ * CIE94 with graphic arts weights (kL = 1, K1 = 0.045, K2 = 0.015).
+ * 
+ * @param lab1
+ *            reference color
+ * @param lab2
+ *            sample color
+ * @return delta E
+ */
+float DeltaE::cie94(const float* lab1, const float* lab2)
+{
+	return cie94Impl(lab1[0], lab1[1], lab1[2], sqrt(lab1[1] * lab1[1] + lab1[2] * lab1[2]), lab2[0], lab2[1], lab2[2]);
+}
+
+/**
+ * CIEDE2000 with kL = kC = kH = 1.
+ * 
+ * @param lab1
+ * @param lab2
+ * @return delta E
+ */
+float DeltaE::ciede2000(const float* lab1, const float* lab2)
+{
+	return ciede2000Impl<ExactTrig>(lab1[0], lab1[1], lab1[2], sqrt(lab1[1] * lab1[1] + lab1[2] * lab1[2]),
+									lab2[0], lab2[1], lab2[2], sqrt(lab2[1] * lab2[1] + lab2[2] * lab2[2]));
+}
+
+/**
+ * @param metric
+ * @param lab1
+ * @param lab2
+ * @return delta E of the given metric
+ */
+float DeltaE::distance(DeltaEMetric metric, const float* lab1, const float* lab2)
+{
+	if (metric == DELTA_E_2000) {
+		return ciede2000(lab1, lab2);
+	}
+	else if (metric == DELTA_E_94) {
+		return cie94(lab1, lab2);
+	}
+	return cie76(lab1, lab2);
+}
+
+/**
+ * Checks whether two colors are within a delta E threshold. Clearly
+ * distant pairs are rejected by a lower bound of the metric that needs no
+ * trigonometry: for CIE94 the lightness term, for CIEDE2000 the lightness
+ * term plus the a/b distance scaled by the largest possible chroma/hue
+ * weights.
+ * 
+ * @param metric
+ * @param lab1
+ * @param lab2
+ * @param threshold
+ * @return true if the delta E is at most threshold
+ */
+bool DeltaE::isWithin(DeltaEMetric metric, const float* lab1, const float* lab2, float threshold)
+{
+	float dl = lab1[0] - lab2[0];
+	float da = lab1[1] - lab2[1];
+	float db = lab1[2] - lab2[2];
+	float t2 = threshold * threshold;
+	if (metric == DELTA_E_76) {
+		return dl * dl + da * da + db * db <= t2;
+	}
+	if (dl * dl > t2) {
+		// both formulas weigh lightness with SL >= 1 (CIE94: SL = 1)
+		if (metric == DELTA_E_94) {
+			return false;
+		}
+		float lb = (lab1[0] + lab2[0]) * 0.5f - 50;
+		lb *= lb;
+		float sl = 1 + 0.015f * lb / sqrt(20 + lb);
+		if (dl * dl > t2 * sl * sl) {
+			return false;
+		}
+	}
+	if (metric == DELTA_E_2000) {
+		// a' >= a and C' <= 1.5 C, the rotation term removes at most 1 - sin(60)
+		float cBar = (sqrt(lab1[1] * lab1[1] + lab1[2] * lab1[2]) + sqrt(lab2[1] * lab2[1] + lab2[2] * lab2[2])) * 0.5f;
+		float lb = (lab1[0] + lab2[0]) * 0.5f - 50;
+		lb *= lb;
+		float sl = 1 + 0.015f * lb / sqrt(20 + lb);
+		float sMax = 1 + 0.0675f * cBar;
+		float bound = dl * dl / (sl * sl) + MIN_ROTATION_FACTOR * (da * da + db * db) / (sMax * sMax);
+		if (bound > t2) {
+			return false;
+		}
+		return ciede2000(lab1, lab2) <= threshold;
+	}
+	return cie94(lab1, lab2) <= threshold;
+}
+
+/**
+ * Calculates the delta E of every color in a buffer to one reference.
+ * 
+ * @param metric
+ * @param ref
+ *            reference L,a,b
+ * @param lab
+ *            buffer of count * 3 floats
+ * @param dist
+ *            result buffer of count floats
+ * @param count
+ *            number of colors
+ */
+void DeltaE::oneToMany(DeltaEMetric metric, const float* ref, const float* lab, float* dist, size_t count)
+{
+	float l1 = ref[0], a1 = ref[1], b1 = ref[2];
+	float c1 = sqrt(a1 * a1 + b1 * b1);
+	if (metric == DELTA_E_2000) {
+		for (size_t i = 0; i < count; i++) {
+			const float* p = lab + i * 3;
+			dist[i] = ciede2000Impl<FastTrig>(l1, a1, b1, c1, p[0], p[1], p[2], sqrt(p[1] * p[1] + p[2] * p[2]));
+		}
+	}
+	else if (metric == DELTA_E_94) {
+		for (size_t i = 0; i < count; i++) {
+			const float* p = lab + i * 3;
+			dist[i] = cie94Impl(l1, a1, b1, c1, p[0], p[1], p[2]);
+		}
+	}
+	else {
+		for (size_t i = 0; i < count; i++) {
+			const float* p = lab + i * 3;
+			float dl = l1 - p[0];
+			float da = a1 - p[1];
+			float db = b1 - p[2];
+			dist[i] = sqrt(dl * dl + da * da + db * db);
+		}
+	}
+}
+
+/**
+ * Calculates the delta E of every pair of two color buffers.
+ * 
+ * @param metric
+ * @param lab1
+ *            buffer of count1 * 3 floats (reference colors)
+ * @param count1
+ * @param lab2
+ *            buffer of count2 * 3 floats
+ * @param count2
+ * @param dist
+ *            result matrix of count1 * count2 floats, row i holds the
+ *            distances of lab1 color i
+ */
+void DeltaE::manyToMany(DeltaEMetric metric, const float* lab1, size_t count1, const float* lab2, size_t count2, float* dist)
+{
+	for (size_t i = 0; i < count1; i++) {
+		oneToMany(metric, lab1 + i * 3, lab2, dist + i * count2, count2);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,263 @@
+#include "ColorDistance.h"
+#include "Parallel.h"
+
+/**
+ * @param metric
+ *            metric whose distances the set will compute
+ */
+ColorSet::ColorSet(DistanceMetric metric) :
+	metric(metric)
+{
+
+}
+
+/**
+ * Appends a color.
+ * 
+ * @param color
+ */
+void ColorSet::add(const OColor& color) {
+	float point[4];
+	toPoint(color, point);
+	for (int i = 0; i < getDimensions(); i++) {
+		channels[i].push_back(point[i]);
+	}
+}
+
+/**
+ * Appends all colors of a palette.
+ * 
+ * @param colors
+ */
+void ColorSet::add(const vector<OColor>& colors) {
+	reserve(size() + colors.size());
+	for (size_t i = 0; i < colors.size(); i++) {
+		add(colors[i]);
+	}
+}
+
+void ColorSet::clear() {
+	for (int i = 0; i < 4; i++) {
+		channels[i].clear();
+	}
+}
+
+void ColorSet::reserve(size_t count) {
+	for (int i = 0; i < getDimensions(); i++) {
+		channels[i].reserve(count);
+	}
+}
+
+DistanceMetric ColorSet::getMetric() const {
+	return metric;
+}
+
+/**
+ * @return number of channels per point: 4 for CMYK, otherwise 3
+ */
+int ColorSet::getDimensions() const {
+	return metric == DISTANCE_CMYK ? 4 : 3;
+}
+
+size_t ColorSet::size() const {
+	return channels[0].size();
+}
+
+/**
+ * @param i
+ *            channel index, 0 .. getDimensions() - 1
+ * @return contiguous array of size() values
+ */
+const float* ColorSet::getChannel(int i) const {
+	return channels[i].empty() ? NULL : &channels[i][0];
+}
+
+/**
+ * Maps a color to its point in the set's metric.
+ * 
+ * @param color
+ * @param point
+ *            result array of getDimensions() floats
+ */
+void ColorSet::toPoint(const OColor& color, float* point) const {
+	if (metric == DISTANCE_HSV) {
+		float hue = color.getHue() * MathUtils::TWO_PI;
+		float s = color.getSaturation();
+		point[0] = (float) cos(hue) * s;
+		point[1] = (float) sin(hue) * s;
+		point[2] = color.getBrightness();
+	}
+	else if (metric == DISTANCE_CMYK) {
+		point[0] = color.getCyan();
+		point[1] = color.getMagenta();
+		point[2] = color.getYellow();
+		point[3] = color.getBlack();
+	}
+	else {
+		point[0] = color.getRed_RGB();
+		point[1] = color.getGreen_RGB();
+		point[2] = color.getBlue_RGB();
+	}
+}
+
+void ColorDistance::rowRange(const ColorSet& set, const float* point, size_t begin, size_t end, float* dist)
+{
+	const float* c0 = set.getChannel(0);
+	const float* c1 = set.getChannel(1);
+	const float* c2 = set.getChannel(2);
+	float p0 = point[0], p1 = point[1], p2 = point[2];
+	if (set.getDimensions() == 4) {
+		const float* c3 = set.getChannel(3);
+		float p3 = point[3];
+		for (size_t j = begin; j < end; j++) {
+			float d0 = c0[j] - p0, d1 = c1[j] - p1, d2 = c2[j] - p2, d3 = c3[j] - p3;
+			dist[j] = sqrt(d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3);
+		}
+	}
+	else {
+		for (size_t j = begin; j < end; j++) {
+			float d0 = c0[j] - p0, d1 = c1[j] - p1, d2 = c2[j] - p2;
+			dist[j] = sqrt(d0 * d0 + d1 * d1 + d2 * d2);
+		}
+	}
+}
+
+void ColorDistance::rowRangeWithin(const ColorSet& set, const float* point, size_t begin, size_t end, float threshold, unsigned long long* bits)
+{
+	// begin is a multiple of 64, so every word is built here and stored once
+	const float* c0 = set.getChannel(0);
+	const float* c1 = set.getChannel(1);
+	const float* c2 = set.getChannel(2);
+	const float* c3 = set.getDimensions() == 4 ? set.getChannel(3) : NULL;
+	float p0 = point[0], p1 = point[1], p2 = point[2], p3 = c3 ? point[3] : 0;
+	float t2 = threshold * threshold;
+	for (size_t word = begin; word < end; word += 64) {
+		size_t last = word + 64 < end ? word + 64 : end;
+		unsigned long long w = 0;
+		for (size_t j = word; j < last; j++) {
+			float d0 = c0[j] - p0, d1 = c1[j] - p1, d2 = c2[j] - p2;
+			float d3 = c3 ? c3[j] - p3 : 0;
+			w |= (unsigned long long) (d0 * d0 + d1 * d1 + d2 * d2 + d3 * d3 <= t2) << (j - word);
+		}
+		bits[word / 64] = w;
+	}
+}
+
+/**
+ * Distances of one color to every color of the set.
+ * 
+ * @param set
+ * @param ref
+ * @param dist
+ *            result array of set.size() floats
+ */
+void ColorDistance::row(const ColorSet& set, const OColor& ref, float* dist)
+{
+	float point[4];
+	set.toPoint(ref, point);
+	rowRange(set, point, 0, set.size(), dist);
+}
+
+/**
+ * Distances of the set's color at index to every color of the set.
+ * 
+ * @param set
+ * @param index
+ * @param dist
+ *            result array of set.size() floats
+ */
+void ColorDistance::row(const ColorSet& set, size_t index, float* dist)
+{
+	float point[4];
+	for (int c = 0; c < set.getDimensions(); c++) {
+		point[c] = set.getChannel(c)[index];
+	}
+	rowRange(set, point, 0, set.size(), dist);
+}
+
+/**
+ * Thresholded distances of the set's color at index to every color of the
+ * set.
+ * 
+ * @param set
+ * @param index
+ * @param threshold
+ *            maximum distance for a set bit
+ * @param bits
+ *            result row of getBitRowWords(set.size()) words
+ */
+void ColorDistance::rowWithin(const ColorSet& set, size_t index, float threshold, unsigned long long* bits)
+{
+	float point[4];
+	for (int c = 0; c < set.getDimensions(); c++) {
+		point[c] = set.getChannel(c)[index];
+	}
+	rowRangeWithin(set, point, 0, set.size(), threshold, bits);
+}
+
+/**
+ * Full distance matrix of the set.
+ * 
+ * @param set
+ * @param dist
+ *            result matrix of set.size() * set.size() floats, row major
+ * @param threads
+ *            0 for one thread per core
+ */
+void ColorDistance::matrix(const ColorSet& set, float* dist, unsigned threads)
+{
+	size_t n = set.size();
+	int dims = set.getDimensions();
+	Parallel::forChunks(n, 64, threads, [&](size_t first, size_t last) {
+		float point[4];
+		for (size_t block = 0; block < n; block += BLOCK) {
+			size_t end = block + BLOCK < n ? block + BLOCK : n;
+			for (size_t i = first; i < last; i++) {
+				for (int c = 0; c < dims; c++) {
+					point[c] = set.getChannel(c)[i];
+				}
+				rowRange(set, point, block, end, dist + i * n);
+			}
+		}
+	});
+}
+
+/**
+ * Thresholded distance matrix of the set.
+ * 
+ * @param set
+ * @param threshold
+ *            maximum distance for a set bit
+ * @param bits
+ *            result matrix of set.size() * getBitRowWords(set.size()) words
+ * @param threads
+ *            0 for one thread per core
+ */
+void ColorDistance::matrixWithin(const ColorSet& set, float threshold, unsigned long long* bits, unsigned threads)
+{
+	size_t n = set.size();
+	size_t words = getBitRowWords(n);
+	int dims = set.getDimensions();
+	Parallel::forChunks(n, 64, threads, [&](size_t first, size_t last) {
+		float point[4];
+		for (size_t block = 0; block < n; block += BLOCK) {
+			size_t end = block + BLOCK < n ? block + BLOCK : n;
+			for (size_t i = first; i < last; i++) {
+				for (int c = 0; c < dims; c++) {
+					point[c] = set.getChannel(c)[i];
+				}
+				rowRangeWithin(set, point, block, end, threshold, bits + i * words);
+			}
+		}
+	});
+}
+
+/**
+ * @param count
+ *            number of colors
+ * @return number of 64 bit words in one bit matrix row
+ */
+size_t ColorDistance::getBitRowWords(size_t count)
+{
+	return (count + 63) / 64;
+}
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "ColorGradient.h"
+#include <math.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+ColorGradient::ColorGradient(GradientSpace space) :
+	space(space), rampSize(0)
+{
+
+}
+
+/**
+ * Adds a stop. Stops may be added in any order; stops at the same position
+ * give a hard edge. Drops the baked ramp, so sample() fails until the next
+ * bake().
+ * 
+ * @param position
+ *            position along the gradient, usually 0..1
+ * @param color
+ *            color at the stop
+ * @param easing
+ *            easing of the segment that starts at this stop
+ * @return itself
+ */
+ColorGradient* ColorGradient::addStop(float position, const OColor& color, GradientEasing easing) {
+	Stop stop;
+	stop.position = position;
+	stop.color = color;
+	stop.easing = easing;
+	size_t i = stops.size();
+	while (i > 0 && stops[i - 1].position > position) {
+		i--;
+	}
+	stops.insert(stops.begin() + i, stop);
+	convertStops();
+	ramp.clear();
+	rampSize = 0;
+	return this;
+}
+
+/**
+ * Removes all stops and the baked ramp.
+ * 
+ * @return itself
+ */
+ColorGradient* ColorGradient::clear() {
+	stops.clear();
+	ramp.clear();
+	rampSize = 0;
+	return this;
+}
+
+/**
+ * Changes the interpolation space. Drops the baked ramp, so sample() fails
+ * until the next bake().
+ * 
+ * @param space
+ * @return itself
+ */
+ColorGradient* ColorGradient::setSpace(GradientSpace space) {
+	this->space = space;
+	convertStops();
+	ramp.clear();
+	rampSize = 0;
+	return this;
+}
+
+GradientSpace ColorGradient::getSpace() const
+{
+	return space;
+}
+
+size_t ColorGradient::getStopCount() const
+{
+	return stops.size();
+}
+
+float ColorGradient::getStopPosition(size_t index) const
+{
+	return stops[index].position;
+}
+
+OColor ColorGradient::getStopColor(size_t index) const
+{
+	return stops[index].color;
+}
+
+/**
+ * Converts the stops into the interpolation space. For hue spaces an
+ * achromatic stop takes the hue of its nearest chromatic neighbour.
+ */
+void ColorGradient::convertStops()
+{
+	for (size_t i = 0; i < stops.size(); i++) {
+		toSpace(space, stops[i].color, stops[i].coords);
+		stops[i].coords[3] = stops[i].color.getAlpha();
+	}
+	if (space != GRADIENT_HSV && space != GRADIENT_OKLCH) {
+		return;
+	}
+	const float grey = 1E-4f;
+	int h = (space == GRADIENT_HSV) ? 0 : 2;
+	for (size_t i = 0; i < stops.size(); i++) {
+		if (stops[i].coords[1] > grey) {
+			continue;
+		}
+		for (size_t d = 1; d < stops.size(); d++) {
+			if (i >= d && stops[i - d].coords[1] > grey) {
+				stops[i].coords[h] = stops[i - d].coords[h];
+				break;
+			}
+			if (i + d < stops.size() && stops[i + d].coords[1] > grey) {
+				stops[i].coords[h] = stops[i + d].coords[h];
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Evaluates the gradient exactly, without the ramp.
+ * 
+ * @param t
+ *            position along the gradient; positions outside the stops give
+ *            the first or last stop color
+ * @param rgba
+ *            result array of 4 floats
+ */
+void ColorGradient::getColor(float t, float* rgba) const
+{
+	if (stops.empty()) {
+		rgba[0] = rgba[1] = rgba[2] = 0;
+		rgba[3] = 1;
+		return;
+	}
+	size_t next = 0;
+	while (next < stops.size() && stops[next].position <= t) {
+		next++;
+	}
+	const Stop& a = stops[next > 0 ? next - 1 : 0];
+	const Stop& b = stops[next < stops.size() ? next : stops.size() - 1];
+	float f = 0;
+	if (next > 0 && next < stops.size() && b.position > a.position) {
+		f = ease(a.easing, (t - a.position) / (b.position - a.position));
+	}
+
+	float coords[3];
+	for (int k = 0; k < 3; k++) {
+		coords[k] = a.coords[k] + (b.coords[k] - a.coords[k]) * f;
+	}
+	if (space == GRADIENT_HSV || space == GRADIENT_OKLCH) {
+		int h = (space == GRADIENT_HSV) ? 0 : 2;
+		float dh = b.coords[h] - a.coords[h];
+		dh -= floorf(dh + 0.5f);
+		coords[h] = a.coords[h] + dh * f;
+		coords[h] -= floorf(coords[h]);
+		// tiny negative hues round up to exactly 1
+		if (coords[h] >= 1) {
+			coords[h] = 0;
+		}
+	}
+	fromSpace(space, coords, rgba);
+	rgba[3] = a.coords[3] + (b.coords[3] - a.coords[3]) * f;
+}
+
+/**
+ * @param t
+ *            position along the gradient
+ * @return color at t
+ */
+OColor ColorGradient::getColor(float t) const
+{
+	float rgba[4];
+	getColor(t, rgba);
+	return OColor::newRGBA(rgba[0], rgba[1], rgba[2], rgba[3]);
+}
+
+/**
+ * Evaluates the gradient at size evenly spaced positions between the first
+ * and the last stop into the lookup ramp used by sample().
+ * 
+ * @param size
+ *            number of ramp entries, at least 2
+ * @return false if there are no stops or size is too small
+ */
+bool ColorGradient::bake(int size)
+{
+	if (stops.empty() || size < 2) {
+		return false;
+	}
+	rampSize = size;
+	ramp.resize((size_t) (size + 1) * 4);
+	float first = stops.front().position;
+	float range = stops.back().position - first;
+	for (int i = 0; i <= size; i++) {
+		float rgba[4];
+		getColor(first + range * (i < size ? i : size - 1) / (size - 1), rgba);
+		for (int c = 0; c < 4; c++) {
+			ramp[c * (size + 1) + i] = rgba[c];
+		}
+	}
+	return true;
+}
+
+/**
+ * @return number of ramp entries, 0 if not baked
+ */
+int ColorGradient::getRampSize() const
+{
+	return rampSize;
+}
+
+/**
+ * @param channel
+ *            0..3 for red, green, blue, alpha
+ * @return plane of getRampSize() values of that channel, NULL if not baked
+ */
+const float* ColorGradient::getRamp(int channel) const
+{
+	return ramp.empty() ? NULL : &ramp[channel * (rampSize + 1)];
+}
+
+/**
+ * Samples the baked ramp, interpolating linearly between entries.
+ * Parameters are relative to the baked range: 0 is the first stop, 1 the
+ * last; values outside are clamped.
+ * 
+ * @param t
+ *            gradient parameters
+ * @param rgba
+ *            result array of count * 4 floats
+ * @param count
+ *            number of parameters
+ * @return false if the gradient has not been baked
+ */
+bool ColorGradient::sample(const float* t, float* rgba, size_t count) const
+{
+	if (ramp.empty()) {
+		return false;
+	}
+	const float* planes[4] = { getRamp(0), getRamp(1), getRamp(2), getRamp(3) };
+	const float scale = (float) (rampSize - 1);
+	size_t i = 0;
+#if defined(__AVX2__)
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1);
+	const __m256 vscale = _mm256_set1_ps(scale);
+	for (; i + 8 <= count; i += 8) {
+		// max() first so NaN parameters map to 0
+		__m256 x = _mm256_mul_ps(_mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(t + i), zero), one), vscale);
+		__m256i j = _mm256_cvttps_epi32(x);
+		__m256 f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(j));
+		__m256 v[4];
+		for (int c = 0; c < 4; c++) {
+			__m256 a = _mm256_i32gather_ps(planes[c], j, 4);
+			__m256 b = _mm256_i32gather_ps(planes[c] + 1, j, 4);
+			v[c] = _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), f));
+		}
+		// planar to interleaved RGBA
+		__m256 rg0 = _mm256_unpacklo_ps(v[0], v[1]);
+		__m256 rg1 = _mm256_unpackhi_ps(v[0], v[1]);
+		__m256 ba0 = _mm256_unpacklo_ps(v[2], v[3]);
+		__m256 ba1 = _mm256_unpackhi_ps(v[2], v[3]);
+		__m256 p0 = _mm256_shuffle_ps(rg0, ba0, 0x44);
+		__m256 p1 = _mm256_shuffle_ps(rg0, ba0, 0xEE);
+		__m256 p2 = _mm256_shuffle_ps(rg1, ba1, 0x44);
+		__m256 p3 = _mm256_shuffle_ps(rg1, ba1, 0xEE);
+		float* out = rgba + i * 4;
+		_mm256_storeu_ps(out, _mm256_permute2f128_ps(p0, p1, 0x20));
+		_mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(p2, p3, 0x20));
+		_mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(p0, p1, 0x31));
+		_mm256_storeu_ps(out + 24, _mm256_permute2f128_ps(p2, p3, 0x31));
+	}
+#endif
+	for (; i < count; i++) {
+		float x = t[i];
+		x = (x > 0 ? (x < 1 ? x : 1) : 0) * scale;
+		int j = (int) x;
+		float f = x - j;
+		for (int c = 0; c < 4; c++) {
+			rgba[i * 4 + c] = planes[c][j] + (planes[c][j + 1] - planes[c][j]) * f;
+		}
+	}
+	return true;
+}
+
+/**
+ * @param easing
+ * @param t
+ *            0..1
+ * @return eased factor, 0..1
+ */
+float ColorGradient::ease(GradientEasing easing, float t)
+{
+	switch (easing) {
+	case GRADIENT_EASE_IN:
+		return t * t;
+	case GRADIENT_EASE_OUT:
+		return t * (2 - t);
+	case GRADIENT_EASE_IN_OUT:
+		return t * t * (3 - 2 * t);
+	case GRADIENT_EASE_STEP:
+		return t < 1 ? 0.0f : 1.0f;
+	default:
+		return t;
+	}
+}
+
+/**
+ * Converts a color into gradient interpolation coordinates. Hues are
+ * normalized to 0..1: HSV keeps it first, OKLCh last.
+ * 
+ * @param space
+ * @param color
+ * @param coords
+ *            result array of 3 floats
+ */
+void ColorGradient::toSpace(GradientSpace space, const OColor& color, float* coords)
+{
+	float r = color.getRed_RGB(), g = color.getGreen_RGB(), b = color.getBlue_RGB();
+	switch (space) {
+	case GRADIENT_LINEAR_RGB:
+		coords[0] = OColor::srgbToLinear(r);
+		coords[1] = OColor::srgbToLinear(g);
+		coords[2] = OColor::srgbToLinear(b);
+		break;
+	case GRADIENT_HSV:
+		OColor::rgbToHSV(r, g, b, coords);
+		break;
+	case GRADIENT_LAB:
+		OColor::rgbToLab(r, g, b, coords);
+		break;
+	case GRADIENT_OKLAB:
+		OColor::rgbToOKLab(r, g, b, coords);
+		break;
+	case GRADIENT_OKLCH:
+		OColor::rgbToOKLCh(r, g, b, coords);
+		break;
+	default:
+		coords[0] = r;
+		coords[1] = g;
+		coords[2] = b;
+		break;
+	}
+}
+
+/**
+ * Converts gradient interpolation coordinates back to RGB, clipped to
+ * 0..1.
+ * 
+ * @param space
+ * @param coords
+ * @param rgb
+ *            result array of 3 floats
+ */
+void ColorGradient::fromSpace(GradientSpace space, const float* coords, float* rgb)
+{
+	switch (space) {
+	case GRADIENT_LINEAR_RGB:
+		for (int k = 0; k < 3; k++) {
+			rgb[k] = OColor::linearToSRGB(coords[k]);
+		}
+		break;
+	case GRADIENT_HSV:
+		OColor::hsvToRGB(coords[0], coords[1], coords[2], rgb);
+		break;
+	case GRADIENT_LAB:
+		OColor::labToRGB(coords[0], coords[1], coords[2], rgb);
+		break;
+	case GRADIENT_OKLAB:
+		OColor::oklabToRGB(coords[0], coords[1], coords[2], rgb);
+		break;
+	case GRADIENT_OKLCH:
+		OColor::oklchToRGB(coords[0], coords[1], coords[2], rgb);
+		break;
+	default:
+		for (int k = 0; k < 3; k++) {
+			rgb[k] = coords[k];
+		}
+		break;
+	}
+	for (int k = 0; k < 3; k++) {
+		rgb[k] = MathUtils::clip(rgb[k], 0.0f, 1.0f);
+	}
+}
\ No newline at end of file
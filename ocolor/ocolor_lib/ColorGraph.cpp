@@ -0,0 +1,391 @@
+#include "ColorGraph.h"
+#include "OKLab.h"
+#include <cstring>
+#include <mutex>
+
+static const Vector3 NO_OFFSET = {{ 0, 0, 0 }};
+
+// guards the edge list against addEdge() calls racing with plan()
+static mutex& registryMutex()
+{
+	static mutex m;
+	return m;
+}
+
+static void applyAffine(const Matrix3& m, const Vector3& o, const float* src, float* dst, size_t count)
+{
+	const float m0 = (float) m.m[0], m1 = (float) m.m[1], m2 = (float) m.m[2];
+	const float m3 = (float) m.m[3], m4 = (float) m.m[4], m5 = (float) m.m[5];
+	const float m6 = (float) m.m[6], m7 = (float) m.m[7], m8 = (float) m.m[8];
+	const float o0 = (float) o.v[0], o1 = (float) o.v[1], o2 = (float) o.v[2];
+	for (size_t i = 0; i < count * 3; i += 3) {
+		float a = src[i];
+		float b = src[i + 1];
+		float c = src[i + 2];
+		dst[i] = m0 * a + m1 * b + m2 * c + o0;
+		dst[i + 1] = m3 * a + m4 * b + m5 * c + o1;
+		dst[i + 2] = m6 * a + m7 * b + m8 * c + o2;
+	}
+}
+
+template<float (*Fn)(float)>
+static void transfer(const float* src, float* dst, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i++) {
+		dst[i] = Fn(src[i]);
+	}
+}
+
+static void xyzToLab(const float* src, float* dst, size_t count)
+{
+	XYZ::toLab(src, dst, count, WhitePoint::D65());
+}
+
+static void labToXYZ(const float* src, float* dst, size_t count)
+{
+	XYZ::fromLab(src, dst, count, WhitePoint::D65());
+}
+
+static void linearToOKLab(const float* src, float* dst, size_t count)
+{
+	OKLab::fromLinearRGB(src, dst, count);
+}
+
+static void oklabToLinear(const float* src, float* dst, size_t count)
+{
+	OKLab::toLinearRGB(src, dst, count);
+}
+
+static void oklabToOKLCh(const float* src, float* dst, size_t count)
+{
+	OKLab::toLCh(src, dst, count);
+}
+
+static void oklchToOKLab(const float* src, float* dst, size_t count)
+{
+	OKLab::fromLCh(src, dst, count);
+}
+
+static void rgbToHSV(const float* src, float* dst, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::rgbToHSV(src[i], src[i + 1], src[i + 2], dst + i);
+	}
+}
+
+static void hsvToRGB(const float* src, float* dst, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::hsvToRGB(src[i], src[i + 1], src[i + 2], dst + i);
+	}
+}
+
+static void rgbToCMYK(const float* src, float* dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		OColor::rgbToCMYK(src[i * 3], src[i * 3 + 1], src[i * 3 + 2], dst + i * 4);
+	}
+}
+
+static void cmykToRGB(const float* src, float* dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		OColor::cmykToRGB(src[i * 4], src[i * 4 + 1], src[i * 4 + 2], src[i * 4 + 3], dst + i * 3);
+	}
+}
+
+/**
+ * Derives the affine form of the full range YCbCr encoding by probing
+ * OColor::rgbToYCbCr(), so both always agree.
+ */
+static void ycbcrAffine(YCbCrStandard standard, Matrix3& m, Vector3& o)
+{
+	float zero[3], unit[3];
+	OColor::rgbToYCbCr(0, 0, 0, standard, true, zero);
+	for (int c = 0; c < 3; c++) {
+		OColor::rgbToYCbCr(c == 0 ? 1 : 0, c == 1 ? 1 : 0, c == 2 ? 1 : 0, standard, true, unit);
+		for (int r = 0; r < 3; r++) {
+			m.m[r * 3 + c] = unit[r] - zero[r];
+		}
+	}
+	for (int r = 0; r < 3; r++) {
+		o.v[r] = zero[r];
+	}
+}
+
+static Vector3 negative(const Vector3& v)
+{
+	Vector3 n = {{ -v.v[0], -v.v[1], -v.v[2] }};
+	return n;
+}
+
+static Vector3 add(const Vector3& a, const Vector3& b)
+{
+	Vector3 s = {{ a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2] }};
+	return s;
+}
+
+ConversionPlan::ConversionPlan() :
+	cost(0), valid(false), inputChannels(0), outputChannels(0)
+{
+
+}
+
+/**
+ * @return false if no path exists between the requested spaces
+ */
+bool ConversionPlan::isValid() const {
+	return valid;
+}
+
+/**
+ * @return estimated cost per pixel of the planned path
+ */
+float ConversionPlan::getCost() const {
+	return cost;
+}
+
+/**
+ * @return number of passes after fusion
+ */
+size_t ConversionPlan::getStepCount() const {
+	return steps.size();
+}
+
+int ConversionPlan::getInputChannels() const {
+	return inputChannels;
+}
+
+int ConversionPlan::getOutputChannels() const {
+	return outputChannels;
+}
+
+/**
+ * Runs the plan over a buffer, one tile at a time.
+ * 
+ * @param src
+ *            count interleaved colors of the source space
+ * @param dst
+ *            count interleaved colors of the destination space; may be the
+ *            same as src if both have the same channel count
+ * @param count
+ *            number of colors
+ */
+void ConversionPlan::run(const float* src, float* dst, size_t count) const
+{
+	float a[TILE * 4];
+	float b[TILE * 4];
+	for (size_t start = 0; start < count; start += TILE) {
+		size_t n = (count - start < TILE) ? count - start : TILE;
+		const float* in = src + start * inputChannels;
+		float* target = dst + start * outputChannels;
+		if (steps.empty() || (const float*) target == in) {
+			memcpy(a, in, n * inputChannels * sizeof(float));
+			in = a;
+			if (steps.empty()) {
+				memcpy(target, a, n * outputChannels * sizeof(float));
+				continue;
+			}
+		}
+		for (size_t s = 0; s < steps.size(); s++) {
+			const ConversionStep& step = steps[s];
+			float* out = (s + 1 == steps.size()) ? target : (in == a ? b : a);
+			if (step.affine) {
+				applyAffine(step.matrix, step.offset, in, out, n);
+			}
+			else {
+				step.function(in, out, n);
+			}
+			in = out;
+		}
+	}
+}
+
+/**
+ * @param space
+ * @return number of floats per color in the given space
+ */
+int ColorGraph::getChannels(ColorSpaceId space) {
+	return space == SPACE_CMYK ? 4 : 3;
+}
+
+/**
+ * Registers a conversion function between two spaces. Plans already cached
+ * by convert() are not affected, so register edges before the conversions
+ * that need them run, and before converting from several threads.
+ * 
+ * @param from
+ * @param to
+ * @param cost
+ *            estimated cost per pixel, in multiply-adds
+ * @param function
+ */
+void ColorGraph::addEdge(ColorSpaceId from, ColorSpaceId to, float cost, ConversionFunction function) {
+	lock_guard<mutex> lock(registryMutex());
+	addEdge(edges(), from, to, cost, function);
+}
+
+/**
+ * Registers an affine conversion (dst = matrix * src + offset) between two
+ * 3 channel spaces. Affine edges are fused with adjacent affine edges when
+ * a plan is built.
+ * 
+ * @param from
+ * @param to
+ * @param cost
+ * @param matrix
+ * @param offset
+ */
+void ColorGraph::addAffineEdge(ColorSpaceId from, ColorSpaceId to, float cost, const Matrix3& matrix, const Vector3& offset) {
+	lock_guard<mutex> lock(registryMutex());
+	addAffineEdge(edges(), from, to, cost, matrix, offset);
+}
+
+void ColorGraph::addEdge(vector<ConversionEdge>& list, ColorSpaceId from, ColorSpaceId to, float cost, ConversionFunction function) {
+	ConversionEdge edge;
+	edge.from = from;
+	edge.to = to;
+	edge.cost = cost;
+	edge.step.function = function;
+	edge.step.affine = false;
+	edge.step.matrix = Mat3::identity();
+	edge.step.offset = NO_OFFSET;
+	edge.step.inputChannels = getChannels(from);
+	edge.step.outputChannels = getChannels(to);
+	list.push_back(edge);
+}
+
+void ColorGraph::addAffineEdge(vector<ConversionEdge>& list, ColorSpaceId from, ColorSpaceId to, float cost, const Matrix3& matrix, const Vector3& offset) {
+	addEdge(list, from, to, cost, NULL);
+	list.back().step.affine = true;
+	list.back().step.matrix = matrix;
+	list.back().step.offset = offset;
+}
+
+// built once by the thread-safe local static initialization; callers hold
+// registryMutex() while they use the list
+vector<ConversionEdge>& ColorGraph::edges() {
+	static vector<ConversionEdge> list = [] {
+		vector<ConversionEdge> builtin;
+		addBuiltinEdges(builtin);
+		return builtin;
+	}();
+	return list;
+}
+
+void ColorGraph::addBuiltinEdges(vector<ConversionEdge>& list) {
+	// transfer curves: three pow() calls per pixel
+	addEdge(list, SPACE_RGB, SPACE_LINEAR_RGB, 12, transfer<SRGBSpace::decode>);
+	addEdge(list, SPACE_LINEAR_RGB, SPACE_RGB, 12, transfer<SRGBSpace::encode>);
+	addEdge(list, SPACE_DISPLAY_P3, SPACE_LINEAR_P3, 12, transfer<DisplayP3Space::decode>);
+	addEdge(list, SPACE_LINEAR_P3, SPACE_DISPLAY_P3, 12, transfer<DisplayP3Space::encode>);
+	addEdge(list, SPACE_REC2020, SPACE_LINEAR_REC2020, 12, transfer<Rec2020Space::decode>);
+	addEdge(list, SPACE_LINEAR_REC2020, SPACE_REC2020, 12, transfer<Rec2020Space::encode>);
+	addEdge(list, SPACE_ADOBE_RGB, SPACE_LINEAR_ADOBE_RGB, 12, transfer<AdobeRGBSpace::decode>);
+	addEdge(list, SPACE_LINEAR_ADOBE_RGB, SPACE_ADOBE_RGB, 12, transfer<AdobeRGBSpace::encode>);
+
+	// linear working spaces around the XYZ D65 hub
+	addAffineEdge(list, SPACE_LINEAR_RGB, SPACE_XYZ_D65, 1, ColorSpaceConversion<LinearSRGBSpace, XYZD65Space>::matrix(), NO_OFFSET);
+	addAffineEdge(list, SPACE_XYZ_D65, SPACE_LINEAR_RGB, 1, ColorSpaceConversion<XYZD65Space, LinearSRGBSpace>::matrix(), NO_OFFSET);
+	addAffineEdge(list, SPACE_LINEAR_P3, SPACE_XYZ_D65, 1, DisplayP3Space::toXYZ(), NO_OFFSET);
+	addAffineEdge(list, SPACE_XYZ_D65, SPACE_LINEAR_P3, 1, Mat3::inverse(DisplayP3Space::toXYZ()), NO_OFFSET);
+	addAffineEdge(list, SPACE_LINEAR_REC2020, SPACE_XYZ_D65, 1, Rec2020Space::toXYZ(), NO_OFFSET);
+	addAffineEdge(list, SPACE_XYZ_D65, SPACE_LINEAR_REC2020, 1, Mat3::inverse(Rec2020Space::toXYZ()), NO_OFFSET);
+	addAffineEdge(list, SPACE_LINEAR_ADOBE_RGB, SPACE_XYZ_D65, 1, AdobeRGBSpace::toXYZ(), NO_OFFSET);
+	addAffineEdge(list, SPACE_XYZ_D65, SPACE_LINEAR_ADOBE_RGB, 1, Mat3::inverse(AdobeRGBSpace::toXYZ()), NO_OFFSET);
+	addAffineEdge(list, SPACE_XYZ_D65, SPACE_XYZ_D50, 1, ColorSpaceConversion<XYZD65Space, XYZD50Space>::matrix(), NO_OFFSET);
+	addAffineEdge(list, SPACE_XYZ_D50, SPACE_XYZ_D65, 1, ColorSpaceConversion<XYZD50Space, XYZD65Space>::matrix(), NO_OFFSET);
+
+	// perceptual spaces
+	addEdge(list, SPACE_XYZ_D65, SPACE_LAB, 5, xyzToLab);
+	addEdge(list, SPACE_LAB, SPACE_XYZ_D65, 3, labToXYZ);
+	addEdge(list, SPACE_LINEAR_RGB, SPACE_OKLAB, 5, linearToOKLab);
+	addEdge(list, SPACE_OKLAB, SPACE_LINEAR_RGB, 3, oklabToLinear);
+	addEdge(list, SPACE_OKLAB, SPACE_OKLCH, 6, oklabToOKLCh);
+	addEdge(list, SPACE_OKLCH, SPACE_OKLAB, 5, oklchToOKLab);
+
+	// spaces derived from encoded sRGB
+	addEdge(list, SPACE_RGB, SPACE_HSV, 2, rgbToHSV);
+	addEdge(list, SPACE_HSV, SPACE_RGB, 2, hsvToRGB);
+	addEdge(list, SPACE_RGB, SPACE_CMYK, 2, rgbToCMYK);
+	addEdge(list, SPACE_CMYK, SPACE_RGB, 1, cmykToRGB);
+
+	Matrix3 m;
+	Vector3 o;
+	ycbcrAffine(YCBCR_BT601, m, o);
+	addAffineEdge(list, SPACE_RGB, SPACE_YCBCR_601, 1, m, o);
+	addAffineEdge(list, SPACE_YCBCR_601, SPACE_RGB, 1, Mat3::inverse(m), negative(Mat3::multiply(Mat3::inverse(m), o)));
+	ycbcrAffine(YCBCR_BT709, m, o);
+	addAffineEdge(list, SPACE_RGB, SPACE_YCBCR_709, 1, m, o);
+	addAffineEdge(list, SPACE_YCBCR_709, SPACE_RGB, 1, Mat3::inverse(m), negative(Mat3::multiply(Mat3::inverse(m), o)));
+}
+
+/**
+ * Finds the cheapest path between two spaces and fuses consecutive affine
+ * edges into single steps.
+ * 
+ * @param from
+ * @param to
+ * @return the plan; check isValid() in case the spaces are not connected
+ */
+ConversionPlan ColorGraph::plan(ColorSpaceId from, ColorSpaceId to)
+{
+	lock_guard<mutex> lock(registryMutex());
+	const vector<ConversionEdge>& list = edges();
+	float dist[SPACE_COUNT];
+	int via[SPACE_COUNT];
+	bool done[SPACE_COUNT];
+	for (int i = 0; i < SPACE_COUNT; i++) {
+		dist[i] = 1E30f;
+		via[i] = -1;
+		done[i] = false;
+	}
+	dist[from] = 0;
+
+	// Dijkstra; the graph is tiny so a linear scan for the minimum will do
+	for (;;) {
+		int u = -1;
+		for (int i = 0; i < SPACE_COUNT; i++) {
+			if (!done[i] && dist[i] < 1E30f && (u < 0 || dist[i] < dist[u])) {
+				u = i;
+			}
+		}
+		if (u < 0 || u == to) {
+			break;
+		}
+		done[u] = true;
+		for (size_t e = 0; e < list.size(); e++) {
+			if (list[e].from == u && dist[u] + list[e].cost < dist[list[e].to]) {
+				dist[list[e].to] = dist[u] + list[e].cost;
+				via[list[e].to] = (int) e;
+			}
+		}
+	}
+
+	ConversionPlan result;
+	result.inputChannels = getChannels(from);
+	result.outputChannels = getChannels(to);
+	if (from != to && via[to] < 0) {
+		return result;
+	}
+	result.valid = true;
+	result.cost = dist[to];
+
+	vector<ConversionStep> path;
+	for (int node = to; node != from; node = list[via[node]].from) {
+		path.insert(path.begin(), list[via[node]].step);
+	}
+	for (size_t i = 0; i < path.size(); i++) {
+		if (path[i].affine && !result.steps.empty() && result.steps.back().affine) {
+			// (M2, o2) after (M1, o1) is (M2 * M1, M2 * o1 + o2)
+			ConversionStep& prev = result.steps.back();
+			prev.offset = add(Mat3::multiply(path[i].matrix, prev.offset), path[i].offset);
+			prev.matrix = Mat3::multiply(path[i].matrix, prev.matrix);
+			prev.outputChannels = path[i].outputChannels;
+		}
+		else {
+			result.steps.push_back(path[i]);
+		}
+	}
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+#include "ColorMatrix.h"
+#include <math.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Creates the identity transform.
+ */
+ColorMatrix::ColorMatrix()
+{
+	memset(m, 0, sizeof(m));
+	m[0] = m[6] = m[12] = m[18] = 1;
+}
+
+/**
+ * @param values
+ *            20 floats, row by row
+ */
+ColorMatrix::ColorMatrix(const float* values)
+{
+	memcpy(m, values, sizeof(m));
+}
+
+/**
+ * @return transform multiplying each channel by a factor
+ */
+ColorMatrix ColorMatrix::newScale(float r, float g, float b, float a)
+{
+	ColorMatrix c;
+	c.m[0] = r;
+	c.m[6] = g;
+	c.m[12] = b;
+	c.m[18] = a;
+	return c;
+}
+
+/**
+ * The matrix form of OColor::adjustRGB().
+ * 
+ * @return transform adding an offset to each channel
+ */
+ColorMatrix ColorMatrix::newOffset(float r, float g, float b, float a)
+{
+	ColorMatrix c;
+	c.m[4] = r;
+	c.m[9] = g;
+	c.m[14] = b;
+	c.m[19] = a;
+	return c;
+}
+
+/**
+ * The matrix form of OColor::invertRGB().
+ * 
+ * @return transform inverting RGB
+ */
+ColorMatrix ColorMatrix::newInvert()
+{
+	ColorMatrix c = newScale(-1, -1, -1);
+	c.m[4] = c.m[9] = c.m[14] = 1;
+	return c;
+}
+
+/**
+ * Scales the distance to the grey of equal luminance (the weights of
+ * OColor::getLuminance()).
+ * 
+ * @param s
+ *            0 for grey, 1 for no change, above 1 to saturate
+ * @return saturation transform
+ */
+ColorMatrix ColorMatrix::newSaturation(float s)
+{
+	const float luma[3] = { 0.299f, 0.587f, 0.114f };
+	ColorMatrix c;
+	for (int row = 0; row < 3; row++) {
+		for (int col = 0; col < 3; col++) {
+			c.m[row * 5 + col] = luma[col] * (1 - s) + (row == col ? s : 0);
+		}
+	}
+	return c;
+}
+
+/**
+ * @return transform to grey of equal luminance
+ */
+ColorMatrix ColorMatrix::newGrayscale()
+{
+	return newSaturation(0);
+}
+
+/**
+ * Scales RGB around mid grey. Unlike OColor::adjustContrast(), which moves
+ * the brightness of a single color towards black or white, this is linear
+ * and can be composed.
+ * 
+ * @param c
+ *            0 for flat grey, 1 for no change, above 1 for more contrast
+ * @return contrast transform
+ */
+ColorMatrix ColorMatrix::newContrast(float c)
+{
+	float offset = 0.5f * (1 - c);
+	return newScale(c, c, c).then(newOffset(offset, offset, offset));
+}
+
+/**
+ * @param amount
+ *            offset added to RGB
+ * @return brightness transform
+ */
+ColorMatrix ColorMatrix::newBrightness(float amount)
+{
+	return newOffset(amount, amount, amount);
+}
+
+/**
+ * @param amount
+ *            0 for no change, 1 for full sepia tone
+ * @return sepia transform
+ */
+ColorMatrix ColorMatrix::newSepia(float amount)
+{
+	const float sepia[9] = {
+		0.393f, 0.769f, 0.189f,
+		0.349f, 0.686f, 0.168f,
+		0.272f, 0.534f, 0.131f
+	};
+	ColorMatrix c;
+	for (int row = 0; row < 3; row++) {
+		for (int col = 0; col < 3; col++) {
+			c.m[row * 5 + col] += (sepia[row * 3 + col] - c.m[row * 5 + col]) * amount;
+		}
+	}
+	return c;
+}
+
+/**
+ * Rotates hues while keeping luminance, as the SVG feColorMatrix
+ * hueRotate filter.
+ * 
+ * @param theta
+ *            rotation angle (in radians)
+ * @return hue rotation transform
+ */
+ColorMatrix ColorMatrix::newHueRotation(float theta)
+{
+	float cs = cosf(theta), sn = sinf(theta);
+	const float values[20] = {
+		0.213f + cs * 0.787f - sn * 0.213f, 0.715f - cs * 0.715f - sn * 0.715f, 0.072f - cs * 0.072f + sn * 0.928f, 0, 0,
+		0.213f - cs * 0.213f + sn * 0.143f, 0.715f + cs * 0.285f + sn * 0.140f, 0.072f - cs * 0.072f - sn * 0.283f, 0, 0,
+		0.213f - cs * 0.213f - sn * 0.787f, 0.715f - cs * 0.715f + sn * 0.715f, 0.072f + cs * 0.928f + sn * 0.072f, 0, 0,
+		0, 0, 0, 1, 0
+	};
+	return ColorMatrix(values);
+}
+
+/**
+ * @param mix
+ *            3x3 matrix, row by row: the weights of R, G and B in each
+ *            result channel
+ * @return channel mixing transform
+ */
+ColorMatrix ColorMatrix::newChannelMix(const float* mix)
+{
+	ColorMatrix c;
+	for (int row = 0; row < 3; row++) {
+		for (int col = 0; col < 3; col++) {
+			c.m[row * 5 + col] = mix[row * 3 + col];
+		}
+	}
+	return c;
+}
+
+/**
+ * @param next
+ *            transform to apply after this one
+ * @return combined transform
+ */
+ColorMatrix ColorMatrix::then(const ColorMatrix& next) const
+{
+	return next * (*this);
+}
+
+/**
+ * @param other
+ *            transform applied first
+ * @return transform applying other, then this
+ */
+ColorMatrix ColorMatrix::operator*(const ColorMatrix& other) const
+{
+	ColorMatrix c;
+	for (int row = 0; row < 4; row++) {
+		for (int col = 0; col < 5; col++) {
+			float v = (col == 4) ? m[row * 5 + 4] : 0;
+			for (int k = 0; k < 4; k++) {
+				v += m[row * 5 + k] * other.m[k * 5 + col];
+			}
+			c.m[row * 5 + col] = v;
+		}
+	}
+	return c;
+}
+
+/**
+ * @return true if the transform changes nothing
+ */
+bool ColorMatrix::isIdentity() const
+{
+	ColorMatrix identity;
+	return memcmp(m, identity.m, sizeof(m)) == 0;
+}
+
+/**
+ * @param rgba
+ *            4 floats
+ * @param result
+ *            result array of 4 floats, clipped to 0..1; may be rgba
+ */
+void ColorMatrix::apply(const float* rgba, float* result) const
+{
+	float in[4] = { rgba[0], rgba[1], rgba[2], rgba[3] };
+	for (int row = 0; row < 4; row++) {
+		const float* r = m + row * 5;
+		float v = r[0] * in[0] + r[1] * in[1] + r[2] * in[2] + r[3] * in[3] + r[4];
+		result[row] = v < 0 ? 0 : (v > 1 ? 1 : v);
+	}
+}
+
+/**
+ * @param color
+ * @return transformed copy of the color
+ */
+OColor ColorMatrix::apply(const OColor& color) const
+{
+	float rgba[4] = { color.getRed_RGB(), color.getGreen_RGB(), color.getBlue_RGB(), color.getAlpha() };
+	apply(rgba, rgba);
+	return OColor::newRGBA(rgba[0], rgba[1], rgba[2], rgba[3]);
+}
+
+/**
+ * Transforms interleaved RGBA floats; src and dst may be the same buffer.
+ * 
+ * @param src
+ *            count * 4 floats
+ * @param dst
+ *            result, count * 4 floats clipped to 0..1
+ * @param count
+ *            number of pixels
+ */
+void ColorMatrix::apply(const float* src, float* dst, size_t count) const
+{
+#if defined(__SSE2__)
+	// one column per input channel, so a pixel is four broadcast multiply-adds
+	const __m128 c0 = _mm_setr_ps(m[0], m[5], m[10], m[15]);
+	const __m128 c1 = _mm_setr_ps(m[1], m[6], m[11], m[16]);
+	const __m128 c2 = _mm_setr_ps(m[2], m[7], m[12], m[17]);
+	const __m128 c3 = _mm_setr_ps(m[3], m[8], m[13], m[18]);
+	const __m128 c4 = _mm_setr_ps(m[4], m[9], m[14], m[19]);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1);
+	for (size_t i = 0; i < count; i++) {
+		__m128 p = _mm_loadu_ps(src + i * 4);
+		__m128 v = _mm_add_ps(c4, _mm_mul_ps(c0, _mm_shuffle_ps(p, p, 0x00)));
+		v = _mm_add_ps(v, _mm_mul_ps(c1, _mm_shuffle_ps(p, p, 0x55)));
+		v = _mm_add_ps(v, _mm_mul_ps(c2, _mm_shuffle_ps(p, p, 0xAA)));
+		v = _mm_add_ps(v, _mm_mul_ps(c3, _mm_shuffle_ps(p, p, 0xFF)));
+		_mm_storeu_ps(dst + i * 4, _mm_min_ps(_mm_max_ps(v, zero), one));
+	}
+#else
+	for (size_t i = 0; i < count; i++) {
+		apply(src + i * 4, dst + i * 4);
+	}
+#endif
+}
+
+/**
+ * Transforms 8 bit pixels with 4 channels in any order; src and dst may be
+ * the same buffer.
+ * 
+ * @param src
+ *            count * 4 bytes
+ * @param dst
+ *            result, count * 4 bytes
+ * @param count
+ *            number of pixels
+ * @param red
+ *            byte position of red within a pixel
+ * @param green
+ *            byte position of green
+ * @param blue
+ *            byte position of blue
+ * @param alpha
+ *            byte position of alpha
+ */
+void ColorMatrix::apply(const unsigned char* src, unsigned char* dst, size_t count, int red, int green, int blue, int alpha) const
+{
+	// reorder the matrix into memory order and scale the offsets to 0..255
+	const int position[4] = { red, green, blue, alpha };
+	float columns[5][4];
+	for (int out = 0; out < 4; out++) {
+		for (int in = 0; in < 4; in++) {
+			columns[position[in]][position[out]] = m[out * 5 + in];
+		}
+		columns[4][position[out]] = m[out * 5 + 4] * 255;
+	}
+#if defined(__SSE2__)
+	const __m128 c0 = _mm_loadu_ps(columns[0]);
+	const __m128 c1 = _mm_loadu_ps(columns[1]);
+	const __m128 c2 = _mm_loadu_ps(columns[2]);
+	const __m128 c3 = _mm_loadu_ps(columns[3]);
+	const __m128 c4 = _mm_loadu_ps(columns[4]);
+	const __m128i zero = _mm_setzero_si128();
+	for (size_t i = 0; i < count; i++) {
+		int packed;
+		memcpy(&packed, src + i * 4, 4);
+		__m128 p = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero));
+		__m128 v = _mm_add_ps(c4, _mm_mul_ps(c0, _mm_shuffle_ps(p, p, 0x00)));
+		v = _mm_add_ps(v, _mm_mul_ps(c1, _mm_shuffle_ps(p, p, 0x55)));
+		v = _mm_add_ps(v, _mm_mul_ps(c2, _mm_shuffle_ps(p, p, 0xAA)));
+		v = _mm_add_ps(v, _mm_mul_ps(c3, _mm_shuffle_ps(p, p, 0xFF)));
+		// round to nearest, then saturate to 0..255 while packing
+		__m128i q = _mm_cvtps_epi32(v);
+		q = _mm_packus_epi16(_mm_packs_epi32(q, q), zero);
+		packed = _mm_cvtsi128_si32(q);
+		memcpy(dst + i * 4, &packed, 4);
+	}
+#else
+	for (size_t i = 0; i < count; i++) {
+		const unsigned char* p = src + i * 4;
+		float in[4] = { p[0], p[1], p[2], p[3] };
+		unsigned char* q = dst + i * 4;
+		for (int c = 0; c < 4; c++) {
+			float v = columns[4][c] + columns[0][c] * in[0] + columns[1][c] * in[1] + columns[2][c] * in[2] + columns[3][c] * in[3];
+			q[c] = (unsigned char) (v <= 0 ? 0 : (v >= 255 ? 255 : (int) (v + 0.5f)));
+		}
+	}
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "ColorPrecision.h"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Widens a buffer of half precision values to float.
+ * 
+ * @param src
+ * @param dst
+ * @param count
+ */
+void ColorPrecision::halfToFloat(const Half* src, float* dst, size_t count)
+{
+	size_t i = 0;
+#if defined(__F16C__)
+	for (; i + 8 <= count; i += 8) {
+		__m128i h = _mm_loadu_si128((const __m128i*) (src + i));
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = halfToFloat(src[i]);
+	}
+}
+
+/**
+ * Narrows a buffer of floats to half precision (round-to-nearest-even).
+ * 
+ * @param src
+ * @param dst
+ * @param count
+ */
+void ColorPrecision::floatToHalf(const float* src, Half* dst, size_t count)
+{
+	size_t i = 0;
+#if defined(__F16C__)
+	for (; i + 8 <= count; i += 8) {
+		__m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+		_mm_storeu_si128((__m128i*) (dst + i), h);
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = floatToHalf(src[i]);
+	}
+}
+
+/**
+ * Widens a buffer of floats to double.
+ * 
+ * @param src
+ * @param dst
+ * @param count
+ */
+void ColorPrecision::floatToDouble(const float* src, double* dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i] = src[i];
+	}
+}
+
+/**
+ * Narrows a buffer of doubles to float.
+ * 
+ * @param src
+ * @param dst
+ * @param count
+ */
+void ColorPrecision::doubleToFloat(const double* src, float* dst, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		dst[i] = (float) src[i];
+	}
+}
+
+/**
+ * Widens a buffer of half precision values to double. Every half value is
+ * exactly representable as float, so this goes through the float kernel in
+ * small blocks.
+ * 
+ * @param src
+ * @param dst
+ * @param count
+ */
+void ColorPrecision::halfToDouble(const Half* src, double* dst, size_t count)
+{
+	float block[256];
+	for (size_t i = 0; i < count; i += 256) {
+		size_t n = (count - i) < 256 ? (count - i) : 256;
+		halfToFloat(src + i, block, n);
+		floatToDouble(block, dst + i, n);
+	}
+}
+
+/**
+ * Narrows a buffer of doubles to half precision. Note that this rounds
+ * twice (double to float, then float to half).
+ * 
+ * @param src
+ * @param dst
+ * @param count
+ */
+void ColorPrecision::doubleToHalf(const double* src, Half* dst, size_t count)
+{
+	float block[256];
+	for (size_t i = 0; i < count; i += 256) {
+		size_t n = (count - i) < 256 ? (count - i) : 256;
+		doubleToFloat(src + i, block, n);
+		floatToHalf(block, dst + i, n);
+	}
+}
\ No newline at end of file
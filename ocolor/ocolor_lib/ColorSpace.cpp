@@ -0,0 +1,186 @@
+#include "ColorSpace.h"
+
+/**
+ * Multiplies interleaved triplets by a matrix. The coefficients are kept in
+ * registers and the loop has no branches, so it vectorizes.
+ * 
+ * @param m
+ * @param src
+ *            buffer of count * 3 floats
+ * @param dst
+ *            result buffer of count * 3 floats, may be the same as src
+ * @param count
+ *            number of triplets
+ */
+void Mat3::apply(const Matrix3& m, const float* src, float* dst, size_t count)
+{
+	const float m0 = (float) m.m[0], m1 = (float) m.m[1], m2 = (float) m.m[2];
+	const float m3 = (float) m.m[3], m4 = (float) m.m[4], m5 = (float) m.m[5];
+	const float m6 = (float) m.m[6], m7 = (float) m.m[7], m8 = (float) m.m[8];
+	for (size_t i = 0; i < count * 3; i += 3) {
+		float a = src[i];
+		float b = src[i + 1];
+		float c = src[i + 2];
+		dst[i] = m0 * a + m1 * b + m2 * c;
+		dst[i + 1] = m3 * a + m4 * b + m5 * c;
+		dst[i + 2] = m6 * a + m7 * b + m8 * c;
+	}
+}
+
+/**
+ * Multiplies planar triplets by a matrix.
+ * 
+ * @param m
+ * @param src
+ *            3 source planes of count floats
+ * @param dst
+ *            3 destination planes of count floats, may be the same as src
+ * @param count
+ *            number of triplets
+ */
+void Mat3::applyPlanar(const Matrix3& m, const float* const* src, float* const* dst, size_t count)
+{
+	const float m0 = (float) m.m[0], m1 = (float) m.m[1], m2 = (float) m.m[2];
+	const float m3 = (float) m.m[3], m4 = (float) m.m[4], m5 = (float) m.m[5];
+	const float m6 = (float) m.m[6], m7 = (float) m.m[7], m8 = (float) m.m[8];
+	const float* s0 = src[0];
+	const float* s1 = src[1];
+	const float* s2 = src[2];
+	float* d0 = dst[0];
+	float* d1 = dst[1];
+	float* d2 = dst[2];
+	for (size_t i = 0; i < count; i++) {
+		float a = s0[i];
+		float b = s1[i];
+		float c = s2[i];
+		d0[i] = m0 * a + m1 * b + m2 * c;
+		d1[i] = m3 * a + m4 * b + m5 * c;
+		d2[i] = m6 * a + m7 * b + m8 * c;
+	}
+}
+
+/**
+ * Decodes a BT.2020 encoded component to linear light.
+ * 
+ * @param v
+ * @return linear component
+ */
+float Rec2020Space::decode(float v)
+{
+	return v < 0.08124f ? v / 4.5f : (float) pow((v + 0.0993) / 1.0993, 1 / 0.45);
+}
+
+/**
+ * Encodes a linear component with the BT.2020 transfer curve.
+ * 
+ * @param v
+ * @return encoded component
+ */
+float Rec2020Space::encode(float v)
+{
+	return v < 0.018054f ? v * 4.5f : (float) (1.0993 * pow(v, 0.45) - 0.0993);
+}
+
+/**
+ * Decodes an Adobe RGB encoded component to linear light.
+ * 
+ * @param v
+ * @return linear component
+ */
+float AdobeRGBSpace::decode(float v)
+{
+	return v > 0 ? (float) pow(v, 563 / 256.0) : 0;
+}
+
+/**
+ * Encodes a linear component with the Adobe RGB gamma.
+ * 
+ * @param v
+ * @return encoded component
+ */
+float AdobeRGBSpace::encode(float v)
+{
+	return v > 0 ? (float) pow(v, 256 / 563.0) : 0;
+}
+
+static float labF(float t)
+{
+	return t > 0.008856f ? MathUtils::fastCbrt(t) : 7.787f * t + 16 / 116.0f;
+}
+
+static float labInverseF(float t)
+{
+	float t3 = t * t * t;
+	return t3 > 0.008856f ? t3 : (t - 16 / 116.0f) / 7.787f;
+}
+
+/**
+ * Converts XYZ to CIE Lab relative to the given reference white.
+ * 
+ * @param x
+ * @param y
+ * @param z
+ * @param white
+ *            reference white, e.g. WhitePoint::D50()
+ * @param lab
+ *            result array of 3 floats: L (0..100), a, b
+ */
+void XYZ::toLab(float x, float y, float z, const Vector3& white, float* lab)
+{
+	float fx = labF(x / (float) white.v[0]);
+	float fy = labF(y / (float) white.v[1]);
+	float fz = labF(z / (float) white.v[2]);
+	lab[0] = 116 * fy - 16;
+	lab[1] = 500 * (fx - fy);
+	lab[2] = 200 * (fy - fz);
+}
+
+/**
+ * Converts CIE Lab relative to the given reference white to XYZ.
+ * 
+ * @param l
+ * @param a
+ * @param b
+ * @param white
+ * @param xyz
+ *            result array of 3 floats
+ */
+void XYZ::fromLab(float l, float a, float b, const Vector3& white, float* xyz)
+{
+	float fy = (l + 16) / 116;
+	xyz[0] = labInverseF(fy + a / 500) * (float) white.v[0];
+	xyz[1] = labInverseF(fy) * (float) white.v[1];
+	xyz[2] = labInverseF(fy - b / 200) * (float) white.v[2];
+}
+
+/**
+ * Converts XYZ triplets to CIE Lab.
+ * 
+ * @param xyz
+ * @param lab
+ *            result buffer, may be the same as xyz
+ * @param count
+ * @param white
+ */
+void XYZ::toLab(const float* xyz, float* lab, size_t count, const Vector3& white)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		toLab(xyz[i], xyz[i + 1], xyz[i + 2], white, lab + i);
+	}
+}
+
+/**
+ * Converts CIE Lab triplets to XYZ.
+ * 
+ * @param lab
+ * @param xyz
+ *            result buffer, may be the same as lab
+ * @param count
+ * @param white
+ */
+void XYZ::fromLab(const float* lab, float* xyz, size_t count, const Vector3& white)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		fromLab(lab[i], lab[i + 1], lab[i + 2], white, xyz + i);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,322 @@
+#include "Colormap.h"
+#include <math.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Degree 6 polynomial fits of the matplotlib maps (coefficients by Matt
+// Zucker, CC0), per channel from the constant term up.
+const float VIRIDIS[3][7] = {
+	{ 0.2777273272f, 0.1050930431f, -0.3308618287f, -4.634230499f, 6.228269936f, 4.776384998f, -5.435455856f },
+	{ 0.005407344545f, 1.404613530f, 0.2148475595f, -5.799100973f, 14.17993337f, -13.74514538f, 4.645852612f },
+	{ 0.3340998053f, 1.384590163f, 0.09509516303f, -19.33244096f, 56.69055260f, -65.35303263f, 26.31243525f }
+};
+
+const float MAGMA[3][7] = {
+	{ -0.002136485054f, 0.2516605407f, 8.353717279f, -27.66873309f, 52.17613981f, -50.76852536f, 18.65570507f },
+	{ -0.0007496550528f, 0.6775232437f, -3.577719515f, 14.26473078f, -27.94360607f, 29.04658282f, -11.48977352f },
+	{ -0.005386127855f, 2.494026599f, 0.3144679030f, -13.64921319f, 12.94416944f, 4.234152994f, -5.601961509f }
+};
+
+const float INFERNO[3][7] = {
+	{ 0.0002189403691f, 0.1065134195f, 11.60249308f, -41.70399613f, 77.16293570f, -71.31942824f, 25.13112622f },
+	{ 0.001651004631f, 0.5639564368f, -3.972853966f, 17.43639888f, -33.40235894f, 32.62606426f, -12.24266895f },
+	{ -0.01948089844f, 3.932712389f, -15.94239411f, 44.35414520f, -81.80730926f, 73.20951986f, -23.07032500f }
+};
+
+const float PLASMA[3][7] = {
+	{ 0.05873234392f, 2.176514634f, -2.689460476f, 6.130348346f, -11.10743619f, 10.02306558f, -3.658713843f },
+	{ 0.02333670893f, 0.2383834171f, -7.455851136f, 42.34618815f, -82.66631109f, 71.41361770f, -22.93153465f },
+	{ 0.5433401827f, 0.7539604600f, 3.110799940f, -28.51885465f, 60.13984767f, -54.07218656f, 18.19190779f }
+};
+
+// Google's published degree 5 approximation of Turbo; it is loose at the
+// ends (about 0.05 per channel) compared to the reference table
+const float TURBO[3][7] = {
+	{ 0.13572138f, 4.61539260f, -42.66032258f, 132.13108234f, -152.94239396f, 59.28637943f, 0 },
+	{ 0.09140261f, 2.19418839f, 4.84296658f, -14.18503333f, 4.27729857f, 2.82956604f, 0 },
+	{ 0.10667330f, 12.64194608f, -60.58204836f, 110.36276771f, -89.90310912f, 27.34824973f, 0 }
+};
+
+float polynomial(const float* c, float t)
+{
+	float v = c[6];
+	for (int i = 5; i >= 0; i--) {
+		v = v * t + c[i];
+	}
+	return v;
+}
+
+unsigned int pack(const float* rgba, int r, int b)
+{
+	unsigned int v = 0;
+	int shifts[4] = { r, 8, b, 24 };
+	for (int c = 0; c < 4; c++) {
+		v |= (unsigned int) (MathUtils::clip(rgba[c], 0.0f, 1.0f) * 255 + 0.5f) << shifts[c];
+	}
+	return v;
+}
+
+}
+
+/**
+ * Creates a grey ramp from black to white over 0..1, without
+ * interpolation and with a transparent NaN color.
+ */
+Colormap::Colormap() :
+	minValue(0), maxValue(1), scale(SIZE - 1), interpolate(false)
+{
+	for (int i = 0; i < SIZE; i++) {
+		float v = (float) i / (SIZE - 1);
+		float rgba[4] = { v, v, v, 1 };
+		setEntry(i, rgba);
+	}
+	setNaNColor(OColor::newRGBA(0, 0, 0, 0));
+}
+
+/**
+ * @param preset
+ *            built-in map; viridis, magma, inferno and plasma are
+ *            perceptually uniform
+ * @return colormap over 0..1
+ */
+Colormap Colormap::newPreset(ColormapPreset preset)
+{
+	Colormap map;
+	const float (*coefficients)[7] = NULL;
+	switch (preset) {
+	case COLORMAP_VIRIDIS: coefficients = VIRIDIS; break;
+	case COLORMAP_MAGMA: coefficients = MAGMA; break;
+	case COLORMAP_INFERNO: coefficients = INFERNO; break;
+	case COLORMAP_PLASMA: coefficients = PLASMA; break;
+	case COLORMAP_TURBO: coefficients = TURBO; break;
+	default: return map;
+	}
+	for (int i = 0; i < SIZE; i++) {
+		float t = (float) i / (SIZE - 1);
+		float rgba[4] = { polynomial(coefficients[0], t), polynomial(coefficients[1], t), polynomial(coefficients[2], t), 1 };
+		map.setEntry(i, rgba);
+	}
+	return map;
+}
+
+/**
+ * @param gradient
+ *            gradient whose stops span the table
+ * @return colormap over 0..1
+ */
+Colormap Colormap::newGradient(const ColorGradient& gradient)
+{
+	Colormap map;
+	if (gradient.getStopCount() == 0) {
+		return map;
+	}
+	float first = gradient.getStopPosition(0);
+	float range = gradient.getStopPosition(gradient.getStopCount() - 1) - first;
+	for (int i = 0; i < SIZE; i++) {
+		float rgba[4];
+		gradient.getColor(first + range * i / (SIZE - 1), rgba);
+		map.setEntry(i, rgba);
+	}
+	return map;
+}
+
+/**
+ * @param colors
+ *            evenly spaced stops, first to last
+ * @param space
+ *            interpolation space between the stops
+ * @return colormap over 0..1
+ */
+Colormap Colormap::newColors(const vector<OColor>& colors, GradientSpace space)
+{
+	ColorGradient gradient(space);
+	for (size_t i = 0; i < colors.size(); i++) {
+		gradient.addStop(colors.size() > 1 ? (float) i / (colors.size() - 1) : 0, colors[i]);
+	}
+	return newGradient(gradient);
+}
+
+/**
+ * @param min
+ *            value mapped to the first entry
+ * @param max
+ *            value mapped to the last entry
+ * @return itself
+ */
+Colormap* Colormap::setRange(float min, float max) {
+	minValue = min;
+	maxValue = max;
+	scale = max != min ? (SIZE - 1) / (max - min) : 0;
+	return this;
+}
+
+/**
+ * @param interpolate
+ *            true to blend neighbouring entries
+ * @return itself
+ */
+Colormap* Colormap::setInterpolation(bool interpolate) {
+	this->interpolate = interpolate;
+	return this;
+}
+
+/**
+ * @param color
+ *            color for NaN values
+ * @return itself
+ */
+Colormap* Colormap::setNaNColor(const OColor& color) {
+	float rgba[4] = { color.getRed_RGB(), color.getGreen_RGB(), color.getBlue_RGB(), color.getAlpha() };
+	argb[SIZE] = pack(rgba, 16, 0);
+	abgr[SIZE] = pack(rgba, 0, 16);
+	return this;
+}
+
+float Colormap::getMin() const
+{
+	return minValue;
+}
+
+float Colormap::getMax() const
+{
+	return maxValue;
+}
+
+bool Colormap::isInterpolating() const
+{
+	return interpolate;
+}
+
+/**
+ * @param value
+ * @return color of the value, as map() would give it
+ */
+OColor Colormap::getColor(float value) const
+{
+	unsigned int v;
+	map(&value, &v, 1);
+	return OColor::newARGB(v);
+}
+
+void Colormap::setEntry(int index, const float* rgba)
+{
+	for (int c = 0; c < 4; c++) {
+		planes[c][index] = MathUtils::clip(rgba[c], 0.0f, 1.0f);
+		if (index == SIZE - 1) {
+			planes[c][SIZE] = planes[c][index];
+		}
+	}
+	packEntry(index);
+}
+
+void Colormap::packEntry(int index)
+{
+	float rgba[4] = { planes[0][index], planes[1][index], planes[2][index], planes[3][index] };
+	argb[index] = pack(rgba, 16, 0);
+	abgr[index] = pack(rgba, 0, 16);
+}
+
+/**
+ * Maps float values to packed colors.
+ * 
+ * @param values
+ *            scalar field
+ * @param packed
+ *            result, count packed colors
+ * @param count
+ *            number of values
+ * @param rgba
+ *            false for ARGB ints (BGRA8 bytes), true for ABGR ints (RGBA8
+ *            bytes)
+ */
+void Colormap::map(const float* values, unsigned int* packed, size_t count, bool rgba) const
+{
+	const unsigned int* table = rgba ? abgr : argb;
+	const int shiftR = rgba ? 0 : 16;
+	const int shiftB = rgba ? 16 : 0;
+	const float last = SIZE - 1;
+	size_t i = 0;
+#if defined(__AVX2__)
+	const __m256 vmin = _mm256_set1_ps(minValue);
+	const __m256 vscale = _mm256_set1_ps(scale);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 vlast = _mm256_set1_ps(last);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256 v255 = _mm256_set1_ps(255);
+	const __m256i nanColor = _mm256_set1_epi32((int) table[SIZE]);
+	for (; i + 8 <= count; i += 8) {
+		__m256 v = _mm256_loadu_ps(values + i);
+		__m256 nan = _mm256_cmp_ps(v, v, _CMP_UNORD_Q);
+		// max() returns its second operand for NaN, so NaN lands on 0 here
+		__m256 x = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_sub_ps(v, vmin), vscale), zero), vlast);
+		__m256i result;
+		if (interpolate) {
+			__m256i j = _mm256_cvttps_epi32(x);
+			__m256 f = _mm256_sub_ps(x, _mm256_cvtepi32_ps(j));
+			result = _mm256_setzero_si256();
+			const int shifts[4] = { shiftR, 8, shiftB, 24 };
+			for (int c = 0; c < 4; c++) {
+				__m256 a = _mm256_i32gather_ps(planes[c], j, 4);
+				__m256 b = _mm256_i32gather_ps(planes[c] + 1, j, 4);
+				__m256 channel = _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), f)), v255), half);
+				result = _mm256_or_si256(result, _mm256_sll_epi32(_mm256_cvttps_epi32(channel), _mm_cvtsi32_si128(shifts[c])));
+			}
+		}
+		else {
+			__m256i j = _mm256_cvttps_epi32(_mm256_add_ps(x, half));
+			result = _mm256_i32gather_epi32((const int*) table, j, 4);
+		}
+		result = _mm256_blendv_epi8(result, nanColor, _mm256_castps_si256(nan));
+		_mm256_storeu_si256((__m256i*) (packed + i), result);
+	}
+#endif
+	for (; i < count; i++) {
+		float v = values[i];
+		float x = (v - minValue) * scale;
+		x = x > 0 ? (x < last ? x : last) : 0;
+		unsigned int color;
+		if (interpolate) {
+			int j = (int) x;
+			float f = x - j;
+			color = 0;
+			const int shifts[4] = { shiftR, 8, shiftB, 24 };
+			for (int c = 0; c < 4; c++) {
+				color |= (unsigned int) ((planes[c][j] + (planes[c][j + 1] - planes[c][j]) * f) * 255 + 0.5f) << shifts[c];
+			}
+		}
+		else {
+			color = table[(int) (x + 0.5f)];
+		}
+		packed[i] = v == v ? color : table[SIZE];
+	}
+}
+
+/**
+ * Maps 16 bit values to packed colors. The values are taken as they are,
+ * so set the range accordingly (e.g. 0..65535).
+ * 
+ * @param values
+ *            scalar field
+ * @param packed
+ *            result, count packed colors
+ * @param count
+ *            number of values
+ * @param rgba
+ *            false for ARGB ints (BGRA8 bytes), true for ABGR ints (RGBA8
+ *            bytes)
+ */
+void Colormap::map(const unsigned short* values, unsigned int* packed, size_t count, bool rgba) const
+{
+	static const size_t BLOCK = 512;
+	float block[BLOCK];
+	for (size_t begin = 0; begin < count; begin += BLOCK) {
+		size_t n = count - begin < BLOCK ? count - begin : BLOCK;
+		for (size_t i = 0; i < n; i++) {
+			block[i] = values[begin + i];
+		}
+		map(block, packed + begin, n, rgba);
+	}
+}
\ No newline at end of file
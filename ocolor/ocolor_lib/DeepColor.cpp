@@ -0,0 +1,339 @@
+#include "DeepColor.h"
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+/**
+ * v * mul + (1 << (shift - 1)) >> shift equals the correctly rounded
+ * v * (2^dstBits - 1) / (2^srcBits - 1) for every srcBits value when the
+ * multiplier has 32 - max(0, dstBits - srcBits + 1) fraction bits (checked
+ * for all depth pairs up to 16 bits).
+ */
+struct DepthScale {
+	unsigned long long mul;
+	unsigned long long round;
+	int shift;
+
+	DepthScale(int srcBits, int dstBits) {
+		unsigned long long srcMax = (1ull << srcBits) - 1;
+		unsigned long long dstMax = (1ull << dstBits) - 1;
+		if (srcBits == dstBits) {
+			mul = 1;
+			round = 0;
+			shift = 0;
+			return;
+		}
+		shift = dstBits > srcBits ? 31 - (dstBits - srcBits) : 32;
+		mul = ((dstMax << shift) + srcMax / 2) / srcMax;
+		round = 1ull << (shift - 1);
+	}
+
+	unsigned apply(unsigned v) const {
+		return (unsigned) ((v * mul + round) >> shift);
+	}
+
+#if defined(__SSE2__)
+	// four 32 bit lanes; _mm_mul_epu32 multiplies the even ones
+	__m128i apply(__m128i v) const {
+		const __m128i m = _mm_set1_epi64x((long long) mul);
+		const __m128i r = _mm_set1_epi64x((long long) round);
+		const __m128i s = _mm_cvtsi32_si128(shift);
+		__m128i even = _mm_srl_epi64(_mm_add_epi64(_mm_mul_epu32(v, m), r), s);
+		__m128i odd = _mm_srl_epi64(_mm_add_epi64(_mm_mul_epu32(_mm_srli_epi64(v, 32), m), r), s);
+		return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+	}
+#endif
+};
+
+#if defined(__SSE2__)
+// narrows 0 .. 65535 int32 lanes to unsigned shorts without SSE4.1's packus
+inline __m128i packUnsigned16(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi32(0x8000);
+	__m128i v = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+	return _mm_xor_si128(v, _mm_set1_epi16((short) 0x8000));
+}
+#endif
+
+template<typename D>
+void rescaleSamples(const unsigned short* src, int srcBits, D* dst, int dstBits, size_t count)
+{
+	DepthScale scale(srcBits, dstBits);
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= count; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+		__m128i lo = scale.apply(_mm_unpacklo_epi16(v, zero));
+		__m128i hi = scale.apply(_mm_unpackhi_epi16(v, zero));
+		__m128i out = packUnsigned16(lo, hi);
+		if (sizeof(D) == 1) {
+			_mm_storel_epi64((__m128i*) (dst + i), _mm_packus_epi16(out, out));
+		}
+		else {
+			_mm_storeu_si128((__m128i*) (dst + i), out);
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = (D) scale.apply(src[i]);
+	}
+}
+
+inline long long toFixed(double v, int shift)
+{
+	return (long long) (v * (double) (1ll << shift) + (v < 0 ? -0.5 : 0.5));
+}
+
+}
+
+/**
+ * Changes the depth of LSB aligned samples with correct rounding. src and
+ * dst may be the same buffer.
+ * 
+ * @param src
+ * @param srcBits
+ *            1 .. 16
+ * @param dst
+ * @param dstBits
+ *            1 .. 16
+ * @param count
+ *            number of samples
+ */
+void DeepColor::rescale(const unsigned short* src, int srcBits, unsigned short* dst, int dstBits, size_t count)
+{
+	if (srcBits == dstBits) {
+		if (src != dst) {
+			copy(src, src + count, dst);
+		}
+		return;
+	}
+	rescaleSamples(src, srcBits, dst, dstBits, count);
+}
+
+/**
+ * Reduces LSB aligned samples to 8 bits with correct rounding.
+ * 
+ * @param src
+ * @param srcBits
+ *            1 .. 16
+ * @param dst
+ * @param count
+ *            number of samples
+ */
+void DeepColor::rescale(const unsigned short* src, int srcBits, unsigned char* dst, size_t count)
+{
+	rescaleSamples(src, srcBits, dst, 8, count);
+}
+
+/**
+ * Expands 8 bit samples to LSB aligned samples of the given depth.
+ * 
+ * @param src
+ * @param dst
+ * @param dstBits
+ *            8 .. 16
+ * @param count
+ *            number of samples
+ */
+void DeepColor::rescale(const unsigned char* src, unsigned short* dst, int dstBits, size_t count)
+{
+	DepthScale scale(8, dstBits);
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	for (; i + 8 <= count; i += 8) {
+		__m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (src + i)), zero);
+		__m128i lo = scale.apply(_mm_unpacklo_epi16(v, zero));
+		__m128i hi = scale.apply(_mm_unpackhi_epi16(v, zero));
+		_mm_storeu_si128((__m128i*) (dst + i), packUnsigned16(lo, hi));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = (unsigned short) scale.apply(src[i]);
+	}
+}
+
+/**
+ * Moves MSB aligned samples (P010 style, value << (16 - bits)) to the low
+ * bits. src and dst may be the same buffer.
+ * 
+ * @param src
+ * @param bits
+ *            sample depth
+ * @param dst
+ * @param count
+ *            number of samples
+ */
+void DeepColor::fromMSB(const unsigned short* src, int bits, unsigned short* dst, size_t count)
+{
+	int shift = 16 - bits;
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i s = _mm_cvtsi32_si128(shift);
+	for (; i + 8 <= count; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+		_mm_storeu_si128((__m128i*) (dst + i), _mm_srl_epi16(v, s));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = (unsigned short) (src[i] >> shift);
+	}
+}
+
+/**
+ * Moves LSB aligned samples to the high bits, as P010 stores them. Bits
+ * above the sample depth are dropped. src and dst may be the same buffer.
+ * 
+ * @param src
+ * @param bits
+ *            sample depth
+ * @param dst
+ * @param count
+ *            number of samples
+ */
+void DeepColor::toMSB(const unsigned short* src, int bits, unsigned short* dst, size_t count)
+{
+	int shift = 16 - bits;
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i s = _mm_cvtsi32_si128(shift);
+	for (; i + 8 <= count; i += 8) {
+		__m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+		_mm_storeu_si128((__m128i*) (dst + i), _mm_sll_epi16(v, s));
+	}
+#endif
+	for (; i < count; i++) {
+		dst[i] = (unsigned short) (src[i] << shift);
+	}
+}
+
+/**
+ * @param width
+ * @return bytes per v210 row: 128 bytes for every 48 pixels
+ */
+size_t DeepColor::getV210Stride(int width)
+{
+	return (size_t) ((width + 47) / 48) * 128;
+}
+
+/**
+ * Unpacks one v210 row into 10 bit LSB aligned 4:2:2 planes.
+ * 
+ * @param src
+ *            v210 row
+ * @param y
+ *            width samples
+ * @param cb
+ *            (width + 1) / 2 samples
+ * @param cr
+ *            (width + 1) / 2 samples
+ * @param width
+ */
+void DeepColor::unpackV210(const void* src, unsigned short* y, unsigned short* cb, unsigned short* cr, int width)
+{
+	const unsigned int* w = (const unsigned int*) src;
+	int chroma = (width + 1) / 2;
+	for (int x = 0; x < width; x += 6, w += 4) {
+		// each word holds three 10 bit samples, lowest first:
+		// Cb0 Y0 Cr0 | Y1 Cb1 Y2 | Cr1 Y3 Cb2 | Y4 Cr2 Y5
+		unsigned short s[12];
+		for (int i = 0; i < 4; i++) {
+			s[i * 3] = (unsigned short) (w[i] & 0x3ff);
+			s[i * 3 + 1] = (unsigned short) ((w[i] >> 10) & 0x3ff);
+			s[i * 3 + 2] = (unsigned short) ((w[i] >> 20) & 0x3ff);
+		}
+		const unsigned short luma[6] = { s[1], s[3], s[5], s[7], s[9], s[11] };
+		const unsigned short blue[3] = { s[0], s[4], s[8] };
+		const unsigned short red[3] = { s[2], s[6], s[10] };
+		int c = x / 2;
+		int n = width - x < 6 ? width - x : 6;
+		int m = chroma - c < 3 ? chroma - c : 3;
+		copy(luma, luma + n, y + x);
+		copy(blue, blue + m, cb + c);
+		copy(red, red + m, cr + c);
+	}
+}
+
+/**
+ * Packs 10 bit LSB aligned 4:2:2 planes into one v210 row. The last block
+ * of a row whose width is not a multiple of 6 is padded by repeating the
+ * last pixel; the row padding up to getV210Stride() is not written.
+ * 
+ * @param y
+ *            width samples
+ * @param cb
+ *            (width + 1) / 2 samples
+ * @param cr
+ *            (width + 1) / 2 samples
+ * @param dst
+ *            v210 row
+ * @param width
+ */
+void DeepColor::packV210(const unsigned short* y, const unsigned short* cb, const unsigned short* cr, void* dst, int width)
+{
+	unsigned int* w = (unsigned int*) dst;
+	int chroma = (width + 1) / 2;
+	for (int x = 0; x < width; x += 6, w += 4) {
+		unsigned short luma[6], blue[3], red[3];
+		for (int i = 0; i < 6; i++) {
+			luma[i] = y[x + i < width ? x + i : width - 1] & 0x3ff;
+		}
+		for (int i = 0; i < 3; i++) {
+			int c = x / 2 + i < chroma ? x / 2 + i : chroma - 1;
+			blue[i] = cb[c] & 0x3ff;
+			red[i] = cr[c] & 0x3ff;
+		}
+		w[0] = blue[0] | (unsigned) luma[0] << 10 | (unsigned) red[0] << 20;
+		w[1] = luma[1] | (unsigned) blue[1] << 10 | (unsigned) luma[2] << 20;
+		w[2] = red[1] | (unsigned) luma[3] << 10 | (unsigned) blue[2] << 20;
+		w[3] = luma[4] | (unsigned) red[2] << 10 | (unsigned) luma[5] << 20;
+	}
+}
+
+/**
+ * Builds the fixed point coefficients for decoding YCbCr of one depth to
+ * RGB of another.
+ * 
+ * @param standard
+ * @param fullRange
+ *            true for full range levels, false for video levels (64..940
+ *            luma at 10 bits)
+ * @param srcBits
+ *            YCbCr depth, 8 .. 16
+ * @param dstBits
+ *            RGB depth, 8 .. 16
+ * @return coefficients for the DeepColor kernels
+ */
+DeepYUVCoefficients DeepColor::coefficients(YCbCrStandard standard, bool fullRange, int srcBits, int dstBits)
+{
+	float fkr, fkb;
+	OColor::getYCbCrWeights(standard, &fkr, &fkb);
+	double kr = fkr;
+	double kb = fkb;
+	double kg = 1 - kr - kb;
+	double srcMax = (1 << srcBits) - 1;
+	double dstMax = (1 << dstBits) - 1;
+	// video levels scale with the depth: 16 << (bits - 8) .. 235 << (bits - 8)
+	double yRange = fullRange ? srcMax : 219 << (srcBits - 8);
+	double cRange = fullRange ? srcMax : 224 << (srcBits - 8);
+
+	DeepYUVCoefficients k;
+	k.srcBits = srcBits;
+	k.dstBits = dstBits;
+	k.yOffset = fullRange ? 0 : 16 << (srcBits - 8);
+	k.chromaOffset = 1 << (srcBits - 1);
+	// sums stay below 2^50 for 16 bit output, well inside 64 bits
+	k.shift = 32;
+	k.max = (int) dstMax;
+
+	k.yScale = toFixed(dstMax / yRange, k.shift);
+	k.crToR = toFixed(2 * (1 - kr) * dstMax / cRange, k.shift);
+	k.cbToG = toFixed(2 * kb * (1 - kb) / kg * dstMax / cRange, k.shift);
+	k.crToG = toFixed(2 * kr * (1 - kr) / kg * dstMax / cRange, k.shift);
+	k.cbToB = toFixed(2 * (1 - kb) * dstMax / cRange, k.shift);
+	return k;
+}
\ No newline at end of file
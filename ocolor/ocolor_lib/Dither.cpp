@@ -0,0 +1,154 @@
+#include "Dither.h"
+#include <math.h>
+#include <random>
+
+/**
+ * @return 8x8 Bayer thresholds in 0..1, row by row
+ */
+const float* Dither::getBayer()
+{
+	static const vector<float> matrix = []() {
+		vector<float> m(64);
+		for (int y = 0; y < 8; y++) {
+			for (int x = 0; x < 8; x++) {
+				// interleave the bits of x ^ y and y, finest level most significant
+				int v = 0, xy = x ^ y;
+				for (int bit = 0; bit < 3; bit++) {
+					v |= ((xy >> bit) & 1) << (5 - 2 * bit);
+					v |= ((y >> bit) & 1) << (4 - 2 * bit);
+				}
+				m[y * 8 + x] = (v + 0.5f) / 64;
+			}
+		}
+		return m;
+	}();
+	return &matrix[0];
+}
+
+/**
+ * The texture is generated with the void-and-cluster method on first use.
+ * 
+ * @return 64x64 blue noise thresholds in 0..1, row by row
+ */
+const float* Dither::getBlueNoise()
+{
+	static const vector<float> texture = generateBlueNoise(64, 1.5f, 1);
+	return &texture[0];
+}
+
+/**
+ * Ordered dithering amplitude that spans about one step of a palette of
+ * the given size spread evenly over the RGB cube.
+ * 
+ * @param paletteSize
+ *            number of colors
+ * @return amplitude in 0..255 units
+ */
+float Dither::getAutoSpread(size_t paletteSize)
+{
+	float levels = cbrtf((float) paletteSize);
+	return 255 / (levels > 2 ? levels - 1 : 1);
+}
+
+/**
+ * Void-and-cluster (Ulichney): ranks the cells of a toroidal grid so that
+ * every prefix of the ranking is an evenly spread point set. The energy of
+ * each cell, a Gaussian weighted count of the set points around it, is
+ * updated incrementally as points are added or removed.
+ * 
+ * @param size
+ *            side length, a power of two
+ * @param sigma
+ *            Gaussian radius in cells
+ * @param seed
+ *            seed of the initial random pattern
+ * @return size * size thresholds in 0..1
+ */
+vector<float> Dither::generateBlueNoise(int size, float sigma, unsigned seed)
+{
+	int cells = size * size;
+	vector<float> kernel(cells);
+	for (int y = 0; y < size; y++) {
+		for (int x = 0; x < size; x++) {
+			int dx = x < size / 2 ? x : x - size;
+			int dy = y < size / 2 ? y : y - size;
+			kernel[y * size + x] = expf(-(dx * dx + dy * dy) / (2 * sigma * sigma));
+		}
+	}
+
+	vector<char> points(cells, 0);
+	vector<float> energy(cells, 0.0f);
+	auto toggle = [&](int i, bool set) {
+		points[i] = set;
+		int px = i % size, py = i / size;
+		float sign = set ? 1.0f : -1.0f;
+		for (int y = 0; y < size; y++) {
+			const float* k = &kernel[((y - py) & (size - 1)) * size];
+			float* e = &energy[y * size];
+			for (int x = 0; x < size; x++) {
+				e[x] += sign * k[(x - px) & (size - 1)];
+			}
+		}
+	};
+	auto tightestCluster = [&]() {
+		int best = -1;
+		for (int i = 0; i < cells; i++) {
+			if (points[i] && (best < 0 || energy[i] > energy[best])) {
+				best = i;
+			}
+		}
+		return best;
+	};
+	auto largestVoid = [&]() {
+		int best = -1;
+		for (int i = 0; i < cells; i++) {
+			if (!points[i] && (best < 0 || energy[i] < energy[best])) {
+				best = i;
+			}
+		}
+		return best;
+	};
+
+	// initial pattern: a tenth of the cells, relaxed by moving the point in
+	// the tightest cluster to the largest void until that is a no-op
+	minstd_rand random(seed);
+	int initial = cells / 10;
+	for (int n = 0; n < initial;) {
+		int i = (int) (random() % cells);
+		if (!points[i]) {
+			toggle(i, true);
+			n++;
+		}
+	}
+	for (int guard = 0; guard < cells; guard++) {
+		int cluster = tightestCluster();
+		toggle(cluster, false);
+		int hole = largestVoid();
+		toggle(hole, true);
+		if (hole == cluster) {
+			break;
+		}
+	}
+
+	vector<int> rank(cells);
+	vector<char> prototype = points;
+	vector<float> prototypeEnergy = energy;
+	for (int r = initial - 1; r >= 0; r--) {
+		int cluster = tightestCluster();
+		toggle(cluster, false);
+		rank[cluster] = r;
+	}
+	points = prototype;
+	energy = prototypeEnergy;
+	for (int r = initial; r < cells; r++) {
+		int hole = largestVoid();
+		toggle(hole, true);
+		rank[hole] = r;
+	}
+
+	vector<float> texture(cells);
+	for (int i = 0; i < cells; i++) {
+		texture[i] = (rank[i] + 0.5f) / cells;
+	}
+	return texture;
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "FilterChain.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+ * Adds a color matrix, fused with the previous stage if that is a matrix
+ * too.
+ * 
+ * @param matrix
+ * @return itself
+ */
+FilterChain* FilterChain::addMatrix(const ColorMatrix& matrix) {
+	if (!stages.empty() && stages.back().type == FILTER_MATRIX) {
+		stages.back().matrix = stages.back().matrix.then(matrix);
+		return this;
+	}
+	Stage stage;
+	stage.type = FILTER_MATRIX;
+	stage.matrix = matrix;
+	stages.push_back(stage);
+	return this;
+}
+
+/**
+ * Adds HSV adjustments, merged into the previous stage if that is an
+ * HSVFilter too.
+ * 
+ * @param filter
+ * @return itself
+ */
+FilterChain* FilterChain::addHSV(const HSVFilter& filter) {
+	if (!stages.empty() && stages.back().type == FILTER_HSV) {
+		stages.back().hsv.append(filter);
+		return this;
+	}
+	Stage stage;
+	stage.type = FILTER_HSV;
+	stage.hsv = filter;
+	stages.push_back(stage);
+	return this;
+}
+
+/**
+ * Adds a gradient map: the luminance of each pixel (the weights of
+ * OColor::getLuminance()) selects the color along the gradient, whose alpha
+ * is multiplied into the pixel's.
+ * 
+ * @param gradient
+ *            gradient with at least one stop
+ * @param size
+ *            number of ramp entries the gradient is baked into
+ * @return itself
+ */
+FilterChain* FilterChain::addGradientMap(const ColorGradient& gradient, int size) {
+	ColorGradient baked = gradient;
+	if (!baked.bake(size)) {
+		return this;
+	}
+	Stage stage;
+	stage.type = FILTER_GRADIENT_MAP;
+	stage.rampSize = size;
+	stage.ramp.assign(baked.getRamp(0), baked.getRamp(0) + (size + 1) * 4);
+	stages.push_back(stage);
+	return this;
+}
+
+/**
+ * @param function
+ *            custom stage
+ * @return itself
+ */
+FilterChain* FilterChain::addFunction(const FilterFunction& function) {
+	Stage stage;
+	stage.type = FILTER_FUNCTION;
+	stage.function = function;
+	stages.push_back(stage);
+	return this;
+}
+
+/**
+ * Removes all stages.
+ * 
+ * @return itself
+ */
+FilterChain* FilterChain::clear() {
+	stages.clear();
+	return this;
+}
+
+/**
+ * @return number of stages after fusion
+ */
+size_t FilterChain::getStageCount() const
+{
+	return stages.size();
+}
+
+FilterStageType FilterChain::getStageType(size_t index) const
+{
+	return stages[index].type;
+}
+
+/**
+ * Runs every stage over one tile in place.
+ * 
+ * @param planes
+ *            red, green, blue and alpha planes of count 0..1 floats
+ * @param scratch
+ *            three planes of at least count floats for intermediates
+ * @param count
+ *            number of pixels
+ */
+void FilterChain::runTile(float* const* planes, float* const* scratch, size_t count) const
+{
+	float* r = planes[0];
+	float* g = planes[1];
+	float* b = planes[2];
+	float* a = planes[3];
+	for (size_t k = 0; k < stages.size(); k++) {
+		const Stage& stage = stages[k];
+		switch (stage.type) {
+		case FILTER_MATRIX: {
+			const float* m = stage.matrix.m;
+			size_t i = 0;
+#if defined(__SSE2__)
+			__m128 c[20];
+			for (int j = 0; j < 20; j++) {
+				c[j] = _mm_set1_ps(m[j]);
+			}
+			const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1);
+			for (; i + 4 <= count; i += 4) {
+				__m128 in[4] = { _mm_loadu_ps(r + i), _mm_loadu_ps(g + i), _mm_loadu_ps(b + i), _mm_loadu_ps(a + i) };
+				for (int row = 0; row < 4; row++) {
+					const __m128* cr = c + row * 5;
+					__m128 v = _mm_add_ps(cr[4], _mm_mul_ps(cr[0], in[0]));
+					v = _mm_add_ps(v, _mm_mul_ps(cr[1], in[1]));
+					v = _mm_add_ps(v, _mm_mul_ps(cr[2], in[2]));
+					v = _mm_add_ps(v, _mm_mul_ps(cr[3], in[3]));
+					_mm_storeu_ps(planes[row] + i, _mm_min_ps(_mm_max_ps(v, zero), one));
+				}
+			}
+#endif
+			for (; i < count; i++) {
+				float in[4] = { r[i], g[i], b[i], a[i] }, out[4];
+				stage.matrix.apply(in, out);
+				r[i] = out[0];
+				g[i] = out[1];
+				b[i] = out[2];
+				a[i] = out[3];
+			}
+			break;
+		}
+		case FILTER_HSV:
+			HSVFilter::rgbToHSV(r, g, b, scratch[0], scratch[1], scratch[2], count);
+			stage.hsv.applyHSV(scratch[0], scratch[1], scratch[2], count);
+			HSVFilter::hsvToRGB(scratch[0], scratch[1], scratch[2], r, g, b, count);
+			break;
+		case FILTER_GRADIENT_MAP: {
+			const int size = stage.rampSize;
+			const float* ramp[4] = { &stage.ramp[0], &stage.ramp[size + 1], &stage.ramp[(size + 1) * 2], &stage.ramp[(size + 1) * 3] };
+			const float scale = (float) (size - 1);
+			for (size_t i = 0; i < count; i++) {
+				float x = (r[i] * 0.299f + g[i] * 0.587f + b[i] * 0.114f) * scale;
+				x = x > 0 ? (x < scale ? x : scale) : 0;
+				int j = (int) x;
+				float f = x - j;
+				r[i] = ramp[0][j] + (ramp[0][j + 1] - ramp[0][j]) * f;
+				g[i] = ramp[1][j] + (ramp[1][j + 1] - ramp[1][j]) * f;
+				b[i] = ramp[2][j] + (ramp[2][j + 1] - ramp[2][j]) * f;
+				a[i] *= ramp[3][j] + (ramp[3][j + 1] - ramp[3][j]) * f;
+			}
+			break;
+		}
+		case FILTER_FUNCTION:
+			stage.function(planes, count);
+			break;
+		}
+	}
+}
\ No newline at end of file
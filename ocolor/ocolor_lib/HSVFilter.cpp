@@ -0,0 +1,319 @@
+#include "HSVFilter.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline float minf(float a, float b)
+{
+	return a < b ? a : b;
+}
+
+inline float maxf(float a, float b)
+{
+	return a > b ? a : b;
+}
+
+inline float clip01(float x)
+{
+	return x < 0 ? 0 : (x > 1 ? 1 : x);
+}
+
+// same result as fmodf(h, 1) plus one for negative values, with a result
+// rounded up to 1 taken as 0, as OColor::setHSV() wraps hues
+inline float wrapHue(float h)
+{
+	float whole = (float) (int) h;
+	whole -= whole > h ? 1 : 0;
+	h -= whole;
+	return h >= 1 ? 0 : h;
+}
+
+#if defined(__SSE2__)
+// the float selects in these kernels are written with SSE2 masks, since
+// compilers will not if-convert them under the default trapping math rules
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+inline __m128 wrapHue(__m128 h)
+{
+	__m128 whole = _mm_cvtepi32_ps(_mm_cvttps_epi32(h));
+	whole = _mm_sub_ps(whole, _mm_and_ps(_mm_cmpgt_ps(whole, h), _mm_set1_ps(1)));
+	h = _mm_sub_ps(h, whole);
+	return _mm_andnot_ps(_mm_cmpge_ps(h, _mm_set1_ps(1)), h);
+}
+
+inline __m128 channel(__m128 v, __m128 vs, __m128 sector, float offset)
+{
+	__m128 k = _mm_add_ps(sector, _mm_set1_ps(offset));
+	k = _mm_sub_ps(k, _mm_and_ps(_mm_cmpge_ps(k, _mm_set1_ps(6)), _mm_set1_ps(6)));
+	__m128 t = _mm_min_ps(k, _mm_sub_ps(_mm_set1_ps(4), k));
+	t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(1));
+	return _mm_sub_ps(v, _mm_mul_ps(vs, t));
+}
+#endif
+
+}
+
+/**
+ * @param step
+ * @return itself
+ * @see OColor::lighten()
+ */
+HSVFilter* HSVFilter::lighten(float step) {
+	return add(HSV_LIGHTEN, 0, 0, step);
+}
+
+/**
+ * @param step
+ * @return itself
+ * @see OColor::darken()
+ */
+HSVFilter* HSVFilter::darken(float step) {
+	return add(HSV_DARKEN, 0, 0, step);
+}
+
+/**
+ * @param step
+ * @return itself
+ * @see OColor::saturate()
+ */
+HSVFilter* HSVFilter::saturate(float step) {
+	return add(HSV_SATURATE, 0, step, 0);
+}
+
+/**
+ * @param step
+ * @return itself
+ * @see OColor::desaturate()
+ */
+HSVFilter* HSVFilter::desaturate(float step) {
+	return add(HSV_DESATURATE, 0, step, 0);
+}
+
+/**
+ * @param hue
+ * @return itself
+ * @see OColor::setHue()
+ */
+HSVFilter* HSVFilter::setHue(float hue) {
+	return add(HSV_SET_HUE, hue, 0, 0);
+}
+
+/**
+ * @param h
+ * @param s
+ * @param v
+ * @return itself
+ * @see OColor::adjustHSV()
+ */
+HSVFilter* HSVFilter::adjustHSV(float h, float s, float v) {
+	return add(HSV_ADJUST, h, s, v);
+}
+
+/**
+ * @param amount
+ * @return itself
+ * @see OColor::adjustContrast()
+ */
+HSVFilter* HSVFilter::adjustContrast(float amount) {
+	return add(HSV_ADJUST_CONTRAST, 0, 0, amount);
+}
+
+/**
+ * Adds the steps of another filter after the steps of this one.
+ * 
+ * @param other
+ * @return itself
+ */
+HSVFilter* HSVFilter::append(const HSVFilter& other) {
+	steps.insert(steps.end(), other.steps.begin(), other.steps.end());
+	return this;
+}
+
+/**
+ * Removes all steps.
+ * 
+ * @return itself
+ */
+HSVFilter* HSVFilter::clear() {
+	steps.clear();
+	return this;
+}
+
+size_t HSVFilter::getStepCount() const
+{
+	return steps.size();
+}
+
+HSVFilter* HSVFilter::add(HSVOperation operation, float h, float s, float v) {
+	Step step = { operation, h, s, v };
+	steps.push_back(step);
+	return this;
+}
+
+/**
+ * Runs the steps over planar HSV values in place.
+ * 
+ * @param h
+ *            hues, 0..1
+ * @param s
+ *            saturations
+ * @param v
+ *            brightness values
+ * @param count
+ *            number of values
+ */
+void HSVFilter::applyHSV(float* h, float* s, float* v, size_t count) const
+{
+	for (size_t k = 0; k < steps.size(); k++) {
+		const Step& step = steps[k];
+		switch (step.operation) {
+		case HSV_LIGHTEN:
+			for (size_t i = 0; i < count; i++) {
+				v[i] = clip01(v[i] + step.v);
+			}
+			break;
+		case HSV_DARKEN:
+			for (size_t i = 0; i < count; i++) {
+				v[i] = clip01(v[i] - step.v);
+			}
+			break;
+		case HSV_SATURATE:
+			for (size_t i = 0; i < count; i++) {
+				s[i] = clip01(s[i] + step.s);
+			}
+			break;
+		case HSV_DESATURATE:
+			for (size_t i = 0; i < count; i++) {
+				s[i] = clip01(s[i] - step.s);
+			}
+			break;
+		case HSV_SET_HUE: {
+			float hue = wrapHue(step.h);
+			for (size_t i = 0; i < count; i++) {
+				h[i] = hue;
+			}
+			break;
+		}
+		case HSV_ADJUST: {
+			size_t i = 0;
+#if defined(__SSE2__)
+			const __m128 dh = _mm_set1_ps(step.h), ds = _mm_set1_ps(step.s), dv = _mm_set1_ps(step.v);
+			const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1);
+			for (; i + 4 <= count; i += 4) {
+				_mm_storeu_ps(h + i, wrapHue(_mm_add_ps(_mm_loadu_ps(h + i), dh)));
+				_mm_storeu_ps(s + i, _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_loadu_ps(s + i), ds), zero), one));
+				_mm_storeu_ps(v + i, _mm_min_ps(_mm_max_ps(_mm_add_ps(_mm_loadu_ps(v + i), dv), zero), one));
+			}
+#endif
+			for (; i < count; i++) {
+				h[i] = wrapHue(h[i] + step.h);
+				s[i] = clip01(s[i] + step.s);
+				v[i] = clip01(v[i] + step.v);
+			}
+			break;
+		}
+		case HSV_ADJUST_CONTRAST:
+			for (size_t i = 0; i < count; i++) {
+				v[i] = clip01(v[i] + (v[i] < 0.5f ? -step.v : step.v));
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * Branch-free planar version of OColor::rgbToHSV().
+ * 
+ * @param r
+ * @param g
+ * @param b
+ * @param h
+ *            result hues, 0..1
+ * @param s
+ *            result saturations
+ * @param v
+ *            result brightness values
+ * @param count
+ *            number of values
+ */
+void HSVFilter::rgbToHSV(const float* r, const float* g, const float* b, float* h, float* s, float* v, size_t count)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1);
+	for (; i + 4 <= count; i += 4) {
+		__m128 red = _mm_loadu_ps(r + i), green = _mm_loadu_ps(g + i), blue = _mm_loadu_ps(b + i);
+		__m128 high = _mm_max_ps(_mm_max_ps(red, green), blue);
+		__m128 d = _mm_sub_ps(high, _mm_min_ps(_mm_min_ps(red, green), blue));
+		__m128 inv = _mm_div_ps(one, select(_mm_cmpgt_ps(d, zero), d, one));
+		__m128 hr = _mm_mul_ps(_mm_sub_ps(green, blue), inv);
+		__m128 hg = _mm_add_ps(_mm_set1_ps(2), _mm_mul_ps(_mm_sub_ps(blue, red), inv));
+		__m128 hb = _mm_add_ps(_mm_set1_ps(4), _mm_mul_ps(_mm_sub_ps(red, green), inv));
+		__m128 hue = select(_mm_cmpeq_ps(red, high), hr, select(_mm_cmpeq_ps(green, high), hg, hb));
+		hue = _mm_mul_ps(hue, _mm_set1_ps(1.0f / 6));
+		_mm_storeu_ps(h + i, _mm_add_ps(hue, _mm_and_ps(_mm_cmplt_ps(hue, zero), one)));
+		_mm_storeu_ps(s + i, _mm_div_ps(d, select(_mm_cmpgt_ps(high, zero), high, one)));
+		_mm_storeu_ps(v + i, high);
+	}
+#endif
+	for (; i < count; i++) {
+		float red = r[i], green = g[i], blue = b[i];
+		float high = maxf(maxf(red, green), blue);
+		float d = high - minf(minf(red, green), blue);
+		// grey gives d = 0 and all three hue terms 0, so no special case
+		float inv = 1 / (d > 0 ? d : 1);
+		float hue = red == high ? (green - blue) * inv : (green == high ? 2 + (blue - red) * inv : 4 + (red - green) * inv);
+		hue *= 1.0f / 6;
+		h[i] = hue + (hue < 0 ? 1 : 0);
+		s[i] = d / (high > 0 ? high : 1);
+		v[i] = high;
+	}
+}
+
+/**
+ * Branch-free planar version of OColor::hsvToRGB(): each channel is v
+ * minus v * s times a trapezoid over the hue wheel.
+ * 
+ * @param h
+ *            hues, 0..1
+ * @param s
+ * @param v
+ * @param r
+ *            result red values
+ * @param g
+ *            result green values
+ * @param b
+ *            result blue values
+ * @param count
+ *            number of values
+ */
+void HSVFilter::hsvToRGB(const float* h, const float* s, const float* v, float* r, float* g, float* b, size_t count)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	for (; i + 4 <= count; i += 4) {
+		__m128 value = _mm_loadu_ps(v + i);
+		__m128 vs = _mm_mul_ps(value, _mm_loadu_ps(s + i));
+		__m128 sector = _mm_mul_ps(_mm_loadu_ps(h + i), _mm_set1_ps(6));
+		_mm_storeu_ps(r + i, channel(value, vs, sector, 5));
+		_mm_storeu_ps(g + i, channel(value, vs, sector, 3));
+		_mm_storeu_ps(b + i, channel(value, vs, sector, 1));
+	}
+#endif
+	for (; i < count; i++) {
+		float sector = h[i] * 6;
+		float vs = v[i] * s[i];
+		float kr = 5 + sector, kg = 3 + sector, kb = 1 + sector;
+		kr -= kr >= 6 ? 6 : 0;
+		kg -= kg >= 6 ? 6 : 0;
+		kb -= kb >= 6 ? 6 : 0;
+		r[i] = v[i] - vs * clip01(minf(kr, 4 - kr));
+		g[i] = v[i] - vs * clip01(minf(kg, 4 - kg));
+		b[i] = v[i] - vs * clip01(minf(kb, 4 - kb));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,560 @@
+#define _FILE_OFFSET_BITS 64
+#include "ImageFile.h"
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+static const intptr_t INVALID_FILE = -1;
+
+/**
+ * Platform glue. Files and mappings are kept as intptr_t so that the
+ * public headers do not pull in windows.h or the POSIX headers.
+ */
+static size_t mapGranularity()
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwAllocationGranularity;
+#else
+	return (size_t) sysconf(_SC_PAGESIZE);
+#endif
+}
+
+static intptr_t openFileHandle(const char* path, bool writable, long long createSize, long long* size)
+{
+#ifdef _WIN32
+	HANDLE h = CreateFileA(path, writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+						   FILE_SHARE_READ, NULL, writable ? CREATE_ALWAYS : OPEN_EXISTING,
+						   FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (h == INVALID_HANDLE_VALUE) {
+		return INVALID_FILE;
+	}
+	LARGE_INTEGER li;
+	if (writable) {
+		li.QuadPart = createSize;
+		if (!SetFilePointerEx(h, li, NULL, FILE_BEGIN) || !SetEndOfFile(h)) {
+			CloseHandle(h);
+			return INVALID_FILE;
+		}
+	}
+	if (!GetFileSizeEx(h, &li)) {
+		CloseHandle(h);
+		return INVALID_FILE;
+	}
+	*size = li.QuadPart;
+	return (intptr_t) h;
+#else
+	int fd = writable ? ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : ::open(path, O_RDONLY);
+	if (fd < 0) {
+		return INVALID_FILE;
+	}
+	if (writable && ftruncate(fd, (off_t) createSize) != 0) {
+		::close(fd);
+		return INVALID_FILE;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		return INVALID_FILE;
+	}
+	*size = st.st_size;
+	return fd;
+#endif
+}
+
+static void closeFileHandle(intptr_t file)
+{
+#ifdef _WIN32
+	CloseHandle((HANDLE) file);
+#else
+	::close((int) file);
+#endif
+}
+
+static intptr_t createMapping(intptr_t file, bool writable)
+{
+#ifdef _WIN32
+	HANDLE m = CreateFileMappingA((HANDLE) file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+	return m == NULL ? INVALID_FILE : (intptr_t) m;
+#else
+	// mmap() works on the descriptor directly
+	(void) writable;
+	return file;
+#endif
+}
+
+static void closeMapping(intptr_t mapping)
+{
+#ifdef _WIN32
+	CloseHandle((HANDLE) mapping);
+#else
+	(void) mapping;
+#endif
+}
+
+/**
+ * Maps length bytes at offset. The view starts at the granularity boundary
+ * below offset; the returned pointer is adjusted to offset itself.
+ */
+static unsigned char* mapView(intptr_t mapping, bool writable, long long offset, size_t length, void** view, size_t* viewLength)
+{
+	size_t granularity = mapGranularity();
+	long long aligned = offset - (offset % granularity);
+	size_t lead = (size_t) (offset - aligned);
+	*viewLength = length + lead;
+#ifdef _WIN32
+	*view = MapViewOfFile((HANDLE) mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ,
+						  (DWORD) (aligned >> 32), (DWORD) (aligned & 0xffffffff), *viewLength);
+	if (*view == NULL) {
+		return NULL;
+	}
+#else
+	*view = mmap(NULL, *viewLength, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, (int) mapping, (off_t) aligned);
+	if (*view == MAP_FAILED) {
+		*view = NULL;
+		return NULL;
+	}
+	madvise(*view, *viewLength, MADV_SEQUENTIAL);
+#endif
+	return (unsigned char*) *view + lead;
+}
+
+static void unmapView(void* view, size_t viewLength)
+{
+#ifdef _WIN32
+	(void) viewLength;
+	UnmapViewOfFile(view);
+#else
+	munmap(view, viewLength);
+#endif
+}
+
+static bool readFileHead(intptr_t file, char* buffer, size_t length, size_t* got)
+{
+#ifdef _WIN32
+	LARGE_INTEGER zero;
+	zero.QuadPart = 0;
+	SetFilePointerEx((HANDLE) file, zero, NULL, FILE_BEGIN);
+	DWORD n = 0;
+	if (!ReadFile((HANDLE) file, buffer, (DWORD) length, &n, NULL)) {
+		return false;
+	}
+	*got = n;
+#else
+	ssize_t n = pread((int) file, buffer, length, 0);
+	if (n < 0) {
+		return false;
+	}
+	*got = (size_t) n;
+#endif
+	return true;
+}
+
+static bool writeFileHead(intptr_t file, const char* buffer, size_t length)
+{
+#ifdef _WIN32
+	LARGE_INTEGER zero;
+	zero.QuadPart = 0;
+	SetFilePointerEx((HANDLE) file, zero, NULL, FILE_BEGIN);
+	DWORD n = 0;
+	return WriteFile((HANDLE) file, buffer, (DWORD) length, &n, NULL) && n == length;
+#else
+	return pwrite((int) file, buffer, length, 0) == (ssize_t) length;
+#endif
+}
+
+/**
+ * Default constructor.
+ * 
+ */
+ImageHeader::ImageHeader()
+{
+	type = IMAGE_RAW;
+	width = height = depth = 0;
+	maxval = 255;
+	bigEndian = false;
+	dataOffset = 0;
+}
+
+/**
+ * Default constructor.
+ * 
+ */
+MappedImageReader::MappedImageReader()
+{
+	fileSize = 0;
+	file = INVALID_FILE;
+	mapping = INVALID_FILE;
+	view = NULL;
+	viewLength = 0;
+}
+
+MappedImageReader::~MappedImageReader()
+{
+	close();
+}
+
+/**
+ * Opens a binary PGM (P5), PPM (P6) or PAM (P7) file and parses its header.
+ * 
+ * @param path
+ * @return false if the file cannot be opened, is not a supported Netpbm
+ *         type, or is shorter than its header promises
+ */
+bool MappedImageReader::open(const char* path)
+{
+	if (!openFile(path)) {
+		return false;
+	}
+	if (!parseHeader()) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * Opens a headerless raw image of interleaved samples, e.g. RGBA or BGRA
+ * frames dumped from a decoder.
+ * 
+ * @param path
+ * @param width
+ * @param height
+ * @param depth
+ *            samples per pixel, 1..4
+ * @param bytesPerSample
+ *            1 or 2 (native byte order)
+ * @return false if the layout is not supported or the file cannot be
+ *         opened or is too short
+ */
+bool MappedImageReader::openRaw(const char* path, int width, int height, int depth, int bytesPerSample)
+{
+	if (width <= 0 || height <= 0 || depth < 1 || depth > 4 || (bytesPerSample != 1 && bytesPerSample != 2)) {
+		close();
+		return false;
+	}
+	if (!openFile(path)) {
+		return false;
+	}
+	header = ImageHeader();
+	header.type = IMAGE_RAW;
+	header.width = width;
+	header.height = height;
+	header.depth = depth;
+	header.maxval = bytesPerSample > 1 ? 65535 : 255;
+	// divided so huge sizes cannot overflow
+	if ((long long) header.rowBytes() > fileSize / height) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @return the layout of the open image
+ */
+const ImageHeader& MappedImageReader::getHeader() const
+{
+	return header;
+}
+
+/**
+ * Maps a band of rows. The previous band is released first, so the
+ * returned pointer is only valid until the next call or close().
+ * 
+ * @param firstRow
+ * @param rowCount
+ *            clamped to the image height
+ * @return pointer to the first sample of firstRow, or NULL
+ */
+const unsigned char* MappedImageReader::mapRows(int firstRow, int rowCount)
+{
+	unmap();
+	if (mapping == INVALID_FILE || firstRow < 0 || firstRow >= header.height || rowCount <= 0) {
+		return NULL;
+	}
+	if (firstRow + rowCount > header.height) {
+		rowCount = header.height - firstRow;
+	}
+	long long offset = header.dataOffset + (long long) header.rowBytes() * firstRow;
+	return mapView(mapping, false, offset, header.rowBytes() * rowCount, &view, &viewLength);
+}
+
+/**
+ * Releases the current band and closes the file.
+ * 
+ */
+void MappedImageReader::close()
+{
+	unmap();
+	if (mapping != INVALID_FILE && mapping != file) {
+		closeMapping(mapping);
+	}
+	if (file != INVALID_FILE) {
+		closeFileHandle(file);
+	}
+	mapping = INVALID_FILE;
+	file = INVALID_FILE;
+	fileSize = 0;
+}
+
+bool MappedImageReader::openFile(const char* path)
+{
+	close();
+	file = openFileHandle(path, false, 0, &fileSize);
+	if (file == INVALID_FILE) {
+		return false;
+	}
+	mapping = createMapping(file, false);
+	if (mapping == INVALID_FILE) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedImageReader::unmap()
+{
+	if (view != NULL) {
+		unmapView(view, viewLength);
+		view = NULL;
+		viewLength = 0;
+	}
+}
+
+/**
+ * Tokenizer for Netpbm headers: skips whitespace and '#' comments.
+ */
+static bool nextToken(const char* buf, size_t len, size_t* pos, char* token, size_t tokenLength)
+{
+	while (*pos < len) {
+		char c = buf[*pos];
+		if (c == '#') {
+			while (*pos < len && buf[*pos] != '\n') {
+				(*pos)++;
+			}
+		} else if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+			(*pos)++;
+		} else {
+			break;
+		}
+	}
+	size_t n = 0;
+	while (*pos < len && n + 1 < tokenLength) {
+		char c = buf[*pos];
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#') {
+			break;
+		}
+		token[n++] = c;
+		(*pos)++;
+	}
+	token[n] = 0;
+	return n > 0;
+}
+
+bool MappedImageReader::parseHeader()
+{
+	char buf[4096];
+	size_t len = 0;
+	if (!readFileHead(file, buf, sizeof(buf), &len) || len < 3) {
+		return false;
+	}
+
+	header = ImageHeader();
+	char token[64];
+	size_t pos = 0;
+	nextToken(buf, len, &pos, token, sizeof(token));
+
+	if (strcmp(token, "P5") == 0 || strcmp(token, "P6") == 0) {
+		header.type = token[1] == '5' ? IMAGE_PGM : IMAGE_PPM;
+		header.depth = token[1] == '5' ? 1 : 3;
+		int values[3];
+		for (int i = 0; i < 3; i++) {
+			if (!nextToken(buf, len, &pos, token, sizeof(token))) {
+				return false;
+			}
+			values[i] = atoi(token);
+		}
+		header.width = values[0];
+		header.height = values[1];
+		header.maxval = values[2];
+		// exactly one whitespace character separates header and raster
+		pos++;
+	} else if (strcmp(token, "P7") == 0) {
+		header.type = IMAGE_PAM;
+		bool ended = false;
+		while (!ended && nextToken(buf, len, &pos, token, sizeof(token))) {
+			char value[64];
+			if (strcmp(token, "ENDHDR") == 0) {
+				while (pos < len && buf[pos] != '\n') {
+					pos++;
+				}
+				pos++;
+				ended = true;
+			} else if (!nextToken(buf, len, &pos, value, sizeof(value))) {
+				return false;
+			} else if (strcmp(token, "WIDTH") == 0) {
+				header.width = atoi(value);
+			} else if (strcmp(token, "HEIGHT") == 0) {
+				header.height = atoi(value);
+			} else if (strcmp(token, "DEPTH") == 0) {
+				header.depth = atoi(value);
+			} else if (strcmp(token, "MAXVAL") == 0) {
+				header.maxval = atoi(value);
+			} else if (strcmp(token, "TUPLTYPE") == 0) {
+				header.tupleType = value;
+			}
+		}
+		if (!ended) {
+			return false;
+		}
+	} else {
+		return false;
+	}
+
+	if (header.width <= 0 || header.height <= 0 || header.depth <= 0 ||
+		header.maxval <= 0 || header.maxval > 65535 || pos > len) {
+		return false;
+	}
+	header.bigEndian = header.maxval > 255;
+	header.dataOffset = (long long) pos;
+	return header.dataOffset + (long long) header.rowBytes() * header.height <= fileSize;
+}
+
+/**
+ * Default constructor.
+ * 
+ */
+MappedImageWriter::MappedImageWriter()
+{
+	file = INVALID_FILE;
+	mapping = INVALID_FILE;
+	view = NULL;
+	viewLength = 0;
+}
+
+MappedImageWriter::~MappedImageWriter()
+{
+	close();
+}
+
+/**
+ * Creates (or truncates) an image file at its final size and writes the
+ * header. PGM must have depth 1 and PPM depth 3; PAM takes 1 to 4 and gets
+ * the matching TUPLTYPE.
+ * 
+ * @param path
+ * @param type
+ * @param width
+ * @param height
+ * @param depth
+ *            samples per pixel
+ * @param maxval
+ *            255 for 8 bit samples, up to 65535 for 16 bit samples
+ * @return false if the parameters are invalid or the file cannot be created
+ */
+bool MappedImageWriter::create(const char* path, ImageFileType type, int width, int height, int depth, int maxval)
+{
+	close();
+	if (width <= 0 || height <= 0 || maxval <= 0 || maxval > 65535 ||
+		(type == IMAGE_PGM && depth != 1) || (type == IMAGE_PPM && depth != 3) || depth < 1 || depth > 4) {
+		return false;
+	}
+
+	static const char* TUPLE_TYPES[] = { "GRAYSCALE", "GRAYSCALE_ALPHA", "RGB", "RGB_ALPHA" };
+	char head[256];
+	int headLength = 0;
+	if (type == IMAGE_PGM || type == IMAGE_PPM) {
+		headLength = sprintf(head, "P%d\n%d %d\n%d\n", type == IMAGE_PGM ? 5 : 6, width, height, maxval);
+	} else if (type == IMAGE_PAM) {
+		headLength = sprintf(head, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH %d\nMAXVAL %d\nTUPLTYPE %s\nENDHDR\n",
+							 width, height, depth, maxval, TUPLE_TYPES[depth - 1]);
+	}
+
+	header = ImageHeader();
+	header.type = type;
+	header.width = width;
+	header.height = height;
+	header.depth = depth;
+	header.maxval = maxval;
+	header.bigEndian = type != IMAGE_RAW && maxval > 255;
+	header.tupleType = type == IMAGE_PAM ? TUPLE_TYPES[depth - 1] : "";
+	header.dataOffset = headLength;
+
+	long long size = 0;
+	file = openFileHandle(path, true, header.dataOffset + (long long) header.rowBytes() * height, &size);
+	if (file == INVALID_FILE) {
+		return false;
+	}
+	if ((headLength > 0 && !writeFileHead(file, head, headLength)) ||
+		(mapping = createMapping(file, true)) == INVALID_FILE) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @return the layout of the image being written
+ */
+const ImageHeader& MappedImageWriter::getHeader() const
+{
+	return header;
+}
+
+/**
+ * Maps a band of rows for writing. The previous band is released first.
+ * 
+ * @param firstRow
+ * @param rowCount
+ *            clamped to the image height
+ * @return pointer to the first sample of firstRow, or NULL
+ */
+unsigned char* MappedImageWriter::mapRows(int firstRow, int rowCount)
+{
+	unmap();
+	if (mapping == INVALID_FILE || firstRow < 0 || firstRow >= header.height || rowCount <= 0) {
+		return NULL;
+	}
+	if (firstRow + rowCount > header.height) {
+		rowCount = header.height - firstRow;
+	}
+	long long offset = header.dataOffset + (long long) header.rowBytes() * firstRow;
+	return mapView(mapping, true, offset, header.rowBytes() * rowCount, &view, &viewLength);
+}
+
+/**
+ * Releases the current band and closes the file.
+ * 
+ */
+void MappedImageWriter::close()
+{
+	unmap();
+	if (mapping != INVALID_FILE && mapping != file) {
+		closeMapping(mapping);
+	}
+	if (file != INVALID_FILE) {
+		closeFileHandle(file);
+	}
+	mapping = INVALID_FILE;
+	file = INVALID_FILE;
+}
+
+void MappedImageWriter::unmap()
+{
+	if (view != NULL) {
+		unmapView(view, viewLength);
+		view = NULL;
+		viewLength = 0;
+	}
+}
\ No newline at end of file
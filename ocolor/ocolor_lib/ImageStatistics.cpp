@@ -0,0 +1,73 @@
+#include "ImageStatistics.h"
+#include <cstring>
+
+ImageStatsAccumulator::ImageStatsAccumulator()
+{
+	memset(this, 0, sizeof(ImageStatsAccumulator));
+}
+
+/**
+ * Adds the partial sums of another chunk.
+ * 
+ * @param other
+ */
+void ImageStatsAccumulator::merge(const ImageStatsAccumulator& other)
+{
+	count += other.count;
+	for (int i = 0; i < ImageStats::HUE_BINS; i++) {
+		hue[i] += other.hue[i];
+	}
+	for (int i = 0; i < ImageStats::LUMINANCE_BINS; i++) {
+		luminance[i] += other.luminance[i];
+	}
+	for (int i = 0; i < 4; i++) {
+		sum[i] += other.sum[i];
+		sumSquares[i] += other.sumSquares[i];
+	}
+	grey += other.grey;
+	black += other.black;
+	white += other.white;
+}
+
+/**
+ * @return the statistics of all pixels added so far
+ */
+ImageStats ImageStatsAccumulator::finish() const
+{
+	ImageStats stats;
+	stats.pixelCount = count;
+	memcpy(stats.hueHistogram, hue, sizeof(hue));
+	memcpy(stats.luminanceHistogram, luminance, sizeof(luminance));
+	double n = count > 0 ? (double) count : 1;
+	float mean[4], variance[4];
+	for (int i = 0; i < 4; i++) {
+		double m = sum[i] / n;
+		double v = sumSquares[i] / n - m * m;
+		mean[i] = (float) m;
+		variance[i] = (float) (v < 0 ? 0 : v);
+	}
+	for (int i = 0; i < 3; i++) {
+		stats.mean[i] = mean[i];
+		stats.variance[i] = variance[i];
+	}
+	stats.meanLuminance = mean[3];
+	stats.varianceLuminance = variance[3];
+	stats.greyCount = grey;
+	stats.blackCount = black;
+	stats.whiteCount = white;
+	return stats;
+}
+
+/**
+ * @param bin
+ *            index into ImageStats::hueHistogram
+ * @return the named hue counted in that bin
+ */
+Hue ImageStatistics::getHueBin(int bin)
+{
+	static const Hue* bins[ImageStats::HUE_BINS] = {
+		&Hue::RED, &Hue::ORANGE, &Hue::YELLOW, &Hue::LIME, &Hue::GREEN, &Hue::TEAL,
+		&Hue::CYAN, &Hue::AZURE, &Hue::BLUE, &Hue::INDIGO, &Hue::PURPLE, &Hue::PINK
+	};
+	return *bins[bin];
+}
\ No newline at end of file
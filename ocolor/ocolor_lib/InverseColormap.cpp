@@ -0,0 +1,248 @@
+#include "InverseColormap.h"
+
+namespace {
+
+/**
+ * @return true if q is nearer than p everywhere in the box lo..hi. The
+ *         points nearer to p form a half space, so only the box corner
+ *         furthest towards p needs testing. The margin keeps float
+ *         rounding in the candidate search from ever preferring p.
+ */
+inline bool beatsInBox(const float* q, const float* p, const float* lo, const float* hi)
+{
+	double dp = 0, dq = 0;
+	for (int k = 0; k < 3; k++) {
+		double x = p[k] > q[k] ? hi[k] : lo[k];
+		dp += (x - p[k]) * (x - p[k]);
+		dq += (x - q[k]) * (x - q[k]);
+	}
+	return dq + 0.5 < dp;
+}
+
+/**
+ * Keeps the entries of found that no other one beats everywhere in the box
+ * lo..hi, in palette order so ties resolve as in a full search.
+ */
+void keepPossible(const float* colors, const vector<unsigned short>& found, const float* lo, const float* hi,
+				  vector<unsigned short>& kept)
+{
+	kept.clear();
+	for (size_t i = 0; i < found.size(); i++) {
+		const float* p = colors + found[i] * 3;
+		bool beaten = false;
+		for (size_t j = 0; j < found.size() && !beaten; j++) {
+			beaten = beatsInBox(colors + found[j] * 3, p, lo, hi);
+		}
+		if (!beaten) {
+			kept.push_back(found[i]);
+		}
+	}
+}
+
+}
+
+InverseColormap::InverseColormap() :
+	bits(0), ambiguousParts(0)
+{
+
+}
+
+/**
+ * Builds the grid for a palette. Slices of the grid are built in parallel.
+ * 
+ * @param palette
+ *            1 .. 65535 colors
+ * @param bits
+ *            grid resolution per channel, 1..8; 5 gives 32^3 cells, 6 gives
+ *            64^3 cells
+ * @param exact
+ *            false to skip the boundary correction
+ * @param threads
+ *            0 for one thread per core
+ * @return false if the palette or resolution is not supported
+ */
+bool InverseColormap::build(const vector<OColor>& palette, int bits, bool exact, unsigned threads)
+{
+	if (palette.empty() || palette.size() > 65535 || bits < 1 || bits > 8) {
+		return false;
+	}
+	this->bits = bits;
+	size_t n = palette.size();
+	colors.resize(n * 3);
+	for (size_t i = 0; i < n; i++) {
+		colors[i * 3] = palette[i].getRed_RGB() * 255;
+		colors[i * 3 + 1] = palette[i].getGreen_RGB() * 255;
+		colors[i * 3 + 2] = palette[i].getBlue_RGB() * 255;
+	}
+
+	int side = 1 << bits;
+	int size = 256 >> bits;
+	int parts = size > 1 ? 8 : 1;
+	table.assign((size_t) side * side * side, 0);
+	vector<vector<unsigned int> > subSlices(side);
+	vector<vector<unsigned short> > slices(side);
+
+	Parallel::forChunks(side, 1, threads, [&](size_t first, size_t last) {
+		vector<float> minDist(n);
+		vector<unsigned short> found, possible, kept;
+		for (size_t rc = first; rc < last; rc++) {
+			vector<unsigned int>& subs = subSlices[rc];
+			vector<unsigned short>& list = slices[rc];
+			for (int gc = 0; gc < side; gc++) {
+				for (int bc = 0; bc < side; bc++) {
+					float lo[3] = { (float) (rc * size), (float) (gc * size), (float) (bc * size) };
+					float hi[3] = { lo[0] + size - 1, lo[1] + size - 1, lo[2] + size - 1 };
+					float centre[3] = { (lo[0] + hi[0]) * 0.5f, (lo[1] + hi[1]) * 0.5f, (lo[2] + hi[2]) * 0.5f };
+
+					// nearest entry to the cell centre, and the smallest distance
+					// within which some entry covers the whole cell
+					int nearest = 0;
+					float nearestDist = 1E30f;
+					float bound = 1E30f;
+					for (size_t p = 0; p < n; p++) {
+						const float* c = &colors[p * 3];
+						float dc = 0, dmin = 0, dmax = 0;
+						for (int k = 0; k < 3; k++) {
+							float d = c[k] - centre[k];
+							dc += d * d;
+							float below = lo[k] - c[k];
+							float above = c[k] - hi[k];
+							float outside = below > 0 ? below : (above > 0 ? above : 0);
+							dmin += outside * outside;
+							float far = fabs(c[k] - lo[k]) > fabs(c[k] - hi[k]) ? fabs(c[k] - lo[k]) : fabs(c[k] - hi[k]);
+							dmax += far * far;
+						}
+						minDist[p] = dmin;
+						if (dc < nearestDist) {
+							nearestDist = dc;
+							nearest = (int) p;
+						}
+						bound = dmax < bound ? dmax : bound;
+					}
+
+					unsigned int entry = nearest;
+					if (exact) {
+						found.clear();
+						for (size_t p = 0; p < n; p++) {
+							if (minDist[p] <= bound) {
+								found.push_back((unsigned short) p);
+							}
+						}
+						keepPossible(&colors[0], found, lo, hi, possible);
+						if (possible.size() > 1) {
+							// a boundary cell: split it in eight and keep a
+							// candidate list only for the parts that still
+							// contain a boundary
+							entry = AMBIGUOUS | (unsigned int) subs.size();
+							for (int part = 0; part < parts; part++) {
+								float partLo[3], partHi[3];
+								for (int k = 0; k < 3; k++) {
+									partLo[k] = lo[k] + ((part >> (2 - k)) & 1) * (size / 2);
+									partHi[k] = parts > 1 ? partLo[k] + size / 2 - 1 : hi[k];
+								}
+								keepPossible(&colors[0], possible, partLo, partHi, kept);
+								if (kept.size() == 1) {
+									subs.push_back(kept[0]);
+									continue;
+								}
+								subs.push_back(AMBIGUOUS | (unsigned int) list.size());
+								list.push_back((unsigned short) kept.size());
+								list.insert(list.end(), kept.begin(), kept.end());
+							}
+						}
+					}
+					table[((rc * side) + gc) * side + bc] = entry;
+				}
+			}
+		}
+	});
+
+	// join the per slice lists and rebase their offsets
+	subcells.clear();
+	candidates.clear();
+	ambiguousParts = 0;
+	for (int rc = 0; rc < side; rc++) {
+		unsigned int subBase = (unsigned int) subcells.size();
+		unsigned int base = (unsigned int) candidates.size();
+		unsigned int* cells = &table[(size_t) rc * side * side];
+		for (int i = 0; i < side * side; i++) {
+			if (cells[i] & AMBIGUOUS) {
+				cells[i] += subBase;
+			}
+		}
+		vector<unsigned int>& subs = subSlices[rc];
+		for (size_t i = 0; i < subs.size(); i++) {
+			if (subs[i] & AMBIGUOUS) {
+				subs[i] += base;
+				ambiguousParts++;
+			}
+		}
+		subcells.insert(subcells.end(), subs.begin(), subs.end());
+		candidates.insert(candidates.end(), slices[rc].begin(), slices[rc].end());
+	}
+	return true;
+}
+
+/**
+ * @return grid resolution per channel
+ */
+int InverseColormap::getBits() const
+{
+	return bits;
+}
+
+size_t InverseColormap::getPaletteSize() const
+{
+	return colors.size() / 3;
+}
+
+/**
+ * Share of the grid, by volume, where lookups compare candidates instead of
+ * reading one entry. It falls as the palette gets smaller or the grid finer;
+ * for 200 random colors it is about 25% with 5 bits and 9% with 6 bits.
+ * 
+ * @return 0..1
+ */
+float InverseColormap::getAmbiguousRatio() const
+{
+	size_t parts = bits < 8 ? 8 : 1;
+	return table.empty() ? 0 : (float) ambiguousParts / (table.size() * parts);
+}
+
+/**
+ * @return palette as 0..255 RGB triplets, in palette order
+ */
+const float* InverseColormap::getColors() const
+{
+	return colors.empty() ? NULL : &colors[0];
+}
+
+/**
+ * Resolves a boundary cell: reads the entry of the part of the cell that
+ * holds the color, then if needed searches that part's candidates.
+ */
+int InverseColormap::search(unsigned int offset, int r, int g, int b) const
+{
+	int half = 128 >> bits;
+	if (half > 0) {
+		offset += ((r & half) ? 4 : 0) | ((g & half) ? 2 : 0) | ((b & half) ? 1 : 0);
+	}
+	unsigned int entry = subcells[offset];
+	if (!(entry & AMBIGUOUS)) {
+		return (int) entry;
+	}
+	const unsigned short* list = &candidates[entry & ~AMBIGUOUS];
+	int count = list[0];
+	int best = list[1];
+	float bestDist = 1E30f;
+	for (int i = 1; i <= count; i++) {
+		const float* c = &colors[list[i] * 3];
+		float dr = c[0] - r, dg = c[1] - g, db = c[2] - b;
+		float d = dr * dr + dg * dg + db * db;
+		if (d < bestDist) {
+			bestDist = d;
+			best = list[i];
+		}
+	}
+	return best;
+}
\ No newline at end of file
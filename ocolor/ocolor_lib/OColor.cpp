@@ -1,4 +1,5 @@
 #include "OColor.h"
+#include "ColorDifference.h"
 
 const OColor OColor::RED  = OColor::newRGB(1, 0, 0);
 const OColor OColor::GREEN = OColor::newRGB(0,1,0);
@@ -16,6 +17,8 @@ const float OColor::BLACK_POINT = .08;
 const float OColor::WHITE_POINT = 1.0;
 const float OColor::GREY_THRESHOLD = .01;
 
+vector<float> OColor::_tempVector(4);
+
 const RYB_Struct OColor::WHEEL_VALUES[] = {
 	RYB_Struct(0, 0), RYB_Struct(15, 8), RYB_Struct(30, 17),
 	RYB_Struct(45, 26), RYB_Struct(60, 34), RYB_Struct(75, 41),
@@ -145,11 +148,11 @@ OColor* OColor::analog(float theta, float delta) {
  *            interpolation factor
  * @return itself
  */
-OColor* OColor::blend_RGB(OColor c, float t) {
+OColor* OColor::blend_RGB(const OColor& c, float t) {
 	rgb[0] += (c.rgb[0] - rgb[0]) * t;
-	rgb[1] += (c.rgb[0] - rgb[1]) * t;
-	rgb[2] += (c.rgb[0] - rgb[2]) * t;
-	alpha += (c.getAlpha() - alpha) * t;
+	rgb[1] += (c.rgb[1] - rgb[1]) * t;
+	rgb[2] += (c.rgb[2] - rgb[2]) * t;
+	alpha += (c.alpha - alpha) * t;
 	return setRGB(rgb);
 }
 
@@ -162,12 +165,35 @@ OColor* OColor::blend_RGB(OColor c, float t) {
  *            interpolation factor
  * @return itself
  */
-OColor* OColor::blend_BGR(OColor c, float t) {
+OColor* OColor::blend_BGR(const OColor& c, float t) {
 	bgr[0] += (c.bgr[0] - bgr[0]) * t;
-	bgr[1] += (c.bgr[0] - bgr[1]) * t;
-	bgr[2] += (c.bgr[0] - bgr[2]) * t;
-	alpha += (c.getAlpha() - alpha) * t;
-	return setRGB(bgr);
+	bgr[1] += (c.bgr[1] - bgr[1]) * t;
+	bgr[2] += (c.bgr[2] - bgr[2]) * t;
+	alpha += (c.alpha - alpha) * t;
+	return setBGR(bgr);
+}
+
+/**
+ * Blends the color with the given one by the stated amount. Interpolating
+ * in OKLab keeps perceived lightness even and avoids the dull midpoints of
+ * RGB blends.
+ * 
+ * @param c
+ *            target color
+ * @param t
+ *            interpolation factor
+ * @return itself
+ */
+OColor* OColor::blend_OKLab(const OColor& c, float t) {
+	float lab1[3], lab2[3], result[3];
+	toOKLabArray(lab1);
+	c.toOKLabArray(lab2);
+	for (int i = 0; i < 3; i++) {
+		lab1[i] += (lab2[i] - lab1[i]) * t;
+	}
+	oklabToRGB(lab1[0], lab1[1], lab1[2], result);
+	alpha += (c.alpha - alpha) * t;
+	return setRGB(result);
 }
 
 /**
@@ -207,11 +233,11 @@ OColor* OColor::desaturate(float step) {
  *            target color
  * @return distance
  */
-float OColor::distanceToCMYK(OColor color) {
+float OColor::distanceToCMYK(const OColor& color) const {
 	float dc = cmyk[0] - color.cmyk[0];
-	float dm = cmyk[1] - color.cmyk[0];
-	float dy = cmyk[2] - color.cmyk[0];
-	float dk = cmyk[3] - color.cmyk[0];
+	float dm = cmyk[1] - color.cmyk[1];
+	float dy = cmyk[2] - color.cmyk[2];
+	float dk = cmyk[3] - color.cmyk[3];
 	return (float) sqrt(dc * dc + dm * dm + dy * dy + dk * dk);
 }
 
@@ -222,16 +248,16 @@ float OColor::distanceToCMYK(OColor color) {
  *            target color
  * @return distance
  */
-float OColor::distanceToHSV(OColor c) {
-	float hue = hsv[0] * MathUtils.TWO_PI;
-	float hue2 = c.getHue() * MathUtils.TWO_PI;
+float OColor::distanceToHSV(const OColor& c) const {
+	float hue = hsv[0] * MathUtils::TWO_PI;
+	float hue2 = c.hsv[0] * MathUtils::TWO_PI;
 	float v1x = (cos(hue) * hsv[1]);
 	float v1y = (sin(hue) * hsv[1]);
 	float v1z = hsv[2];
 
-	float v2x = (cos(hue2) * c.getSaturation());
-	float v2y = (sin(hue2) * c.getSaturation());
-	float v2z = c.getBrightness();
+	float v2x = (cos(hue2) * c.hsv[1]);
+	float v2y = (sin(hue2) * c.hsv[1]);
+	float v2z = c.hsv[2];
 	
 	float dx = v1x - v2x;
 	float dy = v1y - v2y;
@@ -247,21 +273,56 @@ float OColor::distanceToHSV(OColor c) {
  *            target color
  * @return distance
  */
-float OColor::distanceToRGB(OColor color)
+float OColor::distanceToRGB(const OColor& color) const
 {
-	float crgb[3] = {color.rgb[0], color.rgb[1], color.rgb[2]};
-
-	float dr = red - crgb[0];
-	float dg = green - crgb[1];
-	float db = blue - crgb[2];
+	float dr = rgb[0] - color.rgb[0];
+	float dg = rgb[1] - color.rgb[1];
+	float db = rgb[2] - color.rgb[2];
 
 	return sqrt( ( (dr * dr) + (dg * dg) + (db * db) )  );
 }
 
+/**
+ * Calculates the OKLab (Euclidean, deltaE OK) distance to the given color.
+ * 
+ * @param color
+ *            target color
+ * @return distance, about 0..1
+ */
+float OColor::distanceToOKLab(const OColor& color) const
+{
+	float lab1[3], lab2[3];
+	toOKLabArray(lab1);
+	color.toOKLabArray(lab2);
+	float dl = lab1[0] - lab2[0];
+	float da = lab1[1] - lab2[1];
+	float db = lab1[2] - lab2[2];
+
+	return sqrt(dl * dl + da * da + db * db);
+}
+
+/**
+ * Calculates the CIE Lab color difference (delta E) to the given color.
+ * 
+ * @param color
+ *            target color
+ * @param metric
+ *            DELTA_E_76, DELTA_E_94 (this color is the reference) or
+ *            DELTA_E_2000
+ * @return delta E, where about 1 is a just noticeable difference
+ */
+float OColor::distanceToLab(const OColor& color, DeltaEMetric metric) const
+{
+	float lab1[3], lab2[3];
+	rgbToLab(rgb[0], rgb[1], rgb[2], lab1);
+	rgbToLab(color.rgb[0], color.rgb[1], color.rgb[2], lab2);
+	return DeltaE::distance(metric, lab1, lab2);
+}
+
 /**
  * @return the color's alpha component
  */
-float OColor::getAlpha() {
+float OColor::getAlpha() const {
 	return alpha;
 }
 
@@ -284,42 +345,42 @@ OColor* OColor::getAnalog(float theta, float delta) {
 /**
  * @return the color's black component
  */
-float OColor::getBlack() {
+float OColor::getBlack() const {
 	return cmyk[3];
 }
 
 /**
  * @return the color's blue component
  */
-float OColor::getBlue_RGB() {
+float OColor::getBlue_RGB() const {
 	return rgb[2];
 }
 
 /**
  * @return the color's blue component
  */
-float OColor::getBlue_BGR() {
+float OColor::getBlue_BGR() const {
 	return bgr[0];
 }
 
 /**
  * @return the color's green component
  */
-float OColor::getGreen_RGB() {
+float OColor::getGreen_RGB() const {
 	return rgb[1];
 }
 
 /**
  * @return the color's green component
  */
-float OColor::getGreen_BGR() {
+float OColor::getGreen_BGR() const {
 	return bgr[1];
 }
 
 /**
  * @return the color's hue
  */
-float OColor::getHue() {
+float OColor::getHue() const {
 	return hsv[0];
 }
 
@@ -340,7 +401,7 @@ OColor* OColor::invertRGB() {
  */
 OColor* OColor::invertBGR() {
 	bgr[0] = 1 - bgr[0];
-	rgb[1] = 1 - rgb[1];
+	bgr[1] = 1 - bgr[1];
 	bgr[2] = 1 - bgr[2];
 	return setBGR(bgr);
 }
@@ -349,7 +410,7 @@ OColor* OColor::invertBGR() {
  * @return true, if all rgb component values are equal and less than
  *         {@link OColor#BLACK_POINT}
  */
-bool OColor::isBlack() {
+bool OColor::isBlack() const {
 	return ( rgb[0] <= BLACK_POINT && (fabs(rgb[0] - rgb[1]) <= .000001) && (fabs(rgb[1] - rgb[2]) <= .000001) );
 }
 
@@ -357,7 +418,7 @@ bool OColor::isBlack() {
  * @return true, if the saturation component value is less than
  *         {@link OColor#GREY_THRESHOLD}
  */
-bool OColor::isGrey() {
+bool OColor::isGrey() const {
 	return hsv[1] < GREY_THRESHOLD;
 }
 
@@ -365,7 +426,7 @@ bool OColor::isGrey() {
  * @return true, if all rgb component values are equal and greater than
  *         {@link OColor#WHITE_POINT}
  */
-bool OColor::isWhite() {
+bool OColor::isWhite() const {
 		return ( rgb[0] >= WHITE_POINT && (fabs(rgb[0] - rgb[1]) <= .000001) && (fabs(rgb[1] - rgb[2]) <= .000001) );
 }
 
@@ -374,7 +435,7 @@ bool OColor::isWhite() {
  * @return true, if color is a primary color
  *         
  */
-bool OColor::isPrimary() {
+bool OColor::isPrimary() const {
 	return Hue::isThisPrimary(hsv[0]);
 }
 
@@ -397,7 +458,7 @@ OColor* OColor::lighten(float step) {
  *            interpolation factor
  * @return itself
  */
-OColor* OColor::getBlended_RGB(OColor c, float t) {
+OColor* OColor::getBlended_RGB(const OColor& c, float t) {
 	return this->blend_RGB(c, t);
 }
 
@@ -410,22 +471,36 @@ OColor* OColor::getBlended_RGB(OColor c, float t) {
  *            interpolation factor
  * @return itself
  */
-OColor* OColor::getBlended_BGR(OColor c, float t) {
+OColor* OColor::getBlended_BGR(const OColor& c, float t) {
 	return this->blend_BGR(c,t);
 }
 
+/**
+ * Blends the color with the given one by the stated amount, in OKLab.
+ * 
+ * @param c
+ *            target color
+ * @param t
+ *            interpolation factor
+ * @return itself
+ * @see #blend_OKLab()
+ */
+OColor* OColor::getBlended_OKLab(const OColor& c, float t) {
+	return this->blend_OKLab(c, t);
+}
+
 /**
  * Get the brightness of a color.
  * @return color HSV brightness (not luminance!)
  */
-float OColor::getBrightness() {
+float OColor::getBrightness() const {
 	return hsv[2];
 }
 
 /**
  * @return the color's cyan component
  */
-float OColor::getCyan() {
+float OColor::getCyan() const {
 	return cmyk[0];
 }
 
@@ -504,7 +579,7 @@ OColor* OColor::getLightened(float step) {
  * 
  * @return luminance
  */
-float OColor::getLuminance() {
+float OColor::getLuminance() const {
 	return rgb[0] * 0.299f + rgb[1] * 0.587f + rgb[2] * 0.114f;
 }
 
@@ -512,15 +587,15 @@ float OColor::getLuminance() {
  * Get the Magenta component of this color.
  * @return the color's magenta component
  */
-float OColor::getMagenta() {
-	return cmyk[0];
+float OColor::getMagenta() const {
+	return cmyk[1];
 }
 
 /**
  * Get the Red component of an RGB-based color.
  * @return the color's red component
  */
-float OColor::getRed_RGB() {
+float OColor::getRed_RGB() const {
 	return rgb[0];
 }
 
@@ -528,7 +603,7 @@ float OColor::getRed_RGB() {
  * Get the Red component of a BGR-based color.
  * @return the color's red component
  */
-float OColor::getRed_BGR() {
+float OColor::getRed_BGR() const {
 	return bgr[2];
 }
 
@@ -565,7 +640,7 @@ OColor* OColor::getSaturated(float step) {
  * Get the Yellow component of a color.
  * @return the color's yellow component
  */
-float OColor::getYellow() {
+float OColor::getYellow() const {
 	return cmyk[2];
 }
 
@@ -588,7 +663,21 @@ OColor* OColor::rotateRYB(float theta) {
  * @return itself
  */
 OColor* OColor::rotateRYB(int theta) {
-	float h = hsv[0] * 360;
+	hsv[0] = rotateHueRYB(hsv[0], theta);
+	return setHSV(hsv);
+}
+
+/**
+ * Rotates a hue by x degrees along the <a
+ * href="http://en.wikipedia.org/wiki/RYB_color_model">RYB color wheel</a>
+ * 
+ * @param hue
+ *            normalized hue (0..1)
+ * @param theta
+ * @return rotated hue (0..1)
+ */
+float OColor::rotateHueRYB(float hue, int theta) {
+	float h = hue * 360;
 	theta %= 360;
 
 	float resultHue = 0;
@@ -621,8 +710,7 @@ OColor* OColor::rotateRYB(int theta) {
 		}
 	}
 
-	hsv[0] = fmod(h, 360) / 360.0f;
-	return setHSV(hsv);
+	return fmod(h, 360) / 360.0f;
 }
 
 /**
@@ -642,7 +730,7 @@ OColor* OColor::saturate(float step) {
  * @return the color's saturation
  * @see #saturate()
  */
-float OColor::getSaturation() {
+float OColor::getSaturation() const {
 	return hsv[1];
 }
 
@@ -668,10 +756,24 @@ OColor* OColor::setRGB(float r, float g, float b) {
  *			a vector<float>
  * @return itself
  */
-OColor* OColor::setRGB(vector<float> rgbVector) {
-	rgb[0] = MathUtils::clip(rgbVector[0], 0.0, 1.0);
-	rgb[1] = MathUtils::clip(rgbVector[1], 0.0, 1.0);
-	rgb[2] = MathUtils::clip(rgbVector[2], 0.0, 1.0);
+OColor* OColor::setRGB(const vector<float>& rgbVector) {
+	return setRGB(&rgbVector[0]);
+}
+
+/**
+ * Set the RGB components of a color.
+ * 
+ * @param rgbArray
+ *			array of 3 floats, may alias this color's own fields
+ * @return itself
+ */
+OColor* OColor::setRGB(const float* rgbArray) {
+	rgb[0] = MathUtils::clip(rgbArray[0], 0.0, 1.0);
+	rgb[1] = MathUtils::clip(rgbArray[1], 0.0, 1.0);
+	rgb[2] = MathUtils::clip(rgbArray[2], 0.0, 1.0);
+	bgr[0] = rgb[2];
+	bgr[1] = rgb[1];
+	bgr[2] = rgb[0];
 	rgbToCMYK(rgb[0], rgb[1], rgb[2], cmyk);
 	rgbToHSV(rgb[0], rgb[1], rgb[2], hsv);
 	return this;
@@ -699,7 +801,7 @@ OColor* OColor::setARGB(int argb) {
 	setRGB(((argb >> 16) & 0xff) * INV8BIT, 
 		   ((argb >> 8)  & 0xff) * INV8BIT,
 			(argb        & 0xff) * INV8BIT);
-	alpha = (argb >> 24)         * INV8BIT;
+	alpha = ((argb >> 24) & 0xff) * INV8BIT;
 	return this;
 }
 
@@ -725,12 +827,26 @@ OColor* OColor::setBGR(float b, float g, float r) {
  *			a vector<float>
  * @return itself
  */
-OColor* OColor::setBGR(vector<float> bgrVector) {
-	bgr[0] = MathUtils::clip(bgrVector[0], 0.0, 1.0);
-	bgr[1] = MathUtils::clip(bgrVector[1], 0.0, 1.0);
-	bgr[2] = MathUtils::clip(bgrVector[2], 0.0, 1.0);
-	bgrToCMYK(rgb[0], rgb[1], rgb[2], cmyk);
-	bgrToHSV(rgb[0], rgb[1], rgb[2], hsv);
+OColor* OColor::setBGR(const vector<float>& bgrVector) {
+	return setBGR(&bgrVector[0]);
+}
+
+/**
+ * Set the BGR component of a color
+ * 
+ * @param bgrArray
+ *			array of 3 floats, may alias this color's own fields
+ * @return itself
+ */
+OColor* OColor::setBGR(const float* bgrArray) {
+	bgr[0] = MathUtils::clip(bgrArray[0], 0.0, 1.0);
+	bgr[1] = MathUtils::clip(bgrArray[1], 0.0, 1.0);
+	bgr[2] = MathUtils::clip(bgrArray[2], 0.0, 1.0);
+	rgb[0] = bgr[2];
+	rgb[1] = bgr[1];
+	rgb[2] = bgr[0];
+	bgrToCMYK(bgr[0], bgr[1], bgr[2], cmyk);
+	bgrToHSV(bgr[0], bgr[1], bgr[2], hsv);
 	return this;
 }
 
@@ -833,14 +949,32 @@ OColor* OColor::setHSV(float h, float s, float v) {
  *			a vector<float>
  * @return itself
  */
-OColor* OColor::setHSV(vector<float> hsvVector) {
-	hsv[0] = ((int) hsvVector[0] % 1);
+OColor* OColor::setHSV(const vector<float>& hsvVector) {
+	return setHSV(&hsvVector[0]);
+}
+
+/**
+ * Set the HSV component of a color
+ * 
+ * @param hsvArray
+ *			array of 3 floats, may alias this color's own fields
+ * @return itself
+ */
+OColor* OColor::setHSV(const float* hsvArray) {
+	hsv[0] = fmodf(hsvArray[0], 1);
 	if (hsv[0] < 0) {
 		hsv[0]++;
 	}
-	hsv[1] = MathUtils::clip(hsvVector[1], 0.0, 1.0);
-	hsv[2] = MathUtils::clip(hsvVector[2], 0.0, 1.0);
+	// tiny negative hues round up to exactly 1
+	if (hsv[0] >= 1) {
+		hsv[0] = 0;
+	}
+	hsv[1] = MathUtils::clip(hsvArray[1], 0.0, 1.0);
+	hsv[2] = MathUtils::clip(hsvArray[2], 0.0, 1.0);
 	hsvToRGB(hsv[0], hsv[1], hsv[2], rgb);
+	bgr[0] = rgb[2];
+	bgr[1] = rgb[1];
+	bgr[2] = rgb[0];
 	rgbToCMYK(rgb[0], rgb[1], rgb[2], cmyk);
 	return this;
 }
@@ -871,13 +1005,28 @@ OColor* OColor::setCMYK(float c, float m, float y, float k)
  *			a vector<float>
  * @return itself
  */
-OColor* OColor::setCMYK(vector<float> cmykVector)
+OColor* OColor::setCMYK(const vector<float>& cmykVector)
 {
-	cmykVector[0] = MathUtils::clip(cmykVector[0], 0.0, 1.0);
-	cmykVector[1] = MathUtils::clip(cmykVector[1], 0.0, 1.0);
-	cmykVector[2] = MathUtils::clip(cmykVector[2], 0.0, 1.0);
-	cmykVector[3] = MathUtils::clip(cmykVector[3], 0.0, 1.0);
-	cmykToRGB(cmykVector[0], cmykVector[1], cmykVector[2], cmykVector[3], rgb);
+	return setCMYK(&cmykVector[0]);
+}
+
+/**
+ * Set the CMYK component of a color
+ * 
+ * @param cmykArray
+ *			array of 4 floats, may alias this color's own fields
+ * @return itself
+ */
+OColor* OColor::setCMYK(const float* cmykArray)
+{
+	cmyk[0] = MathUtils::clip(cmykArray[0], 0.0, 1.0);
+	cmyk[1] = MathUtils::clip(cmykArray[1], 0.0, 1.0);
+	cmyk[2] = MathUtils::clip(cmykArray[2], 0.0, 1.0);
+	cmyk[3] = MathUtils::clip(cmykArray[3], 0.0, 1.0);
+	cmykToRGB(cmyk[0], cmyk[1], cmyk[2], cmyk[3], rgb);
+	bgr[0] = rgb[2];
+	bgr[1] = rgb[1];
+	bgr[2] = rgb[0];
 	rgbToHSV(rgb[0], rgb[1], rgb[2], hsv);
 	return this;
 }
@@ -889,10 +1038,14 @@ OColor* OColor::setCMYK(vector<float> cmykVector)
  * @return itself
  */
 OColor* OColor::setHue(float hue) {
-	hue = ((int) hue % 1);
+	hue = fmodf(hue, 1);
 	if (hue < 0.0) {
 		hue++;
 	}
+	// tiny negative hues round up to exactly 1
+	if (hue >= 1) {
+		hue = 0;
+	}
 	hsv[0] = hue;
 	return setHSV(hsv);
 }
@@ -926,7 +1079,7 @@ OColor* OColor::setRed_RGB(float r) {
  * @return itself
  */
 OColor* OColor::setRed_BGR(float r) {
-	bgr[0] = r;
+	bgr[2] = r;
 	return setBGR(bgr);
 }
 
@@ -952,17 +1105,26 @@ OColor* OColor::setYellow(float val) {
 	return setCMYK(cmyk);
 }
 
+/**
+ * Rounds a 0..1 channel to 0..255, so packing inverts the * INV8BIT of
+ * unpacking exactly.
+ */
+static unsigned toByte(float v)
+{
+	return v > 0 ? (v < 1 ? (unsigned) (v * 255 + 0.5f) : 255) : 0;
+}
+
 /**
  * Converts the color into a packed BGRA int.
  * 
  * @return color as int
  */
-int OColor::toBGRA()
+int OColor::toBGRA() const
 {
-	return (int) (rgb[2] * 255) << 24 | 
-		   (int) (rgb[1] * 255) << 16 | 
-		   (int) (rgb[0] * 255) << 8  | 
-		   (int) (alpha  * 255);
+	return (int) (toByte(rgb[2]) << 24 | 
+				  toByte(rgb[1]) << 16 | 
+				  toByte(rgb[0]) << 8  | 
+				  toByte(alpha));
 }
 
 /**
@@ -970,26 +1132,26 @@ int OColor::toBGRA()
  * 
  * @return color as int
  */
-int OColor::toARGB() 
+int OColor::toARGB() const
 {
-	return (int) (rgb[0] * 255) << 16 | 
-		   (int) (rgb[1] * 255) << 8  | 
-		   (int) (rgb[2] * 255)		  | 
-		   (int) (alpha * 255) << 24;
+	return (int) (toByte(rgb[0]) << 16 | 
+				  toByte(rgb[1]) << 8  | 
+				  toByte(rgb[2])	   | 
+				  toByte(alpha)  << 24);
 }
 
 /**
- * Copies the current CMYKA values into the given vector.
+ * Copies the current CMYKA values into the given vector, which is resized
+ * to 5 elements.
  * 
  * @param cmyka
  *            result array
  * @return array in this order: c,m,y,k,a
  */
 vector<float> OColor::toCMYKAArray(vector<float> cmyka) {
-	cmyka[0] = cmyk[0];
-	cmyka[1] = cmyk[1];
-	cmyka[2] = cmyk[2];
-	cmyka[3] = alpha;
+	float values[5];
+	toCMYKAArray(values);
+	cmyka.assign(values, values + 5);
 	return cmyka;
 }
 
@@ -999,12 +1161,21 @@ vector<float> OColor::toCMYKAArray(vector<float> cmyka) {
  * @return array in this order: c,m,y,k,a
  */
 vector<float> OColor::toCMYKAArray() {
-	vector<float> cmyka;
+	return toCMYKAArray(vector<float>());
+}
+
+/**
+ * Copies the current CMYKA values into the given array.
+ * 
+ * @param cmyka
+ *            result array, in this order: c,m,y,k,a
+ */
+void OColor::toCMYKAArray(float (&cmyka)[5]) const {
 	cmyka[0] = cmyk[0];
 	cmyka[1] = cmyk[1];
 	cmyka[2] = cmyk[2];
-	cmyka[3] = alpha;
-	return cmyka;
+	cmyka[3] = cmyk[3];
+	cmyka[4] = alpha;
 }
 
 /**
@@ -1014,10 +1185,7 @@ vector<float> OColor::toCMYKAArray() {
  * @return array in this order: h,s,v,a
  */
 vector<float> OColor::toHSVAArray(vector<float> hsva) { 
-	hsva[0] = hsv[0];
-	hsva[1] = hsv[1];
-	hsva[2] = hsv[2];
-	hsva[3] = alpha;
+	toHSVAArray(&hsva[0]);
 	return hsva;
 }
 
@@ -1027,12 +1195,56 @@ vector<float> OColor::toHSVAArray(vector<float> hsva) {
  * @return array in this order: h,s,v,a
  */
 vector<float> OColor::toHSVAArray() {
-	vector<float> hsva;
+	vector<float> hsva(4);
+	toHSVAArray(&hsva[0]);
+	return hsva;
+}
+
+/**
+ * Copies the current HSVA values into the given array.
+ * 
+ * @param hsva
+ *            result array of 4 floats, in this order: h,s,v,a
+ */
+void OColor::toHSVAArray(float* hsva) const {
 	hsva[0] = hsv[0];
 	hsva[1] = hsv[1];
 	hsva[2] = hsv[2];
 	hsva[3] = alpha;
-	return hsva;
+}
+
+/**
+ * Copies the current color as YCbCr normalized code values into the given
+ * array.
+ * 
+ * @param ycbcr
+ *            result array of 3 floats, in this order: y,cb,cr
+ * @param standard
+ * @param fullRange
+ * @see #rgbToYCbCr()
+ */
+void OColor::toYCbCrArray(float* ycbcr, YCbCrStandard standard, bool fullRange) const {
+	rgbToYCbCr(rgb[0], rgb[1], rgb[2], standard, fullRange, ycbcr);
+}
+
+/**
+ * Copies the current color as OKLab into the given array.
+ * 
+ * @param lab
+ *            result array of 3 floats, in this order: L,a,b
+ */
+void OColor::toOKLabArray(float* lab) const {
+	rgbToOKLab(rgb[0], rgb[1], rgb[2], lab);
+}
+
+/**
+ * Copies the current color as OKLCh into the given array.
+ * 
+ * @param lch
+ *            result array of 3 floats, in this order: L,chroma,hue
+ */
+void OColor::toOKLChArray(float* lch) const {
+	rgbToOKLCh(rgb[0], rgb[1], rgb[2], lch);
 }
 
 /**
@@ -1055,11 +1267,23 @@ vector<float> OColor::toRGBAArray(vector<float> rgba) {
  * @return vector<float>
  */
 vector<float> OColor::toRGBAArray(vector<float> rgba, unsigned int offset) {
+	toRGBAArray(&rgba[0], offset);
+	return rgba;
+}
+
+/**
+ * Copies the current RGBA value into the given array starting at the given
+ * offset. Use this to fill interleaved float buffers without copies.
+ * 
+ * @param rgba
+ *            result array, in this order: r,g,b,a (OpenGL format)
+ * @param offset
+ */
+void OColor::toRGBAArray(float* rgba, unsigned int offset) const {
 	rgba[offset++] = rgb[0];
 	rgba[offset++] = rgb[1];
 	rgba[offset++] = rgb[2];
 	rgba[offset] = alpha;
-	return rgba;
 }
 
 /**
@@ -1082,28 +1306,36 @@ vector<float> OColor::toBGRAArray(vector<float> bgra) {
  * @return vector<float>
  */
 vector<float> OColor::toBGRAArray(vector<float> bgra, unsigned int offset) {
+	toBGRAArray(&bgra[0], offset);
+	return bgra;
+}
+
+/**
+ * Copies the current BGRA value into the given array starting at the given
+ * offset.
+ * 
+ * @param bgra
+ *            result array, in this order: b,g,r,a
+ * @param offset
+ */
+void OColor::toBGRAArray(float* bgra, unsigned int offset) const {
 	bgra[offset++] = bgr[0];
 	bgra[offset++] = bgr[1];
 	bgra[offset++] = bgr[2];
 	bgra[offset] = alpha;
-	return bgra;
 }
 
 /**
- * Utility method to unpack an int and copy its values to BGR & RGB fields.
+ * Utility method to unpack a BGRA int (as packed by toBGRA()) into the
+ * color fields. The masked bytes are already in range, so they are only
+ * normalized.
  * 
  * @param color
- * @return itself
  */
 void OColor::unpackColor(int color)
 {
-	// color is in BGRA
-
-	blue	= ((color >> 24) &0xff) < 0 ? 0 : (((color >> 24) &0xff) > 255 ? 255 : ((color >> 24) &0xff));
-	green	= ((color >> 16) &0xff) < 0 ? 0 : (((color >> 16) &0xff) > 255 ? 255 : ((color >> 16) &0xff));
-	red		= ((color >> 8) &0xff)  < 0 ? 0 : (((color >> 8)  &0xff) > 255 ? 255 : ((color >> 8)  &0xff));
-
-	bgr[2] = rgb[0]	 = red;
-	bgr[1] = rgb[1]  = green;
-	bgr[0] = rgb[2]  = blue;
+	blue	= ((color >> 24) & 0xff) * INV8BIT;
+	green	= ((color >> 16) & 0xff) * INV8BIT;
+	red		= ((color >> 8)  & 0xff) * INV8BIT;
+	setBGR(blue, green, red);
 }
@@ -0,0 +1,223 @@
+#include "OKLab.h"
+
+namespace {
+
+struct SRGB8Table {
+	float values[256];
+
+	SRGB8Table() {
+		for (int i = 0; i < 256; i++) {
+			values[i] = OColor::srgbToLinear(i / 255.0f);
+		}
+	}
+};
+
+}
+
+/**
+ * Linear values of the 256 8 bit sRGB levels. The table is built on first
+ * use, so it is also valid for callers running during static
+ * initialization.
+ */
+const float* OKLab::getSRGB8Table()
+{
+	static const SRGB8Table table;
+	return table.values;
+}
+
+/**
+ * Converts linear RGB triplets to OKLab.
+ * 
+ * @param rgb
+ *            buffer of count * 3 floats
+ * @param lab
+ *            result buffer of count * 3 floats, may be the same as rgb
+ * @param count
+ *            number of colors
+ */
+void OKLab::fromLinearRGB(const float* rgb, float* lab, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::linearRGBToOKLab(rgb[i], rgb[i + 1], rgb[i + 2], lab + i);
+	}
+}
+
+/**
+ * Converts OKLab triplets to linear RGB. The result is not clipped.
+ * 
+ * @param lab
+ *            buffer of count * 3 floats
+ * @param rgb
+ *            result buffer of count * 3 floats, may be the same as lab
+ * @param count
+ *            number of colors
+ */
+void OKLab::toLinearRGB(const float* lab, float* rgb, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::oklabToLinearRGB(lab[i], lab[i + 1], lab[i + 2], rgb + i);
+	}
+}
+
+/**
+ * Converts sRGB triplets (0..1) to OKLab.
+ * 
+ * @param rgb
+ *            buffer of count * 3 floats
+ * @param lab
+ *            result buffer of count * 3 floats, may be the same as rgb
+ * @param count
+ *            number of colors
+ */
+void OKLab::fromRGB(const float* rgb, float* lab, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::rgbToOKLab(rgb[i], rgb[i + 1], rgb[i + 2], lab + i);
+	}
+}
+
+/**
+ * Converts OKLab triplets to sRGB, clipped to 0..1.
+ * 
+ * @param lab
+ *            buffer of count * 3 floats
+ * @param rgb
+ *            result buffer of count * 3 floats, may be the same as lab
+ * @param count
+ *            number of colors
+ */
+void OKLab::toRGB(const float* lab, float* rgb, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::oklabToRGB(lab[i], lab[i + 1], lab[i + 2], rgb + i);
+	}
+}
+
+/**
+ * Converts OKLab triplets to OKLCh.
+ * 
+ * @param lab
+ * @param lch
+ *            result buffer, may be the same as lab
+ * @param count
+ */
+void OKLab::toLCh(const float* lab, float* lch, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::oklabToOKLCh(lab[i], lab[i + 1], lab[i + 2], lch + i);
+	}
+}
+
+/**
+ * Converts OKLCh triplets to OKLab.
+ * 
+ * @param lch
+ * @param lab
+ *            result buffer, may be the same as lch
+ * @param count
+ */
+void OKLab::fromLCh(const float* lch, float* lab, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i += 3) {
+		OColor::oklchToOKLab(lch[i], lch[i + 1], lch[i + 2], lab + i);
+	}
+}
+
+/**
+ * Linearly interpolates two OKLab buffers.
+ * 
+ * @param lab1
+ * @param lab2
+ * @param t
+ *            interpolation factor, 0 gives lab1 and 1 gives lab2
+ * @param lab
+ *            result buffer, may be the same as lab1 or lab2
+ * @param count
+ *            number of colors
+ */
+void OKLab::mix(const float* lab1, const float* lab2, float t, float* lab, size_t count)
+{
+	for (size_t i = 0; i < count * 3; i++) {
+		lab[i] = lab1[i] + (lab2[i] - lab1[i]) * t;
+	}
+}
+
+/**
+ * Fills a buffer with a gradient between two colors, interpolated in OKLab.
+ * Alpha is interpolated linearly.
+ * 
+ * @param from
+ *            first color
+ * @param to
+ *            last color
+ * @param steps
+ *            number of colors to write, at least 2
+ * @param rgba
+ *            result buffer of steps * 4 floats
+ */
+void OKLab::gradient(const OColor& from, const OColor& to, int steps, float* rgba)
+{
+	float lab1[3], lab2[3], lab[3];
+	from.toOKLabArray(lab1);
+	to.toOKLabArray(lab2);
+	float a1 = from.getAlpha();
+	float a2 = to.getAlpha();
+	for (int i = 0; i < steps; i++) {
+		float t = steps > 1 ? (float) i / (steps - 1) : 0;
+		mix(lab1, lab2, t, lab, 1);
+		OColor::oklabToRGB(lab[0], lab[1], lab[2], rgba + i * 4);
+		rgba[i * 4 + 3] = a1 + (a2 - a1) * t;
+	}
+}
+
+/**
+ * Calculates the OKLab distance (deltaE OK) of every color in a buffer to a
+ * reference color.
+ * 
+ * @param ref
+ *            reference L,a,b
+ * @param lab
+ *            buffer of count * 3 floats
+ * @param dist
+ *            result buffer of count floats
+ * @param count
+ *            number of colors
+ */
+void OKLab::distances(const float* ref, const float* lab, float* dist, size_t count)
+{
+	float l = ref[0], a = ref[1], b = ref[2];
+	for (size_t i = 0; i < count; i++) {
+		float dl = lab[i * 3] - l;
+		float da = lab[i * 3 + 1] - a;
+		float db = lab[i * 3 + 2] - b;
+		dist[i] = sqrt(dl * dl + da * da + db * db);
+	}
+}
+
+/**
+ * Finds the color in a buffer closest to a reference color.
+ * 
+ * @param ref
+ *            reference L,a,b
+ * @param lab
+ *            buffer of count * 3 floats
+ * @param count
+ *            number of colors, at least 1
+ * @return index of the closest color
+ */
+size_t OKLab::nearest(const float* ref, const float* lab, size_t count)
+{
+	size_t best = 0;
+	float bestDist = 1E30f;
+	for (size_t i = 0; i < count; i++) {
+		float dl = lab[i * 3] - ref[0];
+		float da = lab[i * 3 + 1] - ref[1];
+		float db = lab[i * 3 + 2] - ref[2];
+		float d = dl * dl + da * da + db * db;
+		if (d < bestDist) {
+			bestDist = d;
+			best = i;
+		}
+	}
+	return best;
+}
\ No newline at end of file
@@ -0,0 +1,467 @@
+#include "PackedColor.h"
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+inline unsigned quantize(float v, unsigned max)
+{
+	return v > 0 ? (v < 1 ? (unsigned) (v * max + 0.5f) : max) : 0;
+}
+
+/**
+ * Bit field of one channel in a packed word. A width of 0 means the format
+ * has no such channel; it reads as 1 (opaque) and is not written.
+ */
+template<int Shift, int Bits>
+struct Field {
+	static const unsigned MAX = Bits ? (1u << Bits) - 1 : 1;
+
+	static float unpack(unsigned v) {
+		return Bits ? ((v >> Shift) & MAX) * (1.0f / MAX) : 1.0f;
+	}
+
+	static unsigned pack(float v) {
+		return Bits ? quantize(v, MAX) << Shift : 0;
+	}
+
+#if defined(__SSE2__)
+	static __m128 unpack(__m128i v) {
+		if (!Bits) {
+			return _mm_set1_ps(1);
+		}
+		__m128i c = _mm_and_si128(_mm_srli_epi32(v, Shift), _mm_set1_epi32(MAX));
+		return _mm_mul_ps(_mm_cvtepi32_ps(c), _mm_set1_ps(1.0f / MAX));
+	}
+
+	static __m128i pack(__m128 v) {
+		if (!Bits) {
+			return _mm_setzero_si128();
+		}
+		// max(v, 0) picks 0 for NaN
+		v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1));
+		__m128i q = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps((float) MAX)), _mm_set1_ps(0.5f)));
+		return _mm_slli_epi32(q, Shift);
+	}
+#endif
+};
+
+#if defined(__SSE2__)
+inline __m128i loadWords(const unsigned int* p)
+{
+	return _mm_loadu_si128((const __m128i*) p);
+}
+
+inline __m128i loadWords(const unsigned short* p)
+{
+	return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*) p), _mm_setzero_si128());
+}
+
+// narrows 0 .. 65535 int32 lanes to unsigned shorts without SSE4.1's packus
+inline __m128i packUnsigned16(__m128i a, __m128i b)
+{
+	const __m128i bias = _mm_set1_epi32(0x8000);
+	__m128i v = _mm_packs_epi32(_mm_sub_epi32(a, bias), _mm_sub_epi32(b, bias));
+	return _mm_xor_si128(v, _mm_set1_epi16((short) 0x8000));
+}
+
+inline void storeWords(unsigned int* p, __m128i v)
+{
+	_mm_storeu_si128((__m128i*) p, v);
+}
+
+inline void storeWords(unsigned short* p, __m128i v)
+{
+	_mm_storel_epi64((__m128i*) p, packUnsigned16(v, v));
+}
+#endif
+
+/**
+ * Formats with one integer word per pixel.
+ */
+template<typename Word, typename R, typename G, typename B, typename A>
+struct WordLayout {
+	static void load(const void* src, size_t i, float& r, float& g, float& b, float& a) {
+		unsigned v = ((const Word*) src)[i];
+		r = R::unpack(v);
+		g = G::unpack(v);
+		b = B::unpack(v);
+		a = A::unpack(v);
+	}
+
+	static void store(void* dst, size_t i, float r, float g, float b, float a) {
+		((Word*) dst)[i] = (Word) (R::pack(r) | G::pack(g) | B::pack(b) | A::pack(a));
+	}
+
+#if defined(__SSE2__)
+	static void load4(const void* src, size_t i, __m128& r, __m128& g, __m128& b, __m128& a) {
+		__m128i v = loadWords((const Word*) src + i);
+		r = R::unpack(v);
+		g = G::unpack(v);
+		b = B::unpack(v);
+		a = A::unpack(v);
+	}
+
+	static void store4(void* dst, size_t i, __m128 r, __m128 g, __m128 b, __m128 a) {
+		__m128i v = _mm_or_si128(_mm_or_si128(R::pack(r), G::pack(g)), _mm_or_si128(B::pack(b), A::pack(a)));
+		storeWords((Word*) dst + i, v);
+	}
+#endif
+};
+
+/**
+ * Four unsigned shorts per pixel.
+ */
+struct RGBA16Layout {
+	static void load(const void* src, size_t i, float& r, float& g, float& b, float& a) {
+		const unsigned short* p = (const unsigned short*) src + i * 4;
+		r = p[0] * (1.0f / 65535);
+		g = p[1] * (1.0f / 65535);
+		b = p[2] * (1.0f / 65535);
+		a = p[3] * (1.0f / 65535);
+	}
+
+	static void store(void* dst, size_t i, float r, float g, float b, float a) {
+		unsigned short* p = (unsigned short*) dst + i * 4;
+		p[0] = (unsigned short) quantize(r, 65535);
+		p[1] = (unsigned short) quantize(g, 65535);
+		p[2] = (unsigned short) quantize(b, 65535);
+		p[3] = (unsigned short) quantize(a, 65535);
+	}
+
+#if defined(__SSE2__)
+	static __m128 toFloat(__m128i v) {
+		return _mm_mul_ps(_mm_cvtepi32_ps(v), _mm_set1_ps(1.0f / 65535));
+	}
+
+	static __m128i fromFloat(__m128 v) {
+		v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1));
+		return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(65535)), _mm_set1_ps(0.5f)));
+	}
+
+	static void load4(const void* src, size_t i, __m128& r, __m128& g, __m128& b, __m128& a) {
+		const __m128i* p = (const __m128i*) ((const unsigned short*) src + i * 4);
+		__m128i lo = _mm_loadu_si128(p);
+		__m128i hi = _mm_loadu_si128(p + 1);
+		r = toFloat(_mm_unpacklo_epi16(lo, _mm_setzero_si128()));
+		g = toFloat(_mm_unpackhi_epi16(lo, _mm_setzero_si128()));
+		b = toFloat(_mm_unpacklo_epi16(hi, _mm_setzero_si128()));
+		a = toFloat(_mm_unpackhi_epi16(hi, _mm_setzero_si128()));
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+	}
+
+	static void store4(void* dst, size_t i, __m128 r, __m128 g, __m128 b, __m128 a) {
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+		__m128i* p = (__m128i*) ((unsigned short*) dst + i * 4);
+		_mm_storeu_si128(p, packUnsigned16(fromFloat(r), fromFloat(g)));
+		_mm_storeu_si128(p + 1, packUnsigned16(fromFloat(b), fromFloat(a)));
+	}
+#endif
+};
+
+typedef WordLayout<unsigned int, Field<16, 8>, Field<8, 8>, Field<0, 8>, Field<24, 8> > ARGB8888Layout;
+typedef WordLayout<unsigned int, Field<8, 8>, Field<16, 8>, Field<24, 8>, Field<0, 8> > BGRA8888Layout;
+typedef WordLayout<unsigned int, Field<24, 8>, Field<16, 8>, Field<8, 8>, Field<0, 8> > RGBA8888Layout;
+typedef WordLayout<unsigned short, Field<11, 5>, Field<5, 6>, Field<0, 5>, Field<0, 0> > RGB565Layout;
+typedef WordLayout<unsigned int, Field<0, 10>, Field<10, 10>, Field<20, 10>, Field<30, 2> > RGB10A2Layout;
+
+template<typename L>
+void unpackInterleaved(const void* src, float* rgba, size_t count)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	for (; i + 4 <= count; i += 4) {
+		__m128 r, g, b, a;
+		L::load4(src, i, r, g, b, a);
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+		_mm_storeu_ps(rgba + i * 4, r);
+		_mm_storeu_ps(rgba + i * 4 + 4, g);
+		_mm_storeu_ps(rgba + i * 4 + 8, b);
+		_mm_storeu_ps(rgba + i * 4 + 12, a);
+	}
+#endif
+	for (; i < count; i++) {
+		float* p = rgba + i * 4;
+		L::load(src, i, p[0], p[1], p[2], p[3]);
+	}
+}
+
+template<typename L>
+void unpackPlanar(const void* src, float* red, float* green, float* blue, float* alpha, size_t count)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	for (; i + 4 <= count; i += 4) {
+		__m128 r, g, b, a;
+		L::load4(src, i, r, g, b, a);
+		_mm_storeu_ps(red + i, r);
+		_mm_storeu_ps(green + i, g);
+		_mm_storeu_ps(blue + i, b);
+		if (alpha) {
+			_mm_storeu_ps(alpha + i, a);
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		float a;
+		L::load(src, i, red[i], green[i], blue[i], a);
+		if (alpha) {
+			alpha[i] = a;
+		}
+	}
+}
+
+template<typename L>
+void packInterleaved(const float* rgba, void* dst, size_t count)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	for (; i + 4 <= count; i += 4) {
+		__m128 r = _mm_loadu_ps(rgba + i * 4);
+		__m128 g = _mm_loadu_ps(rgba + i * 4 + 4);
+		__m128 b = _mm_loadu_ps(rgba + i * 4 + 8);
+		__m128 a = _mm_loadu_ps(rgba + i * 4 + 12);
+		_MM_TRANSPOSE4_PS(r, g, b, a);
+		L::store4(dst, i, r, g, b, a);
+	}
+#endif
+	for (; i < count; i++) {
+		const float* p = rgba + i * 4;
+		L::store(dst, i, p[0], p[1], p[2], p[3]);
+	}
+}
+
+template<typename L>
+void packPlanar(const float* red, const float* green, const float* blue, const float* alpha, void* dst, size_t count)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	for (; i + 4 <= count; i += 4) {
+		__m128 a = alpha ? _mm_loadu_ps(alpha + i) : _mm_set1_ps(1);
+		L::store4(dst, i, _mm_loadu_ps(red + i), _mm_loadu_ps(green + i), _mm_loadu_ps(blue + i), a);
+	}
+#endif
+	for (; i < count; i++) {
+		L::store(dst, i, red[i], green[i], blue[i], alpha ? alpha[i] : 1);
+	}
+}
+
+struct PackedKernels {
+	void (*unpackInterleaved)(const void*, float*, size_t);
+	void (*unpackPlanar)(const void*, float*, float*, float*, float*, size_t);
+	void (*packInterleaved)(const float*, void*, size_t);
+	void (*packPlanar)(const float*, const float*, const float*, const float*, void*, size_t);
+	size_t size;
+	bool alpha;
+	// byte position of r, g, b, a for the 8 bit formats, else -1
+	int bytes[4];
+};
+
+template<typename L>
+PackedKernels kernels(size_t size, bool alpha, int r = -1, int g = -1, int b = -1, int a = -1)
+{
+	PackedKernels k = {
+		&unpackInterleaved<L>, &unpackPlanar<L>, &packInterleaved<L>, &packPlanar<L>, size, alpha, { r, g, b, a }
+	};
+	return k;
+}
+
+const PackedKernels& getKernels(PackedFormat format)
+{
+	static const PackedKernels table[] = {
+		kernels<ARGB8888Layout>(4, true, 2, 1, 0, 3),
+		kernels<BGRA8888Layout>(4, true, 1, 2, 3, 0),
+		kernels<RGBA8888Layout>(4, true, 3, 2, 1, 0),
+		kernels<RGB565Layout>(2, false),
+		kernels<RGB10A2Layout>(4, true),
+		kernels<RGBA16Layout>(8, true)
+	};
+	return table[format];
+}
+
+/**
+ * Moves the bytes of 8 bit formats: each channel is shifted from its byte
+ * in the source word to its byte in the destination word.
+ */
+void swizzle(const int* from, const int* to, const unsigned int* src, unsigned int* dst, size_t count)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i mask = _mm_set1_epi32(0xff);
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i*) (src + i));
+		__m128i out = _mm_setzero_si128();
+		for (int c = 0; c < 4; c++) {
+			__m128i channel = _mm_and_si128(_mm_srl_epi32(v, _mm_cvtsi32_si128(from[c] * 8)), mask);
+			out = _mm_or_si128(out, _mm_sll_epi32(channel, _mm_cvtsi32_si128(to[c] * 8)));
+		}
+		_mm_storeu_si128((__m128i*) (dst + i), out);
+	}
+#endif
+	for (; i < count; i++) {
+		unsigned v = src[i];
+		unsigned out = 0;
+		for (int c = 0; c < 4; c++) {
+			out |= ((v >> (from[c] * 8)) & 0xff) << (to[c] * 8);
+		}
+		dst[i] = out;
+	}
+}
+
+}
+
+/**
+ * @param format
+ * @return bytes per pixel
+ */
+size_t PackedColor::getPixelSize(PackedFormat format)
+{
+	return getKernels(format).size;
+}
+
+/**
+ * @param format
+ * @return false if the format has no alpha channel (RGB565)
+ */
+bool PackedColor::hasAlpha(PackedFormat format)
+{
+	return getKernels(format).alpha;
+}
+
+/**
+ * Unpacks pixels to interleaved RGBA floats. Formats without alpha give
+ * an alpha of 1.
+ * 
+ * @param format
+ * @param src
+ * @param rgba
+ *            4 * count floats
+ * @param count
+ *            number of pixels
+ */
+void PackedColor::unpack(PackedFormat format, const void* src, float* rgba, size_t count)
+{
+	getKernels(format).unpackInterleaved(src, rgba, count);
+}
+
+/**
+ * Unpacks pixels to one float plane per channel.
+ * 
+ * @param format
+ * @param src
+ * @param red
+ * @param green
+ * @param blue
+ * @param alpha
+ *            may be NULL
+ * @param count
+ *            number of pixels
+ */
+void PackedColor::unpack(PackedFormat format, const void* src, float* red, float* green, float* blue, float* alpha, size_t count)
+{
+	getKernels(format).unpackPlanar(src, red, green, blue, alpha, count);
+}
+
+/**
+ * Packs interleaved RGBA floats.
+ * 
+ * @param format
+ * @param rgba
+ *            4 * count floats
+ * @param dst
+ * @param count
+ *            number of pixels
+ */
+void PackedColor::pack(PackedFormat format, const float* rgba, void* dst, size_t count)
+{
+	getKernels(format).packInterleaved(rgba, dst, count);
+}
+
+/**
+ * Packs one float plane per channel.
+ * 
+ * @param format
+ * @param red
+ * @param green
+ * @param blue
+ * @param alpha
+ *            may be NULL for opaque pixels
+ * @param dst
+ * @param count
+ *            number of pixels
+ */
+void PackedColor::pack(PackedFormat format, const float* red, const float* green, const float* blue, const float* alpha,
+					   void* dst, size_t count)
+{
+	getKernels(format).packPlanar(red, green, blue, alpha, dst, count);
+}
+
+/**
+ * Converts pixels between two packed formats. The 8 bit formats are
+ * reordered in the integer domain; other pairs go through small float
+ * tiles and are exact whenever the destination has at least the bit depth
+ * of the source. src and dst must not overlap unless they are the same
+ * buffer and both formats have the same pixel size.
+ * 
+ * @param from
+ * @param src
+ * @param to
+ * @param dst
+ * @param count
+ *            number of pixels
+ */
+void PackedColor::convert(PackedFormat from, const void* src, PackedFormat to, void* dst, size_t count)
+{
+	const PackedKernels& in = getKernels(from);
+	const PackedKernels& out = getKernels(to);
+	if (from == to) {
+		if (src != dst) {
+			memcpy(dst, src, count * in.size);
+		}
+		return;
+	}
+	if (in.bytes[0] >= 0 && out.bytes[0] >= 0) {
+		swizzle(in.bytes, out.bytes, (const unsigned int*) src, (unsigned int*) dst, count);
+		return;
+	}
+	const size_t TILE = 256;
+	float rgba[TILE * 4];
+	for (size_t i = 0; i < count; i += TILE) {
+		size_t n = count - i < TILE ? count - i : TILE;
+		in.unpackInterleaved((const unsigned char*) src + i * in.size, rgba, n);
+		out.packInterleaved(rgba, (unsigned char*) dst + i * out.size, n);
+	}
+}
+
+/**
+ * @param format
+ * @param src
+ * @param i
+ *            pixel index
+ * @return new color from pixel i
+ */
+OColor PackedColor::read(PackedFormat format, const void* src, size_t i)
+{
+	const PackedKernels& k = getKernels(format);
+	float rgba[4];
+	k.unpackInterleaved((const unsigned char*) src + i * k.size, rgba, 1);
+	return OColor::newRGBA(rgba[0], rgba[1], rgba[2], rgba[3]);
+}
+
+/**
+ * Writes a color into pixel i.
+ * 
+ * @param format
+ * @param color
+ * @param dst
+ * @param i
+ *            pixel index
+ */
+void PackedColor::write(PackedFormat format, const OColor& color, void* dst, size_t i)
+{
+	const PackedKernels& k = getKernels(format);
+	float rgba[4] = { color.getRed_RGB(), color.getGreen_RGB(), color.getBlue_RGB(), color.getAlpha() };
+	k.packInterleaved(rgba, (unsigned char*) dst + i * k.size, 1);
+}
\ No newline at end of file
@@ -0,0 +1,183 @@
+#include "PaletteTracker.h"
+#include <cstring>
+
+PaletteTrackerOptions::PaletteTrackerOptions() :
+	tileSize(64), tileSamples(6), changeThreshold(0.02f), iterations(2), maxDrift(0.01f), weightSmoothing(0.3f)
+{
+
+}
+
+/**
+ * @param options
+ */
+PaletteTracker::PaletteTracker(const PaletteTrackerOptions& options) :
+	options(options), frameWidth(0), frameHeight(0), tilesX(0), tilesY(0), changedTiles(0), started(false)
+{
+
+}
+
+/**
+ * Forgets the tracked palette; the next frame is clustered from scratch.
+ */
+void PaletteTracker::reset()
+{
+	frameWidth = 0;
+	frameHeight = 0;
+	started = false;
+	palette.clear();
+}
+
+/**
+ * @return palette of the last frame, in stable order
+ */
+const vector<ColorCluster>& PaletteTracker::getPalette() const
+{
+	return palette;
+}
+
+/**
+ * @return number of tiles converted again in the last frame
+ */
+size_t PaletteTracker::getChangedTiles() const
+{
+	return changedTiles;
+}
+
+size_t PaletteTracker::getTileCount() const
+{
+	return tilesX * tilesY;
+}
+
+void PaletteTracker::prepare(size_t width, size_t height)
+{
+	if (width == frameWidth && height == frameHeight) {
+		return;
+	}
+	// new geometry: start over
+	reset();
+	frameWidth = width;
+	frameHeight = height;
+	size_t tileSize = getTileSize();
+	tilesX = (width + tileSize - 1) / tileSize;
+	tilesY = (height + tileSize - 1) / tileSize;
+	size_t count = tilesX * tilesY * getTileSamples() * getTileSamples();
+	samples.assign(count * 3, 0);
+	reference.assign(count * 3, -1);
+	x.assign(count, 0);
+	y.assign(count, 0);
+	z.assign(count, 0);
+}
+
+/**
+ * @return the tile edge, 64 if options.tileSize is not positive
+ */
+size_t PaletteTracker::getTileSize() const
+{
+	return options.tileSize > 0 ? options.tileSize : 64;
+}
+
+/**
+ * @return samples per tile edge, 6 if options.tileSamples is not positive
+ */
+size_t PaletteTracker::getTileSamples() const
+{
+	return options.tileSamples > 0 ? options.tileSamples : 6;
+}
+
+/**
+ * @return column of sample i of a tile, spread evenly over the tile
+ */
+size_t PaletteTracker::sampleX(size_t tile, size_t i) const
+{
+	size_t tileSize = getTileSize();
+	size_t left = (tile % tilesX) * tileSize;
+	size_t width = left + tileSize < frameWidth ? tileSize : frameWidth - left;
+	return left + (2 * i + 1) * width / (2 * getTileSamples());
+}
+
+/**
+ * @return row of sample j of a tile
+ */
+size_t PaletteTracker::sampleY(size_t tile, size_t j) const
+{
+	size_t tileSize = getTileSize();
+	size_t top = (tile / tilesX) * tileSize;
+	size_t height = top + tileSize < frameHeight ? tileSize : frameHeight - top;
+	return top + (2 * j + 1) * height / (2 * getTileSamples());
+}
+
+/**
+ * Converts the samples of changed tiles, then updates the clustering from
+ * the previous centres.
+ */
+const vector<ColorCluster>& PaletteTracker::track()
+{
+	size_t perTile = getTileSamples() * getTileSamples();
+	size_t tiles = tilesX * tilesY;
+	size_t n = tiles * perTile;
+	changedTiles = 0;
+	for (size_t tile = 0; tile < tiles; tile++) {
+		const float* now = &samples[tile * perTile * 3];
+		float* ref = &reference[tile * perTile * 3];
+		float change = 0;
+		for (size_t i = 0; i < perTile * 3; i++) {
+			change += fabs(now[i] - ref[i]);
+		}
+		if (change <= options.changeThreshold * perTile * 3) {
+			continue;
+		}
+		changedTiles++;
+		for (size_t i = 0; i < perTile; i++) {
+			size_t index = tile * perTile + i;
+			float point[3];
+			KMeans::toSpace(options.kmeans.space, now + i * 3, point);
+			x[index] = point[0];
+			y[index] = point[1];
+			z[index] = point[2];
+		}
+		memcpy(ref, now, perTile * 3 * sizeof(float));
+	}
+	if (n == 0) {
+		return palette;
+	}
+
+	vector<float> ones(n, 1.0f);
+	int k = options.kmeans.k < (int) n ? options.kmeans.k : (int) n;
+	vector<double> clusterWeights(k);
+	if (!started) {
+		centres.assign(k * 3, 0);
+		weights.assign(k, 0);
+		KMeans::seed(&x[0], &y[0], &z[0], &ones[0], n, k, options.kmeans.seed, &centres[0]);
+		KMeans::iterate(&x[0], &y[0], &z[0], &ones[0], n, k, &centres[0], &clusterWeights[0], options.kmeans);
+		for (int c = 0; c < k; c++) {
+			weights[c] = (float) (clusterWeights[c] / n);
+		}
+		started = true;
+	}
+	else if (changedTiles > 0) {
+		vector<float> previous(centres);
+		KMeansOptions warm(options.kmeans);
+		warm.maxIterations = options.iterations;
+		KMeans::iterate(&x[0], &y[0], &z[0], &ones[0], n, k, &centres[0], &clusterWeights[0], warm);
+		for (int c = 0; c < k; c++) {
+			float* centre = &centres[c * 3];
+			const float* from = &previous[c * 3];
+			float d[3] = { centre[0] - from[0], centre[1] - from[1], centre[2] - from[2] };
+			float length = sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+			if (length > options.maxDrift) {
+				float scale = options.maxDrift / length;
+				for (int i = 0; i < 3; i++) {
+					centre[i] = from[i] + d[i] * scale;
+				}
+			}
+			weights[c] += ((float) (clusterWeights[c] / n) - weights[c]) * options.weightSmoothing;
+		}
+	}
+
+	palette.resize(k);
+	for (int c = 0; c < k; c++) {
+		palette[c].color = KMeans::fromSpace(options.kmeans.space, &centres[c * 3]);
+		palette[c].weight = weights[c];
+	}
+	return palette;
+}
\ No newline at end of file
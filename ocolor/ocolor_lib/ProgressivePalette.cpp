@@ -0,0 +1,174 @@
+#include "ProgressivePalette.h"
+#include <chrono>
+
+// generators of the R2 sequence (Roberts, "The unreasonable effectiveness
+// of quasirandom sequences"), 1/g and 1/g^2 for the plastic number g
+static const double R2_X = 0.7548776662466927;
+static const double R2_Y = 0.5698402909980532;
+
+// share of the run() budget kept for clustering
+static const double CLUSTER_BUDGET = 0.3;
+
+/**
+ * @param options
+ *            clustering options; k, space and iteration limits apply to
+ *            every estimate
+ */
+ProgressivePalette::ProgressivePalette(const KMeansOptions& options) :
+	options(options), image(NULL), imageWidth(0), imageHeight(0), imageStride(0), reader(NULL), samples(0),
+	sequence(0), sweep(0)
+{
+	reset();
+}
+
+/**
+ * Discards all samples and restarts the sequence.
+ */
+void ProgressivePalette::reset()
+{
+	samples = 0;
+	sequence = 0;
+	sweep = 0;
+	visited.assign(imageWidth * imageHeight, false);
+	cells.assign(KMeans::HISTOGRAM_SIZE * 4, 0);
+	previous.clear();
+}
+
+/**
+ * Takes more samples. Every sample is a pixel that has not been read
+ * before: the R2 sequence hits some pixels more than once and misses
+ * others, so repeated hits are skipped, and once the sequence has run for
+ * as many steps as there are pixels the pixels it missed are read in row
+ * order. Once every pixel has been read further calls do nothing.
+ * 
+ * @param count
+ *            number of samples to take
+ */
+void ProgressivePalette::sample(size_t count)
+{
+	size_t pixels = imageWidth * imageHeight;
+	if (!reader || pixels == 0) {
+		return;
+	}
+	const int shift = 8 - KMeans::HISTOGRAM_BITS;
+	size_t end = samples + count < pixels ? samples + count : pixels;
+	while (samples < end) {
+		size_t x, y;
+		if (sequence < pixels) {
+			sequence++;
+			double u = 0.5 + R2_X * sequence;
+			double v = 0.5 + R2_Y * sequence;
+			x = (size_t) ((u - (size_t) u) * imageWidth);
+			y = (size_t) ((v - (size_t) v) * imageHeight);
+		}
+		else {
+			while (visited[sweep]) {
+				sweep++;
+			}
+			x = sweep % imageWidth;
+			y = sweep / imageWidth;
+		}
+		size_t index = y * imageWidth + x;
+		if (visited[index]) {
+			continue;
+		}
+		visited[index] = true;
+		samples++;
+		float rgb[3];
+		reader((const char*) image + y * imageStride, x, rgb);
+		int cell = 0;
+		for (int c = 0; c < 3; c++) {
+			int q = (int) (MathUtils::clipNormalized(rgb[c]) * 255 + 0.5f);
+			cell = (cell << KMeans::HISTOGRAM_BITS) | (q >> shift);
+		}
+		double* p = &cells[cell * 4];
+		p[0] += 1;
+		p[1] += rgb[0];
+		p[2] += rgb[1];
+		p[3] += rgb[2];
+	}
+}
+
+/**
+ * Clusters the samples taken so far.
+ * 
+ * @return the current palette and its quality measures
+ */
+PaletteEstimate ProgressivePalette::estimate()
+{
+	vector<float> rgb;
+	vector<float> weights;
+	for (int cell = 0; cell < KMeans::HISTOGRAM_SIZE; cell++) {
+		double n = cells[cell * 4];
+		if (n > 0) {
+			rgb.push_back((float) (cells[cell * 4 + 1] / n));
+			rgb.push_back((float) (cells[cell * 4 + 2] / n));
+			rgb.push_back((float) (cells[cell * 4 + 3] / n));
+			weights.push_back((float) n);
+		}
+	}
+
+	PaletteEstimate result;
+	result.samples = samples;
+	result.complete = samples > 0 && samples >= imageWidth * imageHeight;
+	result.confidence = 0;
+	result.drift = 0;
+	if (!weights.empty()) {
+		result.palette = KMeans::cluster(&rgb[0], &weights[0], weights.size(), options);
+	}
+
+	float maxError = 0;
+	for (size_t i = 0; i < result.palette.size(); i++) {
+		float w = result.palette[i].weight;
+		float error = 3 * sqrt(w * (1 - w) / (float) samples);
+		maxError = error > maxError ? error : maxError;
+	}
+	result.confidence = result.complete ? 1 : (samples > 0 ? MathUtils::clipNormalized(1 - maxError) : 0);
+
+	for (size_t i = 0; i < result.palette.size(); i++) {
+		float closest = previous.empty() ? 0 : 1E30f;
+		for (size_t j = 0; j < previous.size(); j++) {
+			float d = result.palette[i].color.distanceToOKLab(previous[j].color);
+			closest = d < closest ? d : closest;
+		}
+		result.drift = closest > result.drift ? closest : result.drift;
+	}
+	previous = result.palette;
+	return result;
+}
+
+/**
+ * Samples until the time budget or the sample limit is used up, then
+ * estimates the palette. About a third of the budget is kept for the
+ * clustering.
+ * 
+ * @param milliseconds
+ *            time budget
+ * @param maxSamples
+ *            additional samples to take at most, 0 for no limit
+ * @return the current palette
+ */
+PaletteEstimate ProgressivePalette::run(double milliseconds, size_t maxSamples)
+{
+	typedef chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	double sampling = milliseconds * (1 - CLUSTER_BUDGET);
+	size_t target = maxSamples > 0 ? samples + maxSamples : (size_t) -1;
+	size_t pixels = imageWidth * imageHeight;
+	while (samples < target && samples < pixels) {
+		size_t batch = target - samples < BATCH ? target - samples : BATCH;
+		sample(batch);
+		if (chrono::duration<double, milli>(Clock::now() - start).count() >= sampling) {
+			break;
+		}
+	}
+	return estimate();
+}
+
+/**
+ * @return number of samples taken since the last reset
+ */
+size_t ProgressivePalette::getSampleCount() const
+{
+	return samples;
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "YUVConvert.h"
+
+static int toFixed(double v)
+{
+	return (int) (v * 65536 + (v < 0 ? -0.5 : 0.5));
+}
+
+/**
+ * Builds the fixed point coefficients for a YCbCr standard and range.
+ * 
+ * @param standard
+ * @param fullRange
+ *            true for 0..255 (JPEG) levels, false for 16..235/240 (video)
+ * @return coefficients for the YUVConvert kernels
+ */
+YUVCoefficients YUVConvert::coefficients(YCbCrStandard standard, bool fullRange)
+{
+	float fkr, fkb;
+	OColor::getYCbCrWeights(standard, &fkr, &fkb);
+	double kr = fkr;
+	double kb = fkb;
+	double kg = 1 - kr - kb;
+	double yRange = fullRange ? 1.0 : 219 / 255.0;
+	double cRange = fullRange ? 1.0 : 224 / 255.0;
+
+	YUVCoefficients k;
+	k.yOffset = fullRange ? 0 : 16;
+
+	k.yScale = toFixed(1 / yRange);
+	k.crToR = toFixed(2 * (1 - kr) / cRange);
+	k.cbToG = toFixed(2 * kb * (1 - kb) / kg / cRange);
+	k.crToG = toFixed(2 * kr * (1 - kr) / kg / cRange);
+	k.cbToB = toFixed(2 * (1 - kb) / cRange);
+
+	k.rToY = toFixed(kr * yRange);
+	k.gToY = toFixed(kg * yRange);
+	k.bToY = toFixed(kb * yRange);
+	k.rToCb = toFixed(-kr / (2 * (1 - kb)) * cRange);
+	k.gToCb = toFixed(-kg / (2 * (1 - kb)) * cRange);
+	k.bToCb = toFixed(0.5 * cRange);
+	k.rToCr = toFixed(0.5 * cRange);
+	k.gToCr = toFixed(-kg / (2 * (1 - kr)) * cRange);
+	k.bToCr = toFixed(-kb / (2 * (1 - kr)) * cRange);
+	return k;
+}
\ No newline at end of file
@@ -0,0 +1,500 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/*
+ * ocolor-convert
+ *
+ * Streams raw RGBA/BGRA frames or a PAM stream from stdin through a chain
+ * of OColor operations and writes the result to stdout, e.g.
+ *
+ *   ffmpeg -i in.mp4 -f rawvideo -pix_fmt rgba - |
+ *     ocolor-convert --raw 1920x1080 hsv:0,0.2,0 rotate-ryb:30 |
+ *     ffmpeg -f rawvideo -pix_fmt rgba -s 1920x1080 -i - out.mp4
+ *
+ * Reading, converting and writing run on separate threads connected by
+ * lock-free single-producer/single-consumer rings, so I/O overlaps with
+ * the color math. Throughput and the time each stage spent stalled on its
+ * neighbours are reported on stderr at the end.
+ *
+ * Build: compile with the ocolor_lib sources and link with the platform
+ * thread library (-pthread), and name the binary ocolor-convert.
+ */
+
+#include "OColor.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+using namespace std;
+
+/**
+ * Lock-free ring of frame slot indices for exactly one producer and one
+ * consumer thread.
+ */
+template<int N>
+class SpscRing {
+public:
+	SpscRing() : head(0), tail(0) {}
+
+	bool push(int value) {
+		size_t h = head.load(memory_order_relaxed);
+		if (h - tail.load(memory_order_acquire) == N) {
+			return false;
+		}
+		slots[h % N] = value;
+		head.store(h + 1, memory_order_release);
+		return true;
+	}
+
+	bool pop(int* value) {
+		size_t t = tail.load(memory_order_relaxed);
+		if (t == head.load(memory_order_acquire)) {
+			return false;
+		}
+		*value = slots[t % N];
+		tail.store(t + 1, memory_order_release);
+		return true;
+	}
+
+private:
+	int slots[N];
+	alignas(64) atomic<size_t> head;
+	alignas(64) atomic<size_t> tail;
+};
+
+static const int FRAME_SLOTS = 4;
+static const int END_OF_STREAM = -1;
+
+typedef SpscRing<FRAME_SLOTS + 1> FrameRing;
+typedef chrono::steady_clock Clock;
+
+/**
+ * One frame in flight. PAM frames keep their header so it can be written
+ * back unchanged.
+ */
+struct Frame {
+	string header;
+	vector<unsigned char> data;
+	int width;
+	int height;
+	int depth;
+};
+
+/**
+ * Time a pipeline stage spent working and waiting.
+ */
+struct StageStats {
+	StageStats() : busy(0), stalled(0) {}
+
+	double busy;
+	double stalled;
+};
+
+enum OpType {
+	OP_HSV,
+	OP_INVERT,
+	OP_ROTATE_RYB,
+	OP_LAB,
+	OP_CMYK,
+	OP_QUANTIZE
+};
+
+struct Op {
+	OpType type;
+	float params[3];
+};
+
+struct Options {
+	Options() : raw(false), bgra(false), width(0), height(0), depth(4) {}
+
+	bool raw;
+	bool bgra;
+	int width;
+	int height;
+	int depth;
+	vector<Op> ops;
+};
+
+static double seconds(Clock::duration d)
+{
+	return chrono::duration<double>(d).count();
+}
+
+/**
+ * Pushes to a ring, spinning then yielding while it is full. Time spent
+ * waiting is added to the stage's stall counter.
+ */
+static void pushWait(FrameRing& ring, int value, StageStats& stats)
+{
+	if (ring.push(value)) {
+		return;
+	}
+	Clock::time_point start = Clock::now();
+	while (!ring.push(value)) {
+		this_thread::yield();
+	}
+	stats.stalled += seconds(Clock::now() - start);
+}
+
+/**
+ * Pops from a ring, spinning then yielding while it is empty.
+ */
+static int popWait(FrameRing& ring, StageStats& stats)
+{
+	int value;
+	if (ring.pop(&value)) {
+		return value;
+	}
+	Clock::time_point start = Clock::now();
+	while (!ring.pop(&value)) {
+		this_thread::yield();
+	}
+	stats.stalled += seconds(Clock::now() - start);
+	return value;
+}
+
+/**
+ * Reads a PAM header from the stream up to and including ENDHDR.
+ * 
+ * @return false at end of stream or on a malformed header
+ */
+static bool readPamHeader(FILE* in, Frame& frame)
+{
+	frame.header.clear();
+	frame.width = frame.height = frame.depth = 0;
+	int maxval = 0;
+	string line;
+	int c;
+	while ((c = fgetc(in)) != EOF) {
+		frame.header += (char) c;
+		if (c != '\n') {
+			line += (char) c;
+			continue;
+		}
+		if (line.size() + 1 == frame.header.size() && line != "P7") {
+			return false;
+		}
+		char key[32];
+		int value;
+		if (line == "ENDHDR") {
+			return frame.width > 0 && frame.height > 0 && (frame.depth == 3 || frame.depth == 4) && maxval == 255;
+		} else if (sscanf(line.c_str(), "%31s %d", key, &value) == 2) {
+			if (strcmp(key, "WIDTH") == 0) {
+				frame.width = value;
+			} else if (strcmp(key, "HEIGHT") == 0) {
+				frame.height = value;
+			} else if (strcmp(key, "DEPTH") == 0) {
+				frame.depth = value;
+			} else if (strcmp(key, "MAXVAL") == 0) {
+				maxval = value;
+			}
+		}
+		line.clear();
+	}
+	return false;
+}
+
+/**
+ * Applies the operation chain to one pixel given as normalized RGBA.
+ */
+static void applyOps(const vector<Op>& ops, float* rgba, bool hasAlpha)
+{
+	for (size_t i = 0; i < ops.size(); i++) {
+		const Op& op = ops[i];
+		switch (op.type) {
+			case OP_HSV: {
+				float hsv[3];
+				OColor::rgbToHSV(rgba[0], rgba[1], rgba[2], hsv);
+				hsv[0] = fmod(hsv[0] + op.params[0], 1.0f);
+				if (hsv[0] < 0) {
+					hsv[0] += 1;
+				}
+				// tiny negative hues round up to exactly 1, as in OColor::setHSV()
+				if (hsv[0] >= 1) {
+					hsv[0] = 0;
+				}
+				hsv[1] = MathUtils::clip(hsv[1] + op.params[1], 0.0f, 1.0f);
+				hsv[2] = MathUtils::clip(hsv[2] + op.params[2], 0.0f, 1.0f);
+				OColor::hsvToRGB(hsv[0], hsv[1], hsv[2], rgba);
+				break;
+			}
+			case OP_INVERT:
+				rgba[0] = 1 - rgba[0];
+				rgba[1] = 1 - rgba[1];
+				rgba[2] = 1 - rgba[2];
+				break;
+			case OP_ROTATE_RYB: {
+				float alpha = rgba[3];
+				OColor c;
+				c.setRGB(rgba);
+				c.rotateRYB((int) op.params[0]);
+				c.toRGBAArray(rgba);
+				rgba[3] = alpha;
+				break;
+			}
+			case OP_LAB: {
+				// L in 0..100, a/b offset by 128 to fit into 8 bits
+				float lab[3];
+				OColor::rgbToLab(rgba[0], rgba[1], rgba[2], lab);
+				rgba[0] = lab[0] / 100;
+				rgba[1] = (lab[1] + 128) / 255;
+				rgba[2] = (lab[2] + 128) / 255;
+				break;
+			}
+			case OP_CMYK: {
+				// K goes into the alpha channel, or is folded into CMY
+				float cmyk[4];
+				OColor::rgbToCMYK(rgba[0], rgba[1], rgba[2], cmyk);
+				if (hasAlpha) {
+					rgba[0] = cmyk[0];
+					rgba[1] = cmyk[1];
+					rgba[2] = cmyk[2];
+					rgba[3] = cmyk[3];
+				} else {
+					rgba[0] = MathUtils::min(cmyk[0] + cmyk[3], 1.0f);
+					rgba[1] = MathUtils::min(cmyk[1] + cmyk[3], 1.0f);
+					rgba[2] = MathUtils::min(cmyk[2] + cmyk[3], 1.0f);
+				}
+				break;
+			}
+			case OP_QUANTIZE: {
+				float levels = op.params[0] - 1;
+				for (int c = 0; c < 3; c++) {
+					rgba[c] = MathUtils::floor(rgba[c] * levels + 0.5f) / levels;
+				}
+				break;
+			}
+		}
+	}
+}
+
+static void convertFrame(const Options& options, Frame& frame)
+{
+	int r = options.bgra ? 2 : 0;
+	int b = options.bgra ? 0 : 2;
+	int depth = frame.depth;
+	size_t pixels = (size_t) frame.width * frame.height;
+	unsigned char* p = &frame.data[0];
+	for (size_t i = 0; i < pixels; i++, p += depth) {
+		float rgba[4];
+		rgba[0] = p[r] * OColor::INV8BIT;
+		rgba[1] = p[1] * OColor::INV8BIT;
+		rgba[2] = p[b] * OColor::INV8BIT;
+		rgba[3] = depth == 4 ? p[3] * OColor::INV8BIT : 1;
+		applyOps(options.ops, rgba, depth == 4);
+		p[r] = (unsigned char) (MathUtils::clip(rgba[0], 0.0f, 1.0f) * 255 + 0.5f);
+		p[1] = (unsigned char) (MathUtils::clip(rgba[1], 0.0f, 1.0f) * 255 + 0.5f);
+		p[b] = (unsigned char) (MathUtils::clip(rgba[2], 0.0f, 1.0f) * 255 + 0.5f);
+		if (depth == 4) {
+			p[3] = (unsigned char) (MathUtils::clip(rgba[3], 0.0f, 1.0f) * 255 + 0.5f);
+		}
+	}
+}
+
+static bool parseOp(const char* arg, Op& op)
+{
+	op.params[0] = op.params[1] = op.params[2] = 0;
+	if (strncmp(arg, "hsv:", 4) == 0) {
+		op.type = OP_HSV;
+		return sscanf(arg + 4, "%f,%f,%f", &op.params[0], &op.params[1], &op.params[2]) == 3;
+	} else if (strcmp(arg, "invert") == 0) {
+		op.type = OP_INVERT;
+	} else if (strncmp(arg, "rotate-ryb:", 11) == 0) {
+		op.type = OP_ROTATE_RYB;
+		return sscanf(arg + 11, "%f", &op.params[0]) == 1;
+	} else if (strcmp(arg, "lab") == 0) {
+		op.type = OP_LAB;
+	} else if (strcmp(arg, "cmyk") == 0) {
+		op.type = OP_CMYK;
+	} else if (strncmp(arg, "quantize:", 9) == 0) {
+		op.type = OP_QUANTIZE;
+		return sscanf(arg + 9, "%f", &op.params[0]) == 1 && op.params[0] >= 2;
+	} else {
+		return false;
+	}
+	return true;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: ocolor-convert [--raw WIDTHxHEIGHT [--depth 3|4]] [--bgra] op...\n"
+		"\n"
+		"Reads a PAM stream (8 bit RGB or RGB_ALPHA), or raw frames with --raw,\n"
+		"from stdin and writes the converted frames to stdout.\n"
+		"\n"
+		"ops, applied in order:\n"
+		"  hsv:DH,DS,DV     add to hue (wraps), saturation and brightness (clip)\n"
+		"  invert           invert RGB\n"
+		"  rotate-ryb:DEG   rotate along the RYB color wheel\n"
+		"  lab              encode as CIE Lab (L/100, (a+128)/255, (b+128)/255)\n"
+		"  cmyk             encode as CMYK (K in alpha, or folded into CMY)\n"
+		"  quantize:N       quantize each channel to N levels\n");
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	for (int i = 1; i < argc; i++) {
+		Op op;
+		if (strcmp(argv[i], "--raw") == 0 && i + 1 < argc) {
+			options.raw = true;
+			if (sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 ||
+				options.width <= 0 || options.height <= 0) {
+				usage();
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+			options.depth = atoi(argv[++i]);
+			if (options.depth != 3 && options.depth != 4) {
+				usage();
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--bgra") == 0) {
+			options.bgra = true;
+		} else if (parseOp(argv[i], op)) {
+			options.ops.push_back(op);
+		} else {
+			usage();
+			return 1;
+		}
+	}
+
+#ifdef _WIN32
+	_setmode(_fileno(stdin), _O_BINARY);
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+	setvbuf(stdin, NULL, _IOFBF, 1 << 20);
+	setvbuf(stdout, NULL, _IOFBF, 1 << 20);
+
+	Frame frames[FRAME_SLOTS];
+	FrameRing freeRing, readRing, convertedRing;
+	for (int i = 0; i < FRAME_SLOTS; i++) {
+		freeRing.push(i);
+	}
+
+	StageStats readStats, convertStats, writeStats;
+	atomic<bool> failed(false);
+	long frameCount = 0;
+	Clock::time_point start = Clock::now();
+
+	thread reader([&]() {
+		long framesRead = 0;
+		for (;;) {
+			int slot = popWait(freeRing, readStats);
+			Clock::time_point t = Clock::now();
+			Frame& frame = frames[slot];
+			if (options.raw) {
+				frame.width = options.width;
+				frame.height = options.height;
+				frame.depth = options.depth;
+			} else if (!readPamHeader(stdin, frame)) {
+				if (!feof(stdin) || !frame.header.empty()) {
+					fprintf(stderr, "ocolor-convert: unsupported or malformed PAM header\n");
+					failed = true;
+				}
+				break;
+			}
+			size_t bytes = (size_t) frame.width * frame.height * frame.depth;
+			frame.data.resize(bytes);
+			size_t got = fread(&frame.data[0], 1, bytes, stdin);
+			if (got != bytes) {
+				// a raw stream may end between frames, nothing else may
+				if (got > 0 || !options.raw || !feof(stdin)) {
+					fprintf(stderr, "ocolor-convert: truncated frame %ld (%zu of %zu bytes)\n", framesRead, got, bytes);
+					failed = true;
+				}
+				break;
+			}
+			framesRead++;
+			readStats.busy += seconds(Clock::now() - t);
+			pushWait(readRing, slot, readStats);
+		}
+		pushWait(readRing, END_OF_STREAM, readStats);
+	});
+
+	thread converter([&]() {
+		int slot;
+		while ((slot = popWait(readRing, convertStats)) != END_OF_STREAM) {
+			Clock::time_point t = Clock::now();
+			convertFrame(options, frames[slot]);
+			convertStats.busy += seconds(Clock::now() - t);
+			pushWait(convertedRing, slot, convertStats);
+		}
+		pushWait(convertedRing, END_OF_STREAM, convertStats);
+	});
+
+	thread writer([&]() {
+		bool writeFailed = false;
+		int slot;
+		while ((slot = popWait(convertedRing, writeStats)) != END_OF_STREAM) {
+			Clock::time_point t = Clock::now();
+			Frame& frame = frames[slot];
+			// after a failed write the remaining frames are only drained
+			if (!writeFailed) {
+				bool written = frame.header.empty() ||
+						fwrite(frame.header.data(), 1, frame.header.size(), stdout) == frame.header.size();
+				written = written && fwrite(&frame.data[0], 1, frame.data.size(), stdout) == frame.data.size();
+				if (!written) {
+					fprintf(stderr, "ocolor-convert: write failed at frame %ld\n", frameCount);
+					writeFailed = true;
+					failed = true;
+				}
+			}
+			frameCount++;
+			writeStats.busy += seconds(Clock::now() - t);
+			pushWait(freeRing, slot, writeStats);
+		}
+		fflush(stdout);
+	});
+
+	reader.join();
+	converter.join();
+	writer.join();
+
+	double elapsed = seconds(Clock::now() - start);
+	fprintf(stderr, "ocolor-convert: %ld frames in %.3f s (%.2f frames/s)\n",
+			frameCount, elapsed, elapsed > 0 ? frameCount / elapsed : 0.0);
+	fprintf(stderr, "  read    busy %8.1f ms  stalled %8.1f ms\n", readStats.busy * 1000, readStats.stalled * 1000);
+	fprintf(stderr, "  convert busy %8.1f ms  stalled %8.1f ms\n", convertStats.busy * 1000, convertStats.stalled * 1000);
+	fprintf(stderr, "  write   busy %8.1f ms  stalled %8.1f ms\n", writeStats.busy * 1000, writeStats.stalled * 1000);
+	return failed ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+/*
+ * ocolor-dither-bench
+ *
+ * Measures the throughput of every Dither method on a synthetic image,
+ * e.g.
+ *
+ *   ocolor-dither-bench --size 3840x2160 --colors 64 --threads 8
+ *
+ * The image is a set of smooth gradients, the palette an even grid over
+ * the RGB cube. For each method the best of a few runs is reported in
+ * megapixels per second, together with the mean error of 16x16 block
+ * averages against the source as a rough check of tone reproduction.
+ *
+ * Build: compile with the ocolor_lib sources and link with the platform
+ * thread library (-pthread), and name the binary ocolor-dither-bench.
+ */
+
+#include "Dither.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+
+struct Method {
+	const char* name;
+	DitherMethod method;
+	bool serpentine;
+};
+
+static const Method METHODS[] = {
+	{ "none", DITHER_NONE, false },
+	{ "bayer", DITHER_BAYER, false },
+	{ "blue-noise", DITHER_BLUE_NOISE, false },
+	{ "floyd-steinberg", DITHER_FLOYD_STEINBERG, false },
+	{ "floyd-steinberg-serpentine", DITHER_FLOYD_STEINBERG, true },
+	{ "atkinson", DITHER_ATKINSON, false },
+	{ "atkinson-serpentine", DITHER_ATKINSON, true }
+};
+
+static double blockError(const vector<unsigned char>& pixels, const vector<unsigned char>& indices,
+		const float* colors, int width, int height)
+{
+	double error = 0;
+	int blocks = 0;
+	for (int by = 0; by + 16 <= height; by += 16) {
+		for (int bx = 0; bx + 16 <= width; bx += 16) {
+			double sum[3] = { 0, 0, 0 };
+			for (int y = by; y < by + 16; y++) {
+				for (int x = bx; x < bx + 16; x++) {
+					size_t i = (size_t) y * width + x;
+					for (int k = 0; k < 3; k++) {
+						sum[k] += pixels[i * 4 + k] - colors[indices[i] * 3 + k];
+					}
+				}
+			}
+			error += (fabs(sum[0]) + fabs(sum[1]) + fabs(sum[2])) / (3 * 256);
+			blocks++;
+		}
+	}
+	return blocks > 0 ? error / blocks : 0;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: ocolor-dither-bench [--size WIDTHxHEIGHT] [--colors N] [--threads N] [--runs N]\n"
+		"\n"
+		"Defaults: 3840x2160, 64 colors (8 to 256, rounded down to a cube), one\n"
+		"thread per core, 3 runs per method.\n");
+}
+
+int main(int argc, char** argv)
+{
+	int width = 3840, height = 2160, colors = 64, runs = 3;
+	unsigned threads = 0;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+			if (sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+				usage();
+				return 1;
+			}
+		} else if (strcmp(argv[i], "--colors") == 0 && i + 1 < argc) {
+			colors = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+			threads = (unsigned) atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--runs") == 0 && i + 1 < argc) {
+			runs = atoi(argv[++i]);
+		} else {
+			usage();
+			return 1;
+		}
+	}
+	// indices are stored as unsigned char
+	int levels = (int) floor(cbrt((double) colors) + 1E-6);
+	if (levels < 2 || colors > 256 || runs < 1) {
+		usage();
+		return 1;
+	}
+
+	vector<OColor> palette;
+	for (int r = 0; r < levels; r++) {
+		for (int g = 0; g < levels; g++) {
+			for (int b = 0; b < levels; b++) {
+				palette.push_back(OColor::newRGB((float) r / (levels - 1), (float) g / (levels - 1), (float) b / (levels - 1)));
+			}
+		}
+	}
+	InverseColormap map;
+	Clock::time_point start = Clock::now();
+	map.build(palette, 5, true, threads);
+	double buildTime = chrono::duration<double>(Clock::now() - start).count();
+
+	vector<unsigned char> pixels((size_t) width * height * 4);
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			unsigned char* p = &pixels[((size_t) y * width + x) * 4];
+			p[0] = (unsigned char) (x * 255 / width);
+			p[1] = (unsigned char) (y * 255 / height);
+			p[2] = (unsigned char) (127.5 + 127.5 * sin(x * 0.004 + y * 0.003));
+			p[3] = 255;
+		}
+	}
+	vector<unsigned char> indices((size_t) width * height);
+	Dither::getBlueNoise();
+
+	printf("%dx%d, %d colors, %u threads, colormap built in %.1f ms\n", width, height, (int) palette.size(),
+			Parallel::getThreadCount(threads), buildTime * 1000);
+	for (size_t m = 0; m < sizeof(METHODS) / sizeof(METHODS[0]); m++) {
+		DitherOptions options;
+		options.method = METHODS[m].method;
+		options.serpentine = METHODS[m].serpentine;
+		options.threads = threads;
+		double best = 1E30;
+		for (int run = 0; run < runs; run++) {
+			start = Clock::now();
+			Dither::apply<RGBA8>(&pixels[0], width, height, width * 4, map, &indices[0], options);
+			double elapsed = chrono::duration<double>(Clock::now() - start).count();
+			best = elapsed < best ? elapsed : best;
+		}
+		printf("  %-28s %8.1f ms %8.1f MP/s  block error %.2f\n", METHODS[m].name, best * 1000,
+				(double) width * height / best / 1E6, blockError(pixels, indices, map.getColors(), width, height));
+	}
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,118 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+/*
+ * ocolor-gradient-check
+ *
+ * Checks ColorGradient at the 0/1 hue seam: an HSV gradient from red to
+ * a hue just below 1 is evaluated at tiny parameters, where the
+ * interpolated hue is a tiny negative number, and must stay red instead
+ * of wrapping to magenta. Also checks that adding a stop or changing the
+ * space drops a baked ramp instead of sampling the old one. Prints each
+ * failing case and exits with 1 if there are any, e.g.
+ *
+ *   ocolor-gradient-check
+ *
+ * Build: compile with the ocolor_lib sources, link with the platform
+ * thread library (-pthread), and name the binary ocolor-gradient-check.
+ */
+
+#include "ColorGradient.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace std;
+
+static int failures = 0;
+
+static void expect(const char* name, float t, const float* rgba, const float* want, float tolerance)
+{
+	for (int c = 0; c < 4; c++) {
+		if (!(fabs(rgba[c] - want[c]) <= tolerance)) {
+			printf("%s at %g: got (%g, %g, %g, %g), expected (%g, %g, %g, %g)\n", name, t,
+				rgba[0], rgba[1], rgba[2], rgba[3], want[0], want[1], want[2], want[3]);
+			failures++;
+			return;
+		}
+	}
+}
+
+static void checkHueSeam()
+{
+	const float red[4] = { 1, 0, 0, 1 };
+	const float ts[] = { 0, 1E-7f, 1E-6f, 1E-5f };
+	ColorGradient gradient(GRADIENT_HSV);
+	gradient.addStop(0, OColor::newRGB(1, 0, 0));
+	gradient.addStop(1, OColor::newHSV(0.9f, 1, 1));
+	for (size_t i = 0; i < sizeof(ts) / sizeof(ts[0]); i++) {
+		float rgba[4];
+		gradient.getColor(ts[i], rgba);
+		expect("HSV red to hue 0.9", ts[i], rgba, red, 1E-3f);
+	}
+}
+
+static void checkStaleRamp()
+{
+	ColorGradient gradient(GRADIENT_RGB);
+	gradient.addStop(0, OColor::newRGB(1, 0, 0));
+	gradient.addStop(1, OColor::newRGB(1, 0, 0.6f));
+	float t = 0.5f, rgba[4];
+	if (!gradient.bake(16) || !gradient.sample(&t, rgba, 1)) {
+		printf("bake(16) did not give a ramp\n");
+		failures++;
+	}
+	gradient.addStop(0.5f, OColor::newRGB(0, 1, 0));
+	if (gradient.sample(&t, rgba, 1) || gradient.getRampSize() != 0) {
+		printf("addStop() kept the baked ramp\n");
+		failures++;
+	}
+	gradient.bake(16);
+	gradient.setSpace(GRADIENT_OKLAB);
+	if (gradient.sample(&t, rgba, 1) || gradient.getRampSize() != 0) {
+		printf("setSpace() kept the baked ramp\n");
+		failures++;
+	}
+	const float green[4] = { 0, 1, 0, 1 };
+	// 17 entries put t = 0.5 exactly on an entry
+	gradient.bake(17);
+	gradient.sample(&t, rgba, 1);
+	expect("ramp baked again", t, rgba, green, 1E-3f);
+}
+
+int main()
+{
+	checkHueSeam();
+	checkStaleRamp();
+	printf("%d failures\n", failures);
+	return failures == 0 ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,159 @@
+/* 
+ * This is a C++ port of the toxi colorutils lib for Java & Processing.
+ *
+ * This library was inspired by Karsten Schmidt's (AKA toxi) color
+ * library for Java & Processing. His excellent code provided the
+ * framework for this C++ / openFrameWorks implementation.
+ * You can find his color library, as well as his other code at
+ *	http://hg.postspectacular.com/toxiclibs/wiki/Home or http://toxiclibs.org/
+ *
+ *
+ * Copyright (c) 2010 Oliver Nowak
+ *
+ * 
+ * 
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ * 
+ * http://creativecommons.org/licenses/LGPL/2.1/
+ * 
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ * 
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+
+
+/*
+ * ocolor-inverse-check
+ *
+ * Checks InverseColormap::map() against the scalar lookup() for every
+ * supported bit depth (1 to 8), for the RGBA8 and BGRA8 layouts that take
+ * the AVX2 path and for RGB8, which always takes the scalar one. Prints
+ * the number of mismatches per case and the share of the grid that needs
+ * a candidate search. Also checks that share for a 200 color palette at 5
+ * and 6 bits against the figures documented in getAmbiguousRatio().
+ * Exits with 1 if anything fails, e.g.
+ *
+ *   ocolor-inverse-check --pixels 200000 --colors 64
+ *
+ * Build: compile with the ocolor_lib sources and -mavx2 (otherwise only
+ * the scalar path is exercised), link with the platform thread library
+ * (-pthread), and name the binary ocolor-inverse-check.
+ */
+
+#include "InverseColormap.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+
+static vector<OColor> randomPalette(int colors)
+{
+	vector<OColor> palette;
+	for (int i = 0; i < colors; i++) {
+		palette.push_back(OColor::newRGB(rand() % 256 / 255.0f, rand() % 256 / 255.0f, rand() % 256 / 255.0f));
+	}
+	return palette;
+}
+
+template<typename Fmt>
+static size_t mismatches(const InverseColormap& map, const vector<unsigned char>& rgba, size_t count)
+{
+	vector<unsigned char> pixels(count * Fmt::CHANNELS);
+	for (size_t i = 0; i < count; i++) {
+		unsigned char* p = &pixels[i * Fmt::CHANNELS];
+		p[Fmt::RED] = rgba[i * 4];
+		p[Fmt::GREEN] = rgba[i * 4 + 1];
+		p[Fmt::BLUE] = rgba[i * 4 + 2];
+		if (Fmt::HAS_ALPHA) {
+			p[Fmt::HAS_ALPHA ? Fmt::ALPHA : 0] = rgba[i * 4 + 3];
+		}
+	}
+	vector<unsigned short> indices(count);
+	map.map<Fmt>(&pixels[0], count, &indices[0], 1);
+	size_t wrong = 0;
+	for (size_t i = 0; i < count; i++) {
+		if (indices[i] != map.lookup(rgba[i * 4], rgba[i * 4 + 1], rgba[i * 4 + 2])) {
+			wrong++;
+		}
+	}
+	return wrong;
+}
+
+static void usage()
+{
+	fprintf(stderr,
+		"usage: ocolor-inverse-check [--pixels N] [--colors N] [--seed N]\n"
+		"\n"
+		"Defaults: 200000 random pixels, 64 random colors, seed 1.\n");
+}
+
+int main(int argc, char** argv)
+{
+	int count = 200000, colors = 64;
+	unsigned seed = 1;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--pixels") == 0 && i + 1 < argc) {
+			count = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--colors") == 0 && i + 1 < argc) {
+			colors = atoi(argv[++i]);
+		} else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+			seed = (unsigned) atoi(argv[++i]);
+		} else {
+			usage();
+			return 1;
+		}
+	}
+	if (count < 1 || colors < 1 || colors > 65535) {
+		usage();
+		return 1;
+	}
+
+	srand(seed);
+	vector<OColor> palette = randomPalette(colors);
+	vector<unsigned char> rgba((size_t) count * 4);
+	for (size_t i = 0; i < rgba.size(); i++) {
+		rgba[i] = (unsigned char) (rand() & 0xff);
+	}
+
+	size_t total = 0;
+	for (int bits = 1; bits <= 8; bits++) {
+		InverseColormap map;
+		if (!map.build(palette, bits, true, 1)) {
+			fprintf(stderr, "ocolor-inverse-check: build failed for %d bits\n", bits);
+			return 1;
+		}
+		size_t rgbaWrong = mismatches<RGBA8>(map, rgba, count);
+		size_t bgraWrong = mismatches<BGRA8>(map, rgba, count);
+		size_t rgbWrong = mismatches<RGB8>(map, rgba, count);
+		printf("bits %d: RGBA8 %zu, BGRA8 %zu, RGB8 %zu mismatches, %.1f%% ambiguous\n",
+			   bits, rgbaWrong, bgraWrong, rgbWrong, map.getAmbiguousRatio() * 100);
+		total += rgbaWrong + bgraWrong + rgbWrong;
+	}
+
+	// a typical quantizer palette; random colors spread boundaries evenly
+	// over the cube, so real palettes usually do better
+	srand(1);
+	vector<OColor> typical = randomPalette(200);
+	const float limits[2] = { 0.3f, 0.12f };
+	for (int bits = 5; bits <= 6; bits++) {
+		InverseColormap map;
+		map.build(typical, bits, true, 0);
+		float ratio = map.getAmbiguousRatio();
+		printf("200 colors, bits %d: %.1f%% ambiguous (limit %.0f%%)\n", bits, ratio * 100, limits[bits - 5] * 100);
+		if (ratio > limits[bits - 5]) {
+			total++;
+		}
+	}
+	return total == 0 ? 0 : 1;
+}
\ No newline at end of file